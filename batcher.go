@@ -0,0 +1,276 @@
+package ncs
+
+import (
+	"fmt"
+	"sync"
+	"time"
+)
+
+// BatcherOpts configures Batcher
+type BatcherOpts struct {
+	// MaxBatch is the maximum number of requests queued together.
+	// It defaults to the graph input batch size if the graph takes batched input and to the outbound FIFO capacity otherwise.
+	MaxBatch int
+	// MaxDelay is the maximum time the first request of a batch waits for more requests; only the requests already waiting are batched if it's 0
+	MaxDelay time.Duration
+}
+
+// batchRequest is an inference request waiting to be batched
+type batchRequest struct {
+	data  []byte
+	reply chan poolResult
+}
+
+// batchJob is a batch of requests queued on the graph
+type batchJob struct {
+	reqs []*batchRequest
+}
+
+// Batcher collects concurrent inference requests into batches and queues every batch on a graph at once.
+// If the graph takes batched input the requests are packed into a single FIFO element, otherwise they are queued as back to back FIFO elements in a single call.
+// Results of every batch are read at once and fanned out to the callers, so a bounded amount of latency is traded for higher throughput under load.
+// Batcher must be the only user of its graph FIFO queue. Batcher is safe for concurrent use.
+type Batcher struct {
+	graph *Graph
+	queue *FifoQueue
+	// packed is set if the requests are packed into a single FIFO element
+	packed   bool
+	maxBatch int
+	maxDelay time.Duration
+	// inLen and outLen are input and output sizes of a single request in bytes
+	inLen  int
+	outLen int
+	// buf holds the inputs of the batch being queued
+	buf  []byte
+	reqs chan *batchRequest
+	jobs chan *batchJob
+	// done is closed once all the accepted requests have been served
+	done chan struct{}
+	// mu guards closed so no request is sent after reqs is closed
+	mu     sync.RWMutex
+	closed bool
+}
+
+// NewBatcher creates new Batcher which batches inference requests on FIFO queue f allocated with graph g.
+// Without batched graph input MaxBatch must not exceed the capacity of the outbound FIFO as the results of a batch are read only once it has been queued.
+// It returns error if the FIFO tensors can't be split into requests or if the batch size is invalid.
+func (g *Graph) NewBatcher(f *FifoQueue, opts *BatcherOpts) (*Batcher, error) {
+	inDesc, outDesc := f.In.TensorDesc(), f.Out.TensorDesc()
+	if inDesc == nil || outDesc == nil {
+		return nil, fmt.Errorf("Failed to create batcher: tensor descriptor not available")
+	}
+
+	b := &Batcher{
+		graph:    g,
+		queue:    f,
+		maxBatch: opts.MaxBatch,
+		maxDelay: opts.MaxDelay,
+		inLen:    int(f.In.ElemSize()),
+		outLen:   int(f.Out.ElemSize()),
+		done:     make(chan struct{}),
+	}
+
+	var maxBatch int
+	if inDesc.BatchSize > 1 {
+		if outDesc.BatchSize != inDesc.BatchSize {
+			return nil, fmt.Errorf("Failed to create batcher: input batch size %d does not match output batch size %d",
+				inDesc.BatchSize, outDesc.BatchSize)
+		}
+
+		b.packed = true
+		maxBatch = int(inDesc.BatchSize)
+		b.inLen /= maxBatch
+		b.outLen /= maxBatch
+	} else {
+		capOpts, err := f.Out.GetOptionWithByteSize(ROFifoCapacity, fifoOptSize[ROFifoCapacity])
+		if err != nil {
+			return nil, err
+		}
+
+		capacity, err := ROFifoCapacity.Decode(capOpts, 1)
+		if err != nil {
+			return nil, err
+		}
+
+		maxBatch = int(capacity.(uint))
+	}
+
+	if b.maxBatch == 0 {
+		b.maxBatch = maxBatch
+	}
+
+	if b.maxBatch < 1 || b.maxBatch > maxBatch {
+		return nil, fmt.Errorf("Failed to create batcher: batch size %d outside of [1, %d]", b.maxBatch, maxBatch)
+	}
+
+	if b.inLen == 0 || b.outLen == 0 {
+		return nil, fmt.Errorf("Failed to create batcher: %s", StatusNotAllocated)
+	}
+
+	if b.packed {
+		b.buf = make([]byte, f.In.ElemSize())
+	} else {
+		b.buf = make([]byte, b.maxBatch*b.inLen)
+	}
+
+	b.reqs = make(chan *batchRequest, b.maxBatch)
+	// every job holds at least one outbound FIFO element
+	b.jobs = make(chan *batchJob, maxBatch)
+
+	go b.collect()
+	go b.read()
+
+	return b, nil
+}
+
+// collect collects requests into batches and queues them
+func (b *Batcher) collect() {
+	defer close(b.jobs)
+
+	for req := range b.reqs {
+		batch, open := b.gather([]*batchRequest{req})
+		b.submit(batch)
+
+		if !open {
+			return
+		}
+	}
+}
+
+// gather adds requests to batch until it's full, MaxDelay elapses or the batcher is closed.
+// It returns false if the batcher has been closed.
+func (b *Batcher) gather(batch []*batchRequest) ([]*batchRequest, bool) {
+	var timeout <-chan time.Time
+	if b.maxDelay > 0 {
+		t := time.NewTimer(b.maxDelay)
+		defer t.Stop()
+		timeout = t.C
+	}
+
+	for len(batch) < b.maxBatch {
+		var req *batchRequest
+		var ok bool
+
+		// requests which are already waiting are taken without waiting for the timeout
+		select {
+		case req, ok = <-b.reqs:
+		default:
+			if timeout == nil {
+				return batch, true
+			}
+
+			select {
+			case req, ok = <-b.reqs:
+			case <-timeout:
+				return batch, true
+			}
+		}
+
+		if !ok {
+			return batch, false
+		}
+		batch = append(batch, req)
+	}
+
+	return batch, true
+}
+
+// submit queues batch of requests on the graph and hands the queued ones over to the result reader
+func (b *Batcher) submit(batch []*batchRequest) {
+	for i, req := range batch {
+		copy(b.buf[i*b.inLen:], req.data)
+	}
+
+	var queued int
+	var err error
+
+	if b.packed {
+		// unused batch slots are zeroed so stale inputs of previous batches are not inferred
+		for i := len(batch) * b.inLen; i < len(b.buf); i++ {
+			b.buf[i] = 0
+		}
+
+		if err = b.graph.QueueInferenceWithFifoElem(b.queue, b.buf, nil); err == nil {
+			queued = len(batch)
+		}
+	} else {
+		queued, err = b.graph.QueueInferenceBatch(b.queue, b.buf[:len(batch)*b.inLen], len(batch))
+	}
+
+	if queued > 0 {
+		b.jobs <- &batchJob{reqs: batch[:queued]}
+	}
+
+	for _, req := range batch[queued:] {
+		req.reply <- poolResult{err: err}
+	}
+}
+
+// read reads the results of queued batches and delivers them to their requests
+func (b *Batcher) read() {
+	defer close(b.done)
+
+	for job := range b.jobs {
+		var out []byte
+		var err error
+
+		if b.packed {
+			out = make([]byte, b.queue.Out.ElemSize())
+			_, err = b.queue.Out.ReadElemInto(out)
+		} else {
+			out = make([]byte, len(job.reqs)*b.outLen)
+			_, err = b.queue.Out.ReadElemBatch(out, len(job.reqs))
+		}
+
+		// results are slices of a single buffer, so every batch allocates once
+		for i, req := range job.reqs {
+			if err != nil {
+				req.reply <- poolResult{err: err}
+				continue
+			}
+			req.reply <- poolResult{tensor: &Tensor{Data: out[i*b.outLen : (i+1)*b.outLen : (i+1)*b.outLen]}}
+		}
+	}
+}
+
+// Infer adds data inference request to the next batch and waits for its result.
+// data must hold a single request input of the size of the inbound FIFO element divided by the graph input batch size.
+// It returns error if the batcher has been closed or if it fails to queue the batch or to read its results.
+func (b *Batcher) Infer(data []byte) (*Tensor, error) {
+	if len(data) != b.inLen {
+		return nil, fmt.Errorf("Failed to queue inference: data size %d does not match request size %d", len(data), b.inLen)
+	}
+
+	req := &batchRequest{
+		data:  data,
+		reply: make(chan poolResult, 1),
+	}
+
+	b.mu.RLock()
+	if b.closed {
+		b.mu.RUnlock()
+		return nil, fmt.Errorf("Failed to queue inference: batcher closed")
+	}
+	b.reqs <- req
+	b.mu.RUnlock()
+
+	res := <-req.reply
+
+	return res.tensor, res.err
+}
+
+// Close stops accepting new requests and waits until all the accepted requests have been served.
+// Close does not destroy the batcher graph or its FIFOs.
+func (b *Batcher) Close() {
+	b.mu.Lock()
+	if b.closed {
+		b.mu.Unlock()
+		<-b.done
+		return
+	}
+	b.closed = true
+	close(b.reqs)
+	b.mu.Unlock()
+
+	<-b.done
+}
@@ -0,0 +1,220 @@
+// ncs_bench measures the native wrappers of ncs.cpp without the cgo overhead of the Go package.
+// It's built against the simulated NCS devices of mvnc_mock.cpp by default; see Makefile.
+//
+// Usage: ncs_bench [-n iterations] [graph...]
+// By default it runs the bundled squeezenet, mobilenet and ssd graphs.
+#include "ncs.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// number of elements the benchmark FIFOs hold
+#define BENCH_FIFO_ELEMS 2
+
+static const char* defaultGraphs[] = {
+        "../examples/caffe-squeezenet/squeezenet_graph",
+        "../examples/tensorflow-mobilenet/mobilenet_graph",
+        "../examples/ssd-mobilenet/ssd_mobilenet_graph",
+};
+
+static inline uint64_t now() {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// benchTimer accumulates the time spent in the calls of a single wrapper
+struct benchTimer {
+        const char* name;
+        uint64_t ns;
+        unsigned int calls;
+        uint64_t start;
+
+        explicit benchTimer(const char* n) : name(n), ns(0), calls(0), start(0) {}
+
+        void begin() {
+                start = now();
+        }
+
+        void end() {
+                ns += now() - start;
+                calls++;
+        }
+
+        void print(const char* graph) const {
+                printf("%-20s %-40s %10u calls %12.1f ns/op\n", graph, name, calls, calls > 0 ? double(ns) / calls : 0.0);
+        }
+};
+
+// benchQueue is graph allocated on a device along with its FIFOs
+struct benchQueue {
+        void* device;
+        void* graph;
+        void* in;
+        void* out;
+        unsigned int inSize;
+        unsigned int outSize;
+};
+
+static bool check(int s, const char* call) {
+        if (s != NC_OK) {
+                fprintf(stderr, "%s failed: %d\n", call, s);
+                return false;
+        }
+        return true;
+}
+
+static bool loadGraph(const char* path, std::vector<char>* data) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+                fprintf(stderr, "failed to open graph %s\n", path);
+                return false;
+        }
+        data->assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+
+        return !data->empty();
+}
+
+static void closeQueue(benchQueue* q) {
+        if (q->in != NULL) {
+                ncs_FifoDestroy(&q->in);
+        }
+        if (q->out != NULL) {
+                ncs_FifoDestroy(&q->out);
+        }
+        if (q->graph != NULL) {
+                ncs_GraphDestroy(&q->graph);
+        }
+        if (q->device != NULL) {
+                ncs_DeviceClose(q->device);
+                ncs_DeviceDestroy(&q->device);
+        }
+}
+
+static bool openQueue(const std::vector<char>& graphData, benchQueue* q) {
+        memset(q, 0, sizeof(*q));
+
+        if (!check(ncs_DeviceCreate(0, &q->device), "ncs_DeviceCreate") ||
+                        !check(ncs_DeviceOpen(q->device), "ncs_DeviceOpen") ||
+                        !check(ncs_GraphCreate("NCSBenchmark", &q->graph), "ncs_GraphCreate") ||
+                        !check(ncs_GraphAllocateWithFifosEx(q->device, q->graph, graphData.data(), (unsigned int) graphData.size(),
+                                        &q->in, NC_FIFO_HOST_WO, BENCH_FIFO_ELEMS, NC_FIFO_FP32,
+                                        &q->out, NC_FIFO_HOST_RO, BENCH_FIFO_ELEMS, NC_FIFO_FP32), "ncs_GraphAllocateWithFifosEx")) {
+                closeQueue(q);
+                return false;
+        }
+
+        unsigned int length = sizeof(q->inSize);
+        if (!check(ncs_FifoGetOption(q->in, NC_RO_FIFO_ELEMENT_DATA_SIZE, &q->inSize, &length), "ncs_FifoGetOption")) {
+                closeQueue(q);
+                return false;
+        }
+        length = sizeof(q->outSize);
+        if (!check(ncs_FifoGetOption(q->out, NC_RO_FIFO_ELEMENT_DATA_SIZE, &q->outSize, &length), "ncs_FifoGetOption")) {
+                closeQueue(q);
+                return false;
+        }
+
+        return true;
+}
+
+// benchGraph runs every benchmark iters times on graph loaded from path
+static bool benchGraph(const char* path, unsigned int iters) {
+        std::vector<char> graphData;
+        if (!loadGraph(path, &graphData)) {
+                return false;
+        }
+
+        benchQueue q;
+        if (!openQueue(graphData, &q)) {
+                return false;
+        }
+
+        std::vector<char> input(q.inSize), output(q.outSize);
+        void* userParam = NULL;
+        unsigned int length = 0;
+        bool ok = true;
+
+        benchTimer write("ncs_FifoWriteElem");
+        benchTimer queue("ncs_GraphQueueInference");
+        benchTimer read("ncs_FifoReadElem");
+        for (unsigned int i = 0; ok && i < iters; i++) {
+                length = q.inSize;
+                write.begin();
+                ok = check(ncs_FifoWriteElem(q.in, input.data(), &length, 0), "ncs_FifoWriteElem");
+                write.end();
+
+                queue.begin();
+                ok = ok && check(ncs_GraphQueueInference(q.graph, &q.in, 1, &q.out, 1), "ncs_GraphQueueInference");
+                queue.end();
+
+                length = q.outSize;
+                read.begin();
+                ok = ok && check(ncs_FifoReadElem(q.out, output.data(), &length, &userParam), "ncs_FifoReadElem");
+                read.end();
+        }
+
+        benchTimer queueElem("ncs_GraphQueueInferenceWithFifoElem");
+        benchTimer infer("end-to-end inference");
+        for (unsigned int i = 0; ok && i < iters; i++) {
+                length = q.inSize;
+                infer.begin();
+                queueElem.begin();
+                ok = check(ncs_GraphQueueInferenceWithFifoElem(q.graph, q.in, q.out, input.data(), &length, 0),
+                                "ncs_GraphQueueInferenceWithFifoElem");
+                queueElem.end();
+
+                length = q.outSize;
+                ok = ok && check(ncs_FifoReadElem(q.out, output.data(), &length, &userParam), "ncs_FifoReadElem");
+                infer.end();
+        }
+
+        benchTimer option("ncs_FifoGetOption");
+        for (unsigned int i = 0; ok && i < iters; i++) {
+                int level = 0;
+                length = sizeof(level);
+                option.begin();
+                ok = check(ncs_FifoGetOption(q.in, NC_RO_FIFO_WRITE_FILL_LEVEL, &level, &length), "ncs_FifoGetOption");
+                option.end();
+        }
+
+        closeQueue(&q);
+
+        std::string name(path);
+        name = name.substr(name.find_last_of('/') + 1);
+        const benchTimer* timers[] = {&write, &queue, &read, &queueElem, &infer, &option};
+        for (size_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+                timers[i]->print(name.c_str());
+        }
+
+        return ok;
+}
+
+int main(int argc, char** argv) {
+        unsigned int iters = 200;
+        std::vector<const char*> graphs;
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+                        iters = (unsigned int) strtoul(argv[++i], NULL, 10);
+                        continue;
+                }
+                graphs.push_back(argv[i]);
+        }
+        if (graphs.empty()) {
+                graphs.assign(defaultGraphs, defaultGraphs + sizeof(defaultGraphs) / sizeof(defaultGraphs[0]));
+        }
+
+        int status = 0;
+        for (size_t i = 0; i < graphs.size(); i++) {
+                if (!benchGraph(graphs[i], iters)) {
+                        status = 1;
+                }
+        }
+
+        return status;
+}
@@ -0,0 +1,230 @@
+//go:build ncsmock
+// +build ncsmock
+
+package ncs
+
+import (
+	"testing"
+)
+
+// benchDevice is the index of the simulated device the device benchmarks run on; unlike device 0 it never faults
+const benchDevice = 1
+
+// benchGraphs are the graph files bundled with the examples which the end-to-end benchmarks load
+var benchGraphs = []struct {
+	name string
+	path string
+}{
+	{"squeezenet", "examples/caffe-squeezenet/squeezenet_graph"},
+	{"mobilenet", "examples/tensorflow-mobilenet/mobilenet_graph"},
+	{"ssd", "examples/ssd-mobilenet/ssd_mobilenet_graph"},
+}
+
+// benchQueue is graph allocated on an opened device along with the FIFO queue its inferences are queued to
+type benchQueue struct {
+	device *Device
+	graph  *Graph
+	queue  *FifoQueue
+}
+
+// newBenchQueue opens the benchmark device, allocates graph from graph file path on it with FIFOs holding numElem elements.
+// The resources are destroyed once b finishes.
+func newBenchQueue(b *testing.B, path string, numElem int) *benchQueue {
+	b.Helper()
+
+	dev, err := NewDevice(benchDevice)
+	if err != nil {
+		b.Fatalf("failed to create device: %s", err)
+	}
+	b.Cleanup(func() { dev.Destroy() })
+
+	if err := dev.Open(); err != nil {
+		b.Fatalf("failed to open device: %s", err)
+	}
+	b.Cleanup(func() { dev.Close() })
+
+	graphFile, err := LoadGraphFile(path)
+	if err != nil {
+		b.Fatalf("failed to load graph: %s", err)
+	}
+	defer graphFile.Close()
+
+	graph, err := NewGraph("NCSBenchmark")
+	if err != nil {
+		b.Fatalf("failed to create graph: %s", err)
+	}
+	b.Cleanup(func() { graph.Destroy() })
+
+	queue, err := graph.AllocateWithFifosOpts(dev, graphFile.Data(),
+		&FifoOpts{Type: FifoHostWO, DataType: FifoFP32, NumElem: numElem},
+		&FifoOpts{Type: FifoHostRO, DataType: FifoFP32, NumElem: numElem})
+	if err != nil {
+		b.Fatalf("failed to allocate graph: %s", err)
+	}
+	b.Cleanup(func() {
+		queue.In.Destroy()
+		queue.Out.Destroy()
+	})
+
+	return &benchQueue{device: dev, graph: graph, queue: queue}
+}
+
+func BenchmarkFP32ToFP16(b *testing.B) {
+	// squeezenet sized input tensor
+	const tensorLen = 227 * 227 * 3
+	fp32 := make([]byte, tensorLen*4)
+	fp16 := make([]byte, tensorLen*2)
+
+	b.SetBytes(int64(len(fp32)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		FP32ToFP16(fp16, fp32)
+	}
+}
+
+func BenchmarkFP16ToFP32(b *testing.B) {
+	const tensorLen = 227 * 227 * 3
+	fp32 := make([]byte, tensorLen*4)
+	fp16 := make([]byte, tensorLen*2)
+
+	b.SetBytes(int64(len(fp16)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		FP16ToFP32(fp32, fp16)
+	}
+}
+
+func BenchmarkPreprocessBGR(b *testing.B) {
+	const tensorLen = 227 * 227 * 3
+	img := &BGRImage{Data: make([]byte, 640*480*3), Width: 640, Height: 480, Stride: 640 * 3}
+	td := &TensorDesc{
+		BatchSize: 1, Channels: 3, Width: 227, Height: 227,
+		Size: tensorLen * 2, CStride: 2, WStride: 6, HStride: 227 * 6,
+		DataType: FifoFP16,
+	}
+	pre := NewPreprocessor(&PreprocessOpts{Scale: [3]float32{1, 1, 1}})
+	out := make([]byte, td.Size)
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := pre.Preprocess(out, td, img); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkWriteElem(b *testing.B) {
+	bq := newBenchQueue(b, benchGraphs[0].path, 2)
+	input := make([]byte, bq.queue.In.ElemSize())
+	output := make([]byte, bq.queue.Out.ElemSize())
+
+	// every written element is queued and its result read back, so the inbound FIFO never fills up
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := bq.queue.In.WriteElem(input, nil); err != nil {
+			b.Fatal(err)
+		}
+		b.StopTimer()
+		if err := bq.graph.QueueInference(bq.queue); err != nil {
+			b.Fatal(err)
+		}
+		if _, err := bq.queue.Out.ReadElemInto(output); err != nil {
+			b.Fatal(err)
+		}
+		b.StartTimer()
+	}
+}
+
+func BenchmarkReadElem(b *testing.B) {
+	bq := newBenchQueue(b, benchGraphs[0].path, 2)
+	input := make([]byte, bq.queue.In.ElemSize())
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		b.StopTimer()
+		if err := bq.graph.QueueInferenceWithFifoElem(bq.queue, input, nil); err != nil {
+			b.Fatal(err)
+		}
+		b.StartTimer()
+		if _, err := bq.queue.Out.ReadElem(); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkQueueInferenceWithFifoElem(b *testing.B) {
+	bq := newBenchQueue(b, benchGraphs[0].path, 2)
+	input := make([]byte, bq.queue.In.ElemSize())
+	output := make([]byte, bq.queue.Out.ElemSize())
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := bq.graph.QueueInferenceWithFifoElem(bq.queue, input, nil); err != nil {
+			b.Fatal(err)
+		}
+		b.StopTimer()
+		if _, err := bq.queue.Out.ReadElemInto(output); err != nil {
+			b.Fatal(err)
+		}
+		b.StartTimer()
+	}
+}
+
+func BenchmarkQueueInferenceBatch(b *testing.B) {
+	const batchSize = 8
+	bq := newBenchQueue(b, benchGraphs[0].path, batchSize)
+	input := make([]byte, bq.queue.In.ElemSize()*batchSize)
+	output := make([]byte, bq.queue.Out.ElemSize()*batchSize)
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		n, err := bq.graph.QueueInferenceBatch(bq.queue, input, batchSize)
+		if err != nil {
+			b.Fatal(err)
+		}
+		if _, err := bq.queue.Out.ReadElemBatch(output, n); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkGetOptionWithByteSize(b *testing.B) {
+	bq := newBenchQueue(b, benchGraphs[0].path, 2)
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := bq.queue.In.GetOptionWithByteSize(ROFifoWriteFillLevel, fifoOptSize[ROFifoWriteFillLevel]); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+// BenchmarkInfer measures end-to-end inferences of the bundled graphs: queueing the input and reading the result back
+func BenchmarkInfer(b *testing.B) {
+	for _, g := range benchGraphs {
+		b.Run(g.name, func(b *testing.B) {
+			bq := newBenchQueue(b, g.path, 2)
+			input := make([]byte, bq.queue.In.ElemSize())
+			output := make([]byte, bq.queue.Out.ElemSize())
+
+			b.ReportAllocs()
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				if err := bq.graph.QueueInferenceWithFifoElem(bq.queue, input, nil); err != nil {
+					b.Fatal(err)
+				}
+				if _, err := bq.queue.Out.ReadElemInto(output); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
@@ -0,0 +1,251 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"sync"
+	"unsafe"
+)
+
+// maxCascadeDetections is the maximum number of detections which can be addressed in a single cascade result
+const maxCascadeDetections = 1 << 20
+
+// CascadeStage is a graph run by Cascade along with the FIFO queue it was allocated with
+type CascadeStage struct {
+	// Graph is the allocated graph
+	Graph *Graph
+	// Queue is FIFO queue allocated along with the graph
+	Queue *FifoQueue
+	// Preprocess configures preprocessing of images into the graph input; pixel values are used as they are if it's nil
+	Preprocess *PreprocessOpts
+}
+
+// CascadeOpts configures Cascade
+type CascadeOpts struct {
+	// Detector is SSD network stage run on every queued image
+	Detector CascadeStage
+	// Classifier is the stage run on the crop of every detected object
+	Classifier CascadeStage
+	// MinConfidence is the minimum confidence of detections which are classified
+	MinConfidence float32
+	// MaxDetections limits the number of detections classified per image; all the detections detector output can hold are classified if it's 0
+	MaxDetections int
+}
+
+// CascadeResult is the result of a single image run through Cascade
+type CascadeResult struct {
+	// MetaData is the metadata the image was queued with
+	MetaData interface{}
+	// Detections contains objects detected in the image
+	Detections []Detection
+	// Outputs contains classifier output of every detection
+	Outputs [][]byte
+}
+
+// Cascade runs SSD detector on images and classifier on the crops of the objects it detects.
+// Detector results are decoded, cropped from the image and preprocessed into classifier input on a native thread, so the intermediate data never crosses into Go.
+// Images can be queued and results read concurrently, but neither Queue nor Next must be called concurrently with itself.
+type Cascade struct {
+	handle unsafe.Pointer
+	// handleMu keeps the cascade from being destroyed while Queue queues an image
+	handleMu sync.RWMutex
+	// nextMu guards result and keeps the cascade from being destroyed while Next waits for a result
+	nextMu sync.Mutex
+	result *C.ncs_CascadeResult
+	// mu guards metaData which holds metadata of the queued images in the order they were queued
+	mu       sync.Mutex
+	metaData []interface{}
+}
+
+// NewCascade creates new Cascade configured by opts and starts feeding the detector results into the classifier.
+// Detector outbound FIFO must not be read by anything else until the cascade is destroyed.
+// It returns error if the detector and classifier FIFOs don't describe their tensors or if it fails to start the cascade.
+func NewCascade(opts *CascadeOpts) (*Cascade, error) {
+	det, err := cascadeStage(&opts.Detector)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to create cascade detector: %s", err)
+	}
+
+	cls, err := cascadeStage(&opts.Classifier)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to create cascade classifier: %s", err)
+	}
+
+	maxDets := opts.MaxDetections
+	if maxDets == 0 {
+		valSize := 4
+		if det.outDataType == C.ncFifoDataType(FifoFP16) {
+			valSize = 2
+		}
+		maxDets = int(det.outElemSize)/(valSize*ssdDetectionSize) - 1
+	}
+
+	if maxDets <= 0 {
+		return nil, fmt.Errorf("Failed to create cascade: invalid max detections %d", maxDets)
+	}
+
+	var handle unsafe.Pointer
+
+	s := C.ncs_CascadeCreate(det, cls, C.float(opts.MinConfidence), C.uint(maxDets), &handle)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to create cascade: %s", Status(s))
+	}
+
+	return &Cascade{
+		handle: handle,
+		result: (*C.ncs_CascadeResult)(C.malloc(C.sizeof_ncs_CascadeResult)),
+	}, nil
+}
+
+// cascadeStage converts CascadeStage to native cascade stage
+func cascadeStage(stage *CascadeStage) (*C.ncs_CascadeStage, error) {
+	in, out := stage.Queue.In, stage.Queue.Out
+
+	if in.desc == nil {
+		return nil, fmt.Errorf("inbound tensor descriptor not available")
+	}
+
+	outDesc := out.TensorDesc()
+	if outDesc == nil {
+		return nil, fmt.Errorf("outbound tensor descriptor not available")
+	}
+
+	opts, err := out.GetOptionWithByteSize(ROFifoCapacity, fifoOptSize[ROFifoCapacity])
+	if err != nil {
+		return nil, err
+	}
+
+	capacity, err := ROFifoCapacity.Decode(opts, 1)
+	if err != nil {
+		return nil, err
+	}
+
+	preprocess := stage.Preprocess
+	if preprocess == nil {
+		preprocess = &PreprocessOpts{Scale: [3]float32{1, 1, 1}}
+	}
+
+	p := NewPreprocessor(preprocess)
+	defer p.Destroy()
+
+	return &C.ncs_CascadeStage{
+		graphHandle:   stage.Graph.handle,
+		inFifoHandle:  in.handle,
+		outFifoHandle: out.handle,
+		inDesc:        *in.desc,
+		opts:          *p.opts,
+		outElemSize:   C.uint(out.elemSize),
+		outDataType:   C.ncFifoDataType(outDesc.DataType),
+		outNumElem:    C.uint(capacity.(uint)),
+	}, nil
+}
+
+// Queue preprocesses image into detector input and queues detector inference along with some metadata returned with its result.
+// The image is copied, so it can be reused once Queue returns.
+// It returns error if the cascade has been destroyed or if it fails to preprocess the image or to queue the inference.
+func (c *Cascade) Queue(img *BGRImage, metaData interface{}) error {
+	if err := img.check(); err != nil {
+		return fmt.Errorf("Failed to queue cascade inference: %s", err)
+	}
+
+	c.handleMu.RLock()
+	defer c.handleMu.RUnlock()
+
+	if c.handle == nil {
+		return fmt.Errorf("Failed to queue cascade inference: %s", StatusInvalidHandle)
+	}
+
+	// metadata is added first as the result may be read before queueing returns
+	c.mu.Lock()
+	c.metaData = append(c.metaData, metaData)
+	c.mu.Unlock()
+
+	imgPtr := unsafe.Pointer(&img.Data[0])
+	s := C.ncs_CascadeQueue(c.handle, imgPtr, C.uint(img.Width), C.uint(img.Height), C.uint(img.Stride))
+
+	if Status(s) != StatusOK {
+		c.mu.Lock()
+		c.metaData[len(c.metaData)-1] = nil
+		c.metaData = c.metaData[:len(c.metaData)-1]
+		c.mu.Unlock()
+		return fmt.Errorf("Failed to queue cascade inference: %s", Status(s))
+	}
+
+	return nil
+}
+
+// Next waits for the result of the oldest queued image and returns it.
+// It returns error if the cascade has been stopped or if any of its inferences failed.
+func (c *Cascade) Next() (*CascadeResult, error) {
+	c.nextMu.Lock()
+	defer c.nextMu.Unlock()
+
+	if c.handle == nil {
+		return nil, fmt.Errorf("Failed to read cascade result: %s", StatusInvalidHandle)
+	}
+
+	s := C.ncs_CascadeNext(c.handle, c.result)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to read cascade result: %s", Status(s))
+	}
+
+	c.mu.Lock()
+	res := &CascadeResult{MetaData: c.metaData[0]}
+	c.metaData[0] = nil
+	c.metaData = c.metaData[1:]
+	c.mu.Unlock()
+
+	count := int(c.result.count)
+	if count == 0 {
+		return res, nil
+	}
+
+	res.Detections = make([]Detection, count)
+	copy(res.Detections, (*[maxCascadeDetections]Detection)(unsafe.Pointer(c.result.detections))[:count:count])
+
+	outLen := int(c.result.outputLength)
+	outputs := C.GoBytes(unsafe.Pointer(c.result.outputs), C.int(count*outLen))
+	res.Outputs = make([][]byte, count)
+	for i := range res.Outputs {
+		res.Outputs[i] = outputs[i*outLen : (i+1)*outLen : (i+1)*outLen]
+	}
+
+	return res, nil
+}
+
+// Destroy stops the cascade and frees associated resources. Next waiting for a result when Destroy is called returns error.
+// Destroy waits for the native thread to read results of the classifier inferences it has queued; any other inference which is in flight when Destroy is called is discarded.
+// Cascade must be destroyed before its graphs and FIFOs are destroyed. Destroying the cascade again does nothing.
+func (c *Cascade) Destroy() error {
+	c.handleMu.RLock()
+	if c.handle != nil {
+		C.ncs_CascadeStop(c.handle)
+	}
+	c.handleMu.RUnlock()
+
+	c.nextMu.Lock()
+	defer c.nextMu.Unlock()
+
+	c.handleMu.Lock()
+	defer c.handleMu.Unlock()
+
+	if c.handle == nil {
+		return nil
+	}
+
+	s := C.ncs_CascadeDestroy(&c.handle)
+	C.free(unsafe.Pointer(c.result))
+	c.result = nil
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to destroy cascade: %s", Status(s))
+	}
+
+	return nil
+}
@@ -0,0 +1,467 @@
+package main
+
+import (
+	"context"
+	"flag"
+	"fmt"
+	"io/ioutil"
+	"log"
+	"math/rand"
+	"os"
+	"os/signal"
+	"path/filepath"
+	"sort"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"time"
+
+	"github.com/milosgajdos/ncs"
+)
+
+var (
+	graphPath  = flag.String("graph", "../../examples/caffe-squeezenet/squeezenet_graph", "path to compiled graph file")
+	devices    = flag.Int("devices", 0, "number of devices to drive; all attached devices are used if 0")
+	depth      = flag.Uint("depth", ncs.DefaultFifoNumElem, "number of elements graph FIFOs hold")
+	executors  = flag.Uint("executors", 0, "number of executors graphs run inferences on; NCSDK default is used if 0")
+	dataType   = flag.String("dtype", "fp32", "FIFO data type: fp32 or fp16")
+	batch      = flag.String("batch", "none", "batch policy: none queues every request on its own, micro batches them with ncs.Batcher")
+	maxBatch   = flag.Int("max-batch", 0, "maximum number of requests in micro batch; Batcher default is used if 0")
+	maxDelay   = flag.Duration("max-delay", time.Millisecond, "maximum time the first request of micro batch waits for more requests")
+	mode       = flag.String("mode", "closed", "load mode: closed keeps -concurrency requests in flight, open sends requests at -rate")
+	workers    = flag.Int("concurrency", 0, "number of requests in flight in closed loop mode; twice the FIFO capacity of all devices if 0")
+	rate       = flag.Float64("rate", 100, "requests per second sent in open loop mode")
+	arrivals   = flag.String("arrivals", "poisson", "open loop request arrivals: poisson or uniform")
+	maxPending = flag.Int("max-pending", 1024, "maximum number of requests in flight in open loop mode; requests sent above it are dropped")
+	duration   = flag.Duration("duration", 10*time.Second, "time the load is measured for")
+	warmup     = flag.Duration("warmup", 2*time.Second, "time the load runs for before it is measured")
+)
+
+// target serves inference requests on a single device
+type target interface {
+	// infer runs inference of data and waits for its result
+	infer(data []byte) error
+	// close waits for all the requests in flight and releases the target
+	close()
+}
+
+// directTarget queues every request as a separate inference and reads the results on a native FIFO reader
+type directTarget struct {
+	graph  *ncs.Graph
+	queue  *ncs.FifoQueue
+	reader *ncs.FifoReader
+	// mu serializes queueing inferences so the order of pending requests matches outbound FIFO order
+	mu      sync.Mutex
+	pending chan chan error
+	done    chan struct{}
+}
+
+func newDirectTarget(g *ncs.Graph, q *ncs.FifoQueue, ringSize uint) (*directTarget, error) {
+	reader, err := q.Out.NewReader(ringSize)
+	if err != nil {
+		return nil, err
+	}
+
+	t := &directTarget{
+		graph:   g,
+		queue:   q,
+		reader:  reader,
+		pending: make(chan chan error, 2*ringSize),
+		done:    make(chan struct{}),
+	}
+
+	go t.read()
+
+	return t, nil
+}
+
+// read delivers inference results to the requests in the order they were queued
+func (t *directTarget) read() {
+	defer close(t.done)
+
+	for range t.reader.Results() {
+		(<-t.pending) <- nil
+	}
+
+	err := t.reader.Err()
+	if err == nil {
+		err = fmt.Errorf("reader stopped")
+	}
+	for {
+		select {
+		case reply := <-t.pending:
+			reply <- err
+		default:
+			return
+		}
+	}
+}
+
+func (t *directTarget) infer(data []byte) error {
+	reply := make(chan error, 1)
+
+	t.mu.Lock()
+	if err := t.graph.QueueInferenceWithFifoElem(t.queue, data, nil); err != nil {
+		t.mu.Unlock()
+		return err
+	}
+	t.pending <- reply
+	t.mu.Unlock()
+
+	return <-reply
+}
+
+func (t *directTarget) close() {
+	t.reader.Destroy()
+	<-t.done
+}
+
+// batchTarget batches requests with ncs.Batcher
+type batchTarget struct {
+	batcher *ncs.Batcher
+}
+
+func (t *batchTarget) infer(data []byte) error {
+	_, err := t.batcher.Infer(data)
+	return err
+}
+
+func (t *batchTarget) close() {
+	t.batcher.Close()
+}
+
+// bench drives load on the targets and records the request latencies
+type bench struct {
+	targets []target
+	// inflight is the number of requests in flight on every target
+	inflight []int64
+	data     []byte
+	// measuring is set once the warmup is over
+	measuring int32
+	mu        sync.Mutex
+	latencies []time.Duration
+	errors    int64
+	dropped   int64
+	served    []int64
+}
+
+// pick returns the index of the target with the fewest requests in flight
+func (b *bench) pick() int {
+	best := 0
+	for i := 1; i < len(b.inflight); i++ {
+		if atomic.LoadInt64(&b.inflight[i]) < atomic.LoadInt64(&b.inflight[best]) {
+			best = i
+		}
+	}
+
+	return best
+}
+
+// request serves a single request sent at sent and records its latency
+func (b *bench) request(sent time.Time) {
+	i := b.pick()
+	atomic.AddInt64(&b.inflight[i], 1)
+	err := b.targets[i].infer(b.data)
+	atomic.AddInt64(&b.inflight[i], -1)
+	latency := time.Since(sent)
+
+	if atomic.LoadInt32(&b.measuring) == 0 {
+		return
+	}
+
+	if err != nil {
+		if atomic.AddInt64(&b.errors, 1) == 1 {
+			log.Printf("Inference failed: %s", err)
+		}
+		return
+	}
+
+	atomic.AddInt64(&b.served[i], 1)
+	b.mu.Lock()
+	b.latencies = append(b.latencies, latency)
+	b.mu.Unlock()
+}
+
+// closedLoop keeps n requests in flight until ctx is done
+func (b *bench) closedLoop(ctx context.Context, n int) {
+	var wg sync.WaitGroup
+	for w := 0; w < n; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for ctx.Err() == nil {
+				b.request(time.Now())
+			}
+		}()
+	}
+	wg.Wait()
+}
+
+// openLoop sends requests at rate per second until ctx is done.
+// Latencies are measured from the time the requests are scheduled to be sent at, so a stalled device does not hide the queueing delay it causes.
+func (b *bench) openLoop(ctx context.Context, rate float64, poisson bool, maxPending int) {
+	var wg sync.WaitGroup
+	var pending int64
+
+	interval := float64(time.Second) / rate
+	next := time.Now()
+	for ctx.Err() == nil {
+		if poisson {
+			next = next.Add(time.Duration(rand.ExpFloat64() * interval))
+		} else {
+			next = next.Add(time.Duration(interval))
+		}
+		if d := time.Until(next); d > 0 {
+			time.Sleep(d)
+		}
+
+		if atomic.LoadInt64(&pending) >= int64(maxPending) {
+			if atomic.LoadInt32(&b.measuring) == 1 {
+				atomic.AddInt64(&b.dropped, 1)
+			}
+			continue
+		}
+
+		atomic.AddInt64(&pending, 1)
+		wg.Add(1)
+		go func(sent time.Time) {
+			defer wg.Done()
+			b.request(sent)
+			atomic.AddInt64(&pending, -1)
+		}(next)
+	}
+	wg.Wait()
+}
+
+// cpuTime returns the CPU time the process has spent in user and system mode
+func cpuTime() time.Duration {
+	var ru syscall.Rusage
+	if err := syscall.Getrusage(syscall.RUSAGE_SELF, &ru); err != nil {
+		return 0
+	}
+
+	return time.Duration(ru.Utime.Nano() + ru.Stime.Nano())
+}
+
+// percentile returns the p-th percentile of sorted latencies
+func percentile(sorted []time.Duration, p float64) time.Duration {
+	if len(sorted) == 0 {
+		return 0
+	}
+	i := int(p*float64(len(sorted))+0.5) - 1
+	if i < 0 {
+		i = 0
+	}
+	if i >= len(sorted) {
+		i = len(sorted) - 1
+	}
+
+	return sorted[i]
+}
+
+// openTargets brings up the devices, allocates the graph on each of them and returns the targets serving them along with the request size
+func openTargets(graphData []byte, inOpts, outOpts *ncs.FifoOpts) ([]target, []ncs.OpenResult, int, error) {
+	// devices are booted concurrently; graphs are allocated afterwards as executors count must be set before allocation
+	results, err := ncs.OpenAll(context.Background(), &ncs.OpenOpts{MaxDevices: *devices})
+	if err != nil {
+		return nil, nil, 0, err
+	}
+
+	var opened []ncs.OpenResult
+	var targets []target
+	reqLen := 0
+
+	for r := range results {
+		if r.Err != nil {
+			log.Printf("Failed to open device %d: %s", r.Index, r.Err)
+			continue
+		}
+		opened = append(opened, r)
+		last := &opened[len(opened)-1]
+
+		g, err := ncs.NewGraph(filepath.Base(*graphPath))
+		if err != nil {
+			return targets, opened, 0, err
+		}
+		last.Graph = g
+
+		if *executors > 0 {
+			if err := g.SetExecutorsCount(*executors); err != nil {
+				return targets, opened, 0, err
+			}
+		}
+
+		q, err := g.AllocateWithFifosOpts(r.Device, graphData, inOpts, outOpts)
+		if err != nil {
+			return targets, opened, 0, err
+		}
+		last.Queue = q
+
+		n := int(q.In.ElemSize())
+
+		var t target
+		switch *batch {
+		case "none":
+			t, err = newDirectTarget(g, q, 2*(*depth))
+		case "micro":
+			var b *ncs.Batcher
+			b, err = g.NewBatcher(q, &ncs.BatcherOpts{MaxBatch: *maxBatch, MaxDelay: *maxDelay})
+			t = &batchTarget{batcher: b}
+			if td := q.In.TensorDesc(); td != nil && td.BatchSize > 1 {
+				n /= int(td.BatchSize)
+			}
+		}
+		if err != nil {
+			return targets, opened, 0, err
+		}
+
+		targets = append(targets, t)
+		reqLen = n
+	}
+
+	if len(targets) == 0 {
+		return nil, opened, 0, fmt.Errorf("no device brought up")
+	}
+
+	return targets, opened, reqLen, nil
+}
+
+func main() {
+	flag.Parse()
+
+	var fifoType ncs.FifoDataType
+	switch *dataType {
+	case "fp32":
+		fifoType = ncs.FifoFP32
+	case "fp16":
+		fifoType = ncs.FifoFP16
+	default:
+		log.Fatalf("Invalid data type: %s", *dataType)
+	}
+
+	if *batch != "none" && *batch != "micro" {
+		log.Fatalf("Invalid batch policy: %s", *batch)
+	}
+
+	if *mode != "closed" && *mode != "open" {
+		log.Fatalf("Invalid load mode: %s", *mode)
+	}
+
+	if *mode == "open" && (*rate <= 0 || *maxPending < 1 || (*arrivals != "poisson" && *arrivals != "uniform")) {
+		log.Fatalf("Invalid open loop configuration: rate %g, max pending %d, arrivals %s", *rate, *maxPending, *arrivals)
+	}
+
+	graphData, err := ioutil.ReadFile(*graphPath)
+	if err != nil {
+		log.Fatalf("Failed to read graph file: %s", err)
+	}
+
+	inOpts := &ncs.FifoOpts{Type: ncs.FifoHostWO, DataType: fifoType, NumElem: int(*depth)}
+	outOpts := &ncs.FifoOpts{Type: ncs.FifoHostRO, DataType: fifoType, NumElem: int(*depth)}
+
+	targets, opened, reqLen, err := openTargets(graphData, inOpts, outOpts)
+	defer func() {
+		for i := range opened {
+			opened[i].Destroy()
+		}
+	}()
+	if err != nil {
+		for _, t := range targets {
+			t.close()
+		}
+		log.Printf("Failed to bring up devices: %s", err)
+		return
+	}
+
+	b := &bench{
+		targets:  targets,
+		inflight: make([]int64, len(targets)),
+		served:   make([]int64, len(targets)),
+		data:     make([]byte, reqLen),
+	}
+
+	concurrency := *workers
+	if concurrency == 0 {
+		concurrency = 2 * int(*depth) * len(targets)
+	}
+
+	fmt.Printf("graph %s, %d devices, FIFO depth %d %s, executors %d, batch %s, mode %s",
+		filepath.Base(*graphPath), len(targets), *depth, fifoType, *executors, *batch, *mode)
+	if *mode == "closed" {
+		fmt.Printf(", concurrency %d\n", concurrency)
+	} else {
+		fmt.Printf(", rate %g/s %s\n", *rate, *arrivals)
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	sig := make(chan os.Signal, 1)
+	signal.Notify(sig, os.Interrupt)
+
+	// the measurement stops as soon as the load does, so the requests still in flight are not counted
+	var elapsed, cpu time.Duration
+	stopped := make(chan struct{})
+	go func() {
+		defer close(stopped)
+		defer cancel()
+
+		select {
+		case <-time.After(*warmup):
+		case <-sig:
+			return
+		}
+		start, startCPU := time.Now(), cpuTime()
+		atomic.StoreInt32(&b.measuring, 1)
+
+		select {
+		case <-time.After(*duration):
+		case <-sig:
+		}
+		atomic.StoreInt32(&b.measuring, 0)
+		elapsed, cpu = time.Since(start), cpuTime()-startCPU
+	}()
+
+	if *mode == "closed" {
+		b.closedLoop(ctx, concurrency)
+	} else {
+		b.openLoop(ctx, *rate, *arrivals == "poisson", *maxPending)
+	}
+	<-stopped
+
+	for _, t := range targets {
+		t.close()
+	}
+
+	if elapsed == 0 {
+		log.Printf("Interrupted during warmup")
+		return
+	}
+
+	lat := b.latencies
+	sort.Slice(lat, func(i, j int) bool { return lat[i] < lat[j] })
+
+	var sum time.Duration
+	for _, l := range lat {
+		sum += l
+	}
+
+	frames := len(lat)
+	fmt.Printf("requests %d, errors %d, dropped %d in %s\n", frames, b.errors, b.dropped, elapsed.Round(time.Millisecond))
+	if frames == 0 {
+		return
+	}
+
+	fmt.Printf("throughput %.1f fps\n", float64(frames)/elapsed.Seconds())
+	fmt.Printf("latency mean %s p50 %s p90 %s p99 %s p99.9 %s max %s\n",
+		sum/time.Duration(frames), percentile(lat, 0.5), percentile(lat, 0.9),
+		percentile(lat, 0.99), percentile(lat, 0.999), lat[frames-1])
+	fmt.Printf("host CPU %s per frame, %.1f%% of a core\n",
+		cpu/time.Duration(frames), 100*cpu.Seconds()/elapsed.Seconds())
+
+	for i := range targets {
+		line := fmt.Sprintf("device %d: %d requests", opened[i].Index, b.served[i])
+		if stats, err := opened[i].Device.Stats(); err == nil {
+			line += fmt.Sprintf(", native device p50 %s p99 %s", stats.Device.P50, stats.Device.P99)
+		}
+		fmt.Println(line)
+	}
+}
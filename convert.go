@@ -0,0 +1,60 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+// fp32Count returns the number of FP32 values stored in data
+func fp32Count(data []byte) (int, error) {
+	if len(data) == 0 || len(data)%4 != 0 {
+		return 0, fmt.Errorf("data size %d is not a multiple of FP32 size", len(data))
+	}
+
+	return len(data) / 4, nil
+}
+
+// FP32ToFP16 converts FP32 data stored in src to FP16 data stored in dst.
+// src contains little endian encoded FP32 values and dst must be at least half the size of src.
+// The conversion uses F16C instructions on x86 CPUs which support them and NEON on ARM.
+// It returns error if the size of src or dst is invalid.
+func FP32ToFP16(dst, src []byte) error {
+	count, err := fp32Count(src)
+	if err != nil {
+		return fmt.Errorf("Failed to convert data to FP16: %s", err)
+	}
+
+	if len(dst) < count*2 {
+		return fmt.Errorf("Failed to convert data to FP16: buffer size %d smaller than %d", len(dst), count*2)
+	}
+
+	srcPtr, dstPtr := unsafe.Pointer(&src[0]), unsafe.Pointer(&dst[0])
+	C.ncs_Fp32ToFp16(srcPtr, dstPtr, C.uint(count))
+
+	return nil
+}
+
+// FP16ToFP32 converts FP16 data stored in src to FP32 data stored in dst.
+// src contains little endian encoded FP16 values and dst must be at least twice the size of src.
+// The conversion uses F16C instructions on x86 CPUs which support them and NEON on ARM.
+// It returns error if the size of src or dst is invalid.
+func FP16ToFP32(dst, src []byte) error {
+	if len(src) == 0 || len(src)%2 != 0 {
+		return fmt.Errorf("Failed to convert data to FP32: data size %d is not a multiple of FP16 size", len(src))
+	}
+
+	count := len(src) / 2
+	if len(dst) < count*4 {
+		return fmt.Errorf("Failed to convert data to FP32: buffer size %d smaller than %d", len(dst), count*4)
+	}
+
+	srcPtr, dstPtr := unsafe.Pointer(&src[0]), unsafe.Pointer(&dst[0])
+	C.ncs_Fp16ToFp32(srcPtr, dstPtr, C.uint(count))
+
+	return nil
+}
@@ -0,0 +1,179 @@
+//go:build ncsmock
+// +build ncsmock
+
+package ncs
+
+import (
+	"encoding/binary"
+	"math"
+	"math/rand"
+	"testing"
+)
+
+// convertLens are the conversion lengths tested; values past the last multiple of the vector width are converted by the scalar tail
+var convertLens = []int{1, 3, 7, 8, 9, 15, 17, 33}
+
+func fp32Bytes(vals []uint32) []byte {
+	b := make([]byte, len(vals)*4)
+	for i, v := range vals {
+		binary.LittleEndian.PutUint32(b[i*4:], v)
+	}
+
+	return b
+}
+
+func fp16Bytes(vals []uint16) []byte {
+	b := make([]byte, len(vals)*2)
+	for i, v := range vals {
+		binary.LittleEndian.PutUint16(b[i*2:], v)
+	}
+
+	return b
+}
+
+func isNaN32(x uint32) bool {
+	return x&0x7f800000 == 0x7f800000 && x&0x7fffff != 0
+}
+
+func isNaN16(h uint16) bool {
+	return h&0x7c00 == 0x7c00 && h&0x3ff != 0
+}
+
+func TestFP16RoundTrip(t *testing.T) {
+	tests := []struct {
+		name string
+		half uint16
+		fp32 uint32
+	}{
+		{"+0", 0x0000, 0x00000000},
+		{"-0", 0x8000, 0x80000000},
+		{"one", 0x3c00, 0x3f800000},
+		{"max", 0x7bff, 0x477fe000},
+		{"min subnormal", 0x0001, 0x33800000},
+		{"max subnormal", 0x03ff, 0x387fc000},
+		{"-min subnormal", 0x8001, 0xb3800000},
+		{"+inf", 0x7c00, 0x7f800000},
+		{"-inf", 0xfc00, 0xff800000},
+	}
+
+	for _, tc := range tests {
+		for _, n := range convertLens {
+			halves := make([]uint16, n)
+			for i := range halves {
+				halves[i] = tc.half
+			}
+
+			fp32 := make([]byte, n*4)
+			if err := FP16ToFP32(fp32, fp16Bytes(halves)); err != nil {
+				t.Fatalf("%s/%d: failed to convert to FP32: %s", tc.name, n, err)
+			}
+			for i := 0; i < n; i++ {
+				if x := binary.LittleEndian.Uint32(fp32[i*4:]); x != tc.fp32 {
+					t.Errorf("%s/%d: value %d: expected FP32 %#08x, got %#08x", tc.name, n, i, tc.fp32, x)
+				}
+			}
+
+			fp16 := make([]byte, n*2)
+			if err := FP32ToFP16(fp16, fp32); err != nil {
+				t.Fatalf("%s/%d: failed to convert to FP16: %s", tc.name, n, err)
+			}
+			for i := 0; i < n; i++ {
+				if h := binary.LittleEndian.Uint16(fp16[i*2:]); h != tc.half {
+					t.Errorf("%s/%d: value %d: expected FP16 %#04x, got %#04x", tc.name, n, i, tc.half, h)
+				}
+			}
+		}
+	}
+}
+
+func TestFP16RoundTripNaN(t *testing.T) {
+	for _, n := range convertLens {
+		halves := make([]uint16, n)
+		for i := range halves {
+			halves[i] = 0x7e00
+		}
+
+		fp32 := make([]byte, n*4)
+		if err := FP16ToFP32(fp32, fp16Bytes(halves)); err != nil {
+			t.Fatalf("%d: failed to convert to FP32: %s", n, err)
+		}
+		fp16 := make([]byte, n*2)
+		if err := FP32ToFP16(fp16, fp32); err != nil {
+			t.Fatalf("%d: failed to convert to FP16: %s", n, err)
+		}
+
+		for i := 0; i < n; i++ {
+			if x := binary.LittleEndian.Uint32(fp32[i*4:]); !isNaN32(x) {
+				t.Errorf("%d: value %d: expected FP32 NaN, got %#08x", n, i, x)
+			}
+			if h := binary.LittleEndian.Uint16(fp16[i*2:]); !isNaN16(h) {
+				t.Errorf("%d: value %d: expected FP16 NaN, got %#04x", n, i, h)
+			}
+		}
+	}
+}
+
+// TestFP32ToFP16VecMatchesScalar compares conversions of whole slices, which are vectorized where supported,
+// with conversions of single values, which always use the scalar conversion
+func TestFP32ToFP16VecMatchesScalar(t *testing.T) {
+	rnd := rand.New(rand.NewSource(1))
+
+	for _, n := range convertLens {
+		vals := make([]uint32, n)
+		for i := range vals {
+			// mostly values around the FP16 range including its subnormals, overflows and rounding ties
+			if i%4 == 0 {
+				vals[i] = rnd.Uint32()
+			} else {
+				vals[i] = rnd.Uint32()&0x807fffff | uint32(100+rnd.Intn(45))<<23
+			}
+		}
+		src := fp32Bytes(vals)
+
+		dst := make([]byte, n*2)
+		if err := FP32ToFP16(dst, src); err != nil {
+			t.Fatalf("%d: failed to convert to FP16: %s", n, err)
+		}
+
+		for i := 0; i < n; i++ {
+			scalar := make([]byte, 2)
+			if err := FP32ToFP16(scalar, src[i*4:i*4+4]); err != nil {
+				t.Fatalf("%d: failed to convert value %d to FP16: %s", n, i, err)
+			}
+
+			h, s := binary.LittleEndian.Uint16(dst[i*2:]), binary.LittleEndian.Uint16(scalar)
+			if h != s && !(isNaN16(h) && isNaN16(s)) {
+				t.Errorf("%d: value %d %#08x: vector FP16 %#04x, scalar FP16 %#04x", n, i, vals[i], h, s)
+			}
+		}
+	}
+}
+
+// TestFP16ToFP32VecMatchesScalar compares vectorized and scalar conversions of every FP16 value
+func TestFP16ToFP32VecMatchesScalar(t *testing.T) {
+	halves := make([]uint16, math.MaxUint16+1)
+	for i := range halves {
+		halves[i] = uint16(i)
+	}
+
+	for _, n := range append(convertLens, len(halves)) {
+		src := fp16Bytes(halves[len(halves)-n:])
+
+		dst := make([]byte, n*4)
+		if err := FP16ToFP32(dst, src); err != nil {
+			t.Fatalf("%d: failed to convert to FP32: %s", n, err)
+		}
+
+		scalar := make([]byte, 4)
+		for i := 0; i < n; i++ {
+			if err := FP16ToFP32(scalar, src[i*2:i*2+2]); err != nil {
+				t.Fatalf("%d: failed to convert value %d to FP32: %s", n, i, err)
+			}
+
+			x, s := binary.LittleEndian.Uint32(dst[i*4:]), binary.LittleEndian.Uint32(scalar)
+			if x != s && !(isNaN32(x) && isNaN32(s)) {
+				t.Errorf("%d: value %#04x: vector FP32 %#08x, scalar FP32 %#08x", n, halves[len(halves)-n+i], x, s)
+			}
+		}
+	}
+}
@@ -0,0 +1,174 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"context"
+	"fmt"
+	"sync"
+	"time"
+	"unsafe"
+)
+
+// statusDeadlineExpired is returned natively for requests which expire or are canceled before they finish
+const statusDeadlineExpired = Status(C.NCS_DEADLINE_EXPIRED)
+
+// DeadlineQueue serves inference requests bound to a context on a graph FIFO queue.
+// Inferences are queued and their results read on native threads, so a request returns as soon as its context is done even if the device never delivers its result.
+// Requests whose context is done before their inference is queued are dropped without ever reaching the device, so timed out work does not take device time.
+// DeadlineQueue must be the only user of its graph FIFO queue. DeadlineQueue is safe for concurrent use.
+type DeadlineQueue struct {
+	handle unsafe.Pointer
+	inLen  int
+	outLen int
+	// mu keeps the queue from being destroyed while any request waits for its result
+	mu sync.RWMutex
+}
+
+// NewDeadlineQueue creates new DeadlineQueue which keeps up to depth inferences in flight on FIFO queue f allocated with graph g.
+// depth must be at least 1 and it must not exceed the capacity of the outbound FIFO.
+// The fewer inferences are in flight the sooner requests are dropped when the device falls behind.
+// It returns error if the depth is invalid or if it fails to start the queue.
+func (g *Graph) NewDeadlineQueue(f *FifoQueue, depth int) (*DeadlineQueue, error) {
+	opts, err := f.Out.GetOptionWithByteSize(ROFifoCapacity, fifoOptSize[ROFifoCapacity])
+	if err != nil {
+		return nil, err
+	}
+
+	capacity, err := ROFifoCapacity.Decode(opts, 1)
+	if err != nil {
+		return nil, err
+	}
+
+	if depth < 1 || uint(depth) > capacity.(uint) {
+		return nil, fmt.Errorf("Failed to create deadline queue: depth %d outside of [1, %d]", depth, capacity.(uint))
+	}
+
+	if f.In.ElemSize() == 0 || f.Out.ElemSize() == 0 {
+		return nil, fmt.Errorf("Failed to create deadline queue: %s", StatusNotAllocated)
+	}
+
+	var handle unsafe.Pointer
+
+	s := C.ncs_DeadlineQueueCreate(g.handle, f.In.handle, f.Out.handle,
+		C.uint(f.In.ElemSize()), C.uint(f.Out.ElemSize()), C.uint(depth), &handle)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to create deadline queue: %s", Status(s))
+	}
+
+	return &DeadlineQueue{
+		handle: handle,
+		inLen:  int(f.In.ElemSize()),
+		outLen: int(f.Out.ElemSize()),
+	}, nil
+}
+
+// Infer queues data inference request and waits for its result until ctx is done.
+// If ctx has a deadline the request expires at the deadline natively, without waiting for the context to be done.
+// It returns ctx error if ctx is done before the result is available and error if data is not exactly one inbound FIFO element long or if it fails to queue the inference or to read its result.
+func (q *DeadlineQueue) Infer(ctx context.Context, data []byte) (*Tensor, error) {
+	if len(data) != q.inLen {
+		return nil, fmt.Errorf("Failed to queue inference: %s", StatusInvalidDataLength)
+	}
+
+	var timeout time.Duration
+	if deadline, ok := ctx.Deadline(); ok {
+		if timeout = time.Until(deadline); timeout <= 0 {
+			return nil, context.DeadlineExceeded
+		}
+	}
+
+	if err := ctx.Err(); err != nil {
+		return nil, err
+	}
+
+	q.mu.RLock()
+	defer q.mu.RUnlock()
+
+	if q.handle == nil {
+		return nil, fmt.Errorf("Failed to queue inference: %s", StatusInvalidHandle)
+	}
+
+	var id C.ulonglong
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_DeadlineQueueSubmit(q.handle, dataPtr, C.uint(len(data)), C.ulonglong(timeout), &id)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to queue inference: %s", Status(s))
+	}
+
+	// contexts which can be canceled before their deadline cancel the request natively
+	var wg sync.WaitGroup
+	stop := make(chan struct{})
+	if ctx.Done() != nil {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			select {
+			case <-ctx.Done():
+				C.ncs_DeadlineQueueCancel(q.handle, id)
+			case <-stop:
+			}
+		}()
+	}
+
+	out := make([]byte, q.outLen)
+	var n C.uint
+	s = C.ncs_DeadlineQueueWait(q.handle, id, unsafe.Pointer(&out[0]), C.uint(len(out)), &n)
+
+	close(stop)
+	wg.Wait()
+
+	switch Status(s) {
+	case StatusOK:
+		return &Tensor{Data: out[:int(n):int(n)]}, nil
+	case statusDeadlineExpired:
+		if err := ctx.Err(); err != nil {
+			return nil, err
+		}
+		return nil, context.DeadlineExceeded
+	default:
+		return nil, fmt.Errorf("Failed to read inference result: %s", Status(s))
+	}
+}
+
+// Expired returns the number of requests dropped before their inferences were queued
+func (q *DeadlineQueue) Expired() uint64 {
+	q.mu.RLock()
+	defer q.mu.RUnlock()
+
+	if q.handle == nil {
+		return 0
+	}
+
+	var expired C.ulonglong
+	C.ncs_DeadlineQueueExpired(q.handle, &expired)
+
+	return uint64(expired)
+}
+
+// Destroy stops the queue and frees associated resources. Requests waiting for their results when Destroy is called return error.
+// Destroy waits for the inference which is being queued and the result which is being read; any other inference which is in flight when Destroy is called is discarded.
+// DeadlineQueue must be destroyed before its graph and FIFOs are destroyed.
+func (q *DeadlineQueue) Destroy() error {
+	q.mu.RLock()
+	if q.handle != nil {
+		C.ncs_DeadlineQueueStop(q.handle)
+	}
+	q.mu.RUnlock()
+
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	s := C.ncs_DeadlineQueueDestroy(&q.handle)
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to destroy deadline queue: %s", Status(s))
+	}
+
+	return nil
+}
@@ -0,0 +1,74 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+// ssdDetectionSize is the number of values which describe single SSD detection
+const ssdDetectionSize = 7
+
+// Detection is an object detected by SSD network
+// Detection memory layout matches ncs_Detection so detections can be decoded in place
+type Detection struct {
+	// ClassID is the class of the detected object
+	ClassID int32
+	// Confidence is the detection confidence
+	Confidence float32
+	// Left is the left box coordinate normalized to [0, 1]
+	Left float32
+	// Top is the top box coordinate normalized to [0, 1]
+	Top float32
+	// Right is the right box coordinate normalized to [0, 1]
+	Right float32
+	// Bottom is the bottom box coordinate normalized to [0, 1]
+	Bottom float32
+}
+
+// make sure Detection and ncs_Detection have the same size
+var _ [C.sizeof_ncs_Detection - unsafe.Sizeof(Detection{})]struct{}
+var _ [unsafe.Sizeof(Detection{}) - C.sizeof_ncs_Detection]struct{}
+
+// DecodeSSD decodes SSD network output stored in data and appends the detections whose confidence
+// is at least minConfidence to dst. data stores FP16 or FP32 values as specified by dataType.
+// SSD output contains the number of detections followed by 7 values per detection:
+// image id, class id, confidence and box coordinates. Detections with non-finite values are skipped.
+// Decoding is done natively in a single pass; dst is grown only if it lacks capacity for all detections.
+// It returns the extended slice or error if the data can't be decoded.
+func DecodeSSD(dst []Detection, data []byte, dataType FifoDataType, minConfidence float32) ([]Detection, error) {
+	valSize := 4
+	if dataType == FifoFP16 {
+		valSize = 2
+	}
+
+	maxDets := len(data)/(valSize*ssdDetectionSize) - 1
+	if maxDets < 0 {
+		return dst, fmt.Errorf("Failed to decode SSD output: data size %d too small", len(data))
+	}
+
+	n := len(dst)
+	if cap(dst)-n < maxDets {
+		grown := make([]Detection, n, n+maxDets)
+		copy(grown, dst)
+		dst = grown
+	}
+
+	if maxDets == 0 {
+		return dst, nil
+	}
+
+	dets := dst[n : n+maxDets]
+	dataPtr, detsPtr := unsafe.Pointer(&data[0]), (*C.ncs_Detection)(unsafe.Pointer(&dets[0]))
+	count := C.ncs_DecodeSSD(dataPtr, C.uint(len(data)), C.ncFifoDataType_t(dataType),
+		C.float(minConfidence), detsPtr, C.uint(maxDets))
+	if count < 0 {
+		return dst, fmt.Errorf("Failed to decode SSD output: %s", Status(count))
+	}
+
+	return dst[:n+int(count)], nil
+}
@@ -0,0 +1,134 @@
+//go:build ncsmock
+// +build ncsmock
+
+package ncs
+
+import (
+	"encoding/binary"
+	"math"
+	"testing"
+)
+
+// ssdOutput returns SSD output values with header count followed by dets; the header takes the space of single detection
+func ssdOutput(count float32, dets ...[ssdDetectionSize]float32) []float32 {
+	vals := make([]float32, ssdDetectionSize, (1+len(dets))*ssdDetectionSize)
+	vals[0] = count
+	for _, d := range dets {
+		vals = append(vals, d[:]...)
+	}
+
+	return vals
+}
+
+func TestDecodeSSD(t *testing.T) {
+	nan, inf := float32(math.NaN()), float32(math.Inf(1))
+
+	tests := []struct {
+		name          string
+		vals          []float32
+		minConfidence float32
+		expected      []Detection
+	}{
+		{
+			"min confidence",
+			ssdOutput(3,
+				[ssdDetectionSize]float32{0, 1, 0.25, 0.125, 0.125, 0.5, 0.5},
+				[ssdDetectionSize]float32{0, 2, 0.5, 0.25, 0.25, 0.75, 0.75},
+				[ssdDetectionSize]float32{0, 3, 0.75, 0, 0, 1, 1}),
+			0.5,
+			[]Detection{
+				{ClassID: 2, Confidence: 0.5, Left: 0.25, Top: 0.25, Right: 0.75, Bottom: 0.75},
+				{ClassID: 3, Confidence: 0.75, Left: 0, Top: 0, Right: 1, Bottom: 1},
+			},
+		},
+		{
+			"non-finite",
+			ssdOutput(5,
+				[ssdDetectionSize]float32{0, 1, nan, 0.125, 0.125, 0.5, 0.5},
+				[ssdDetectionSize]float32{0, 2, 0.75, 0.25, 0.25, 0.75, 0.75},
+				[ssdDetectionSize]float32{0, 3, 0.75, inf, 0, 1, 1},
+				[ssdDetectionSize]float32{nan, 4, 0.75, 0, 0, 1, 1},
+				// the last detection has no value after it
+				[ssdDetectionSize]float32{0, 5, 0.75, 0, 0, 1, -inf}),
+			0,
+			[]Detection{
+				{ClassID: 2, Confidence: 0.75, Left: 0.25, Top: 0.25, Right: 0.75, Bottom: 0.75},
+			},
+		},
+		{
+			"non-finite last",
+			ssdOutput(2,
+				[ssdDetectionSize]float32{0, 1, 0.5, 0, 0, 1, 1},
+				[ssdDetectionSize]float32{0, 2, 0.5, 0, nan, 1, 1}),
+			0.25,
+			[]Detection{
+				{ClassID: 1, Confidence: 0.5, Left: 0, Top: 0, Right: 1, Bottom: 1},
+			},
+		},
+		{
+			"clamped box and negative class",
+			ssdOutput(2,
+				[ssdDetectionSize]float32{0, -1, 0.75, 0, 0, 1, 1},
+				[ssdDetectionSize]float32{0, 1, 0.75, -0.5, 0.25, 1.5, 2}),
+			0.5,
+			[]Detection{
+				{ClassID: 1, Confidence: 0.75, Left: 0, Top: 0.25, Right: 1, Bottom: 1},
+			},
+		},
+		{
+			"count below detections",
+			ssdOutput(1,
+				[ssdDetectionSize]float32{0, 1, 0.75, 0, 0, 1, 1},
+				[ssdDetectionSize]float32{0, 2, 0.75, 0, 0, 1, 1}),
+			0.5,
+			[]Detection{
+				{ClassID: 1, Confidence: 0.75, Left: 0, Top: 0, Right: 1, Bottom: 1},
+			},
+		},
+		{
+			"nan count",
+			ssdOutput(nan, [ssdDetectionSize]float32{0, 1, 0.75, 0, 0, 1, 1}),
+			0.5,
+			nil,
+		},
+		{
+			"no detections",
+			ssdOutput(0),
+			0.5,
+			nil,
+		},
+	}
+
+	for _, tc := range tests {
+		fp32 := make([]byte, len(tc.vals)*4)
+		for i, v := range tc.vals {
+			binary.LittleEndian.PutUint32(fp32[i*4:], math.Float32bits(v))
+		}
+		fp16 := make([]byte, len(tc.vals)*2)
+		if err := FP32ToFP16(fp16, fp32); err != nil {
+			t.Fatalf("%s: failed to convert to FP16: %s", tc.name, err)
+		}
+
+		for _, data := range []struct {
+			dataType FifoDataType
+			data     []byte
+		}{
+			{FifoFP32, fp32},
+			{FifoFP16, fp16},
+		} {
+			dets, err := DecodeSSD(nil, data.data, data.dataType, tc.minConfidence)
+			if err != nil {
+				t.Fatalf("%s/%s: failed to decode SSD output: %s", tc.name, data.dataType, err)
+			}
+
+			if len(dets) != len(tc.expected) {
+				t.Fatalf("%s/%s: expected %d detections, got %d: %+v", tc.name, data.dataType, len(tc.expected), len(dets), dets)
+			}
+			for i := range dets {
+				if dets[i] != tc.expected[i] {
+					t.Errorf("%s/%s: detection %d: expected %+v, got %+v", tc.name, data.dataType, i, tc.expected[i], dets[i])
+				}
+			}
+		}
+	}
+}
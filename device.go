@@ -1,6 +1,6 @@
 package ncs
 
-// #cgo LDFLAGS: -lmvnc
+// #cgo !ncsmock LDFLAGS: -lmvnc
 /*
 #include <ncs.h>
 */
@@ -121,6 +121,18 @@ var deviceOptSize = map[Option]uint{
 	RODeviceHWVersion:           C.sizeof_int,
 }
 
+// deviceImmutableOpts are device options which do not change once the device is opened
+var deviceImmutableOpts = []Option{
+	RODeviceMemorySize,
+	RODeviceMaxFifoCount,
+	RODeviceMaxGraphCount,
+	RODeviceClassLimit,
+	RODeviceFirmwareVersion,
+	RODeviceMVTensorVersion,
+	RODeviceName,
+	RODeviceHWVersion,
+}
+
 // String implements fmt.Stringer interface for DeviceOption
 func (do DeviceOption) String() string {
 	switch do {
@@ -260,6 +272,7 @@ func (ds DeviceState) String() string {
 // Device is Neural Compute Stick (NCS) device
 type Device struct {
 	handle unsafe.Pointer
+	opts   optCache
 }
 
 // NewDevice creates new NCS device handle and returns it.
@@ -290,10 +303,19 @@ func (d *Device) Open() error {
 		return fmt.Errorf("Failed to open device: %s", Status(s))
 	}
 
+	d.opened()
+
 	return nil
 }
 
+// opened caches immutable options of the opened device and registers it for instrumentation
+func (d *Device) opened() {
+	cacheOptions("device", d.handle, &d.opts, deviceImmutableOpts, deviceOptSize)
+	C.ncs_StatsRegister(d.handle, nil)
+}
+
 // GetOption queries the value of an option for the device and returns it encoded in a byte slice.
+// Immutable options are cached when the device is opened and are returned without querying the device.
 // It returns error if it fails to retrieve the option value.
 //
 // For more information:
@@ -303,16 +325,7 @@ func (d *Device) GetOption(opt DeviceOption) ([]byte, error) {
 		return nil, fmt.Errorf("Option %s not implemented", opt)
 	}
 
-	var data unsafe.Pointer
-	var dataLen C.uint
-
-	s := C.ncs_DeviceGetOption(d.handle, C.int(opt), data, &dataLen)
-
-	if Status(s) == StatusInvalidDataLength {
-		return d.GetOptionWithByteSize(opt, deviceOptSize[opt]*uint(dataLen))
-	}
-
-	return nil, fmt.Errorf("Failed to read %s option: %s", opt, Status(s))
+	return queryOption("device", d.handle, &d.opts, opt, deviceOptSize[opt])
 }
 
 // GetOptionsWithSize queries NCS device options and returns it encoded in a byte slice of size elements.
@@ -326,7 +339,22 @@ func (d *Device) GetOptionWithByteSize(opt DeviceOption, size uint) ([]byte, err
 		return nil, fmt.Errorf("Option %s not implemented", opt)
 	}
 
-	return getOption("device", d.handle, opt, size)
+	return querySizedOption("device", d.handle, &d.opts, opt, size)
+}
+
+// uintOption queries device option opt whose value is a single unsigned integer
+func (d *Device) uintOption(opt DeviceOption) (uint, error) {
+	opts, err := d.GetOptionWithByteSize(opt, deviceOptSize[opt])
+	if err != nil {
+		return 0, err
+	}
+
+	val, err := opt.Decode(opts, 1)
+	if err != nil {
+		return 0, err
+	}
+
+	return val.(uint), nil
 }
 
 // Close closes the communication channel with NCS device.
@@ -336,6 +364,7 @@ func (d *Device) GetOptionWithByteSize(opt DeviceOption, size uint) ([]byte, err
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncDeviceClose.html
 func (d *Device) Close() error {
 	s := C.ncs_DeviceClose(d.handle)
+	d.opts.reset()
 
 	if Status(s) != StatusOK {
 		return fmt.Errorf("Failed to close device: %s", Status(s))
@@ -350,7 +379,9 @@ func (d *Device) Close() error {
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncDeviceDestroy.html
 func (d *Device) Destroy() error {
+	C.ncs_StatsUnregister(d.handle)
 	s := C.ncs_DeviceDestroy(&d.handle)
+	d.opts.reset()
 
 	if Status(s) != StatusOK {
 		return fmt.Errorf("Failed to destroy device: %s", Status(s))
@@ -0,0 +1,617 @@
+package ncs
+
+import (
+	"context"
+	"fmt"
+	"sort"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// poolResult is the result of an inference queued on a pool device
+type poolResult struct {
+	tensor *Tensor
+	err    error
+}
+
+// PoolDevice is NCS device managed by DevicePool.
+// When the device fails DevicePool re-creates it in the background, replacing its Device, Graph and Queue, so they must not be used unless the device is Healthy.
+type PoolDevice struct {
+	// Index is the index the device was created with
+	Index int
+	// Device is NCS device
+	Device *Device
+	// Graph is the graph allocated on the device
+	Graph *Graph
+	// Queue is FIFO queue the graph inferences are queued to
+	Queue *FifoQueue
+	// depth is the number of elements inbound FIFO can hold
+	depth int
+	// ringSize is the number of results the reader buffers
+	ringSize uint
+	// pool recovers the device when it fails; it's nil if the device is not managed by DevicePool
+	pool *DevicePool
+	// reader reads inference results from queue outbound FIFO
+	reader *FifoReader
+	// exited is closed once dispatch has delivered the results of all the inferences read by reader
+	exited chan struct{}
+	// mu serializes queueing inferences so the order of pending requests matches outbound FIFO order
+	mu sync.Mutex
+	// state guards the device resources along with err, failed and closed, so the resources are not torn down while they are in use
+	state sync.RWMutex
+	// queueMu is read locked while the queue fill levels are sampled and locked while the queue is destroyed,
+	// so sampling does not hold state over device round trips
+	queueMu sync.RWMutex
+	// pending contains requests of queued inferences in the order they were queued
+	pending chan *schedRequest
+	// slots holds a token for every request in pending and every request being queued.
+	// Tokens are taken before state is locked, so sending to pending never blocks while dispatch waits for state to mark the device failed.
+	slots chan struct{}
+	// err is the error which stopped the reader of the device which can't be recovered
+	err error
+	// failed is set when the device fails and cleared once it has been recovered
+	failed bool
+	// closed is set when the device is being destroyed
+	closed bool
+	// recoveries is the number of times the device has been recovered
+	recoveries uint64
+}
+
+// newPoolDevice wraps the device brought up by OpenAll into PoolDevice and starts reading its inference results.
+// The device is recovered by pool p when it fails unless p is nil.
+// The returned PoolDevice takes ownership of the device. If it fails, the device is destroyed and error is returned.
+func newPoolDevice(p *DevicePool, r OpenResult, inOpts, outOpts *FifoOpts) (*PoolDevice, error) {
+	pd := &PoolDevice{
+		Index:    r.Index,
+		depth:    inOpts.NumElem,
+		ringSize: uint(outOpts.NumElem),
+		pool:     p,
+		pending:  make(chan *schedRequest, inOpts.NumElem+outOpts.NumElem),
+		slots:    make(chan struct{}, inOpts.NumElem+outOpts.NumElem),
+	}
+
+	if err := pd.start(r); err != nil {
+		r.Destroy()
+		return nil, err
+	}
+
+	return pd, nil
+}
+
+// start starts serving inferences on the device resources brought up in r.
+// It returns error if the device has been destroyed or if it fails to start reading inference results.
+func (pd *PoolDevice) start(r OpenResult) error {
+	reader, err := r.Queue.Out.NewReader(pd.ringSize)
+	if err != nil {
+		return err
+	}
+	exited := make(chan struct{})
+
+	pd.state.Lock()
+	if pd.closed {
+		pd.state.Unlock()
+		reader.Destroy()
+		return fmt.Errorf("Failed to start device %d: device closed", pd.Index)
+	}
+	pd.Device, pd.Graph, pd.Queue = r.Device, r.Graph, r.Queue
+	pd.reader, pd.exited = reader, exited
+	pd.err, pd.failed = nil, false
+	pd.state.Unlock()
+
+	go pd.dispatch(reader, exited)
+
+	return nil
+}
+
+// dispatch delivers inference results read by reader to the requests in the order they were queued.
+// Once reader stops the remaining requests are requeued on the other pool devices if the device has failed or they fail with error otherwise.
+func (pd *PoolDevice) dispatch(reader *FifoReader, exited chan struct{}) {
+	defer close(exited)
+
+	for t := range reader.Results() {
+		req := <-pd.pending
+		<-pd.slots
+		req.reply <- poolResult{tensor: t}
+	}
+
+	err := reader.Err()
+	if deviceFailure(reader.failure()) {
+		pd.fail()
+	}
+
+	// no more inferences are queued on the device once it's failed, closed or err is set
+	pd.state.Lock()
+	requeue := pd.failed && !pd.closed
+	if !requeue && pd.err == nil {
+		if err == nil {
+			err = fmt.Errorf("Failed to read inference result: device %d closed", pd.Index)
+		}
+		pd.err = err
+	}
+	err = pd.err
+	pd.state.Unlock()
+
+	if requeue {
+		err = fmt.Errorf("Failed to read inference result: device %d failed", pd.Index)
+	}
+
+	for {
+		select {
+		case req := <-pd.pending:
+			<-pd.slots
+			if requeue {
+				pd.pool.requeue(req, err)
+				continue
+			}
+			req.reply <- poolResult{err: err}
+		default:
+			return
+		}
+	}
+}
+
+// enqueue queues request inference on the device.
+// It waits for a pending slot if the device already has as many inferences in flight as its FIFOs can hold.
+// It returns true along with error if the device has failed, so the request can be queued on another device.
+func (pd *PoolDevice) enqueue(req *schedRequest) (bool, error) {
+	pd.mu.Lock()
+	defer pd.mu.Unlock()
+
+	// dispatch frees the slots as it delivers or drains the pending requests, so the wait ends even if the device fails
+	pd.slots <- struct{}{}
+
+	pd.state.RLock()
+	var retry bool
+	var err error
+	switch {
+	case pd.closed:
+		err = fmt.Errorf("Failed to queue inference: device %d closed", pd.Index)
+	case pd.failed:
+		retry, err = true, fmt.Errorf("Failed to queue inference: device %d failed", pd.Index)
+	case pd.err != nil:
+		err = pd.err
+	}
+	if err != nil {
+		pd.state.RUnlock()
+		<-pd.slots
+		return retry, err
+	}
+
+	s, err := pd.Graph.queueInferenceWithFifoElem(pd.Queue, req.data, nil)
+	if err == nil {
+		pd.pending <- req
+	}
+	pd.state.RUnlock()
+
+	if err != nil {
+		<-pd.slots
+	}
+
+	if err != nil && deviceFailure(s) {
+		return pd.fail(), err
+	}
+
+	return false, err
+}
+
+// queue queues data for inference on the device and returns a channel which delivers its result.
+// If the device has failed the inference is queued on another pool device.
+func (pd *PoolDevice) queue(data []byte) (<-chan poolResult, error) {
+	req := &schedRequest{
+		data:  data,
+		reply: make(chan poolResult, 1),
+	}
+
+	retry, err := pd.enqueue(req)
+	if retry {
+		pd.pool.requeue(req, err)
+		return req.reply, nil
+	}
+
+	if err != nil {
+		return nil, err
+	}
+
+	return req.reply, nil
+}
+
+// fail marks the device failed and starts recovering it in the background.
+// It returns false if the device can't be recovered because it's not managed by DevicePool or it's being destroyed.
+func (pd *PoolDevice) fail() bool {
+	if pd.pool == nil {
+		return false
+	}
+
+	pd.state.Lock()
+	if pd.closed {
+		pd.state.Unlock()
+		return false
+	}
+	failed := pd.failed
+	pd.failed = true
+	pd.state.Unlock()
+
+	if !failed {
+		pd.pool.recover(pd)
+	}
+
+	return true
+}
+
+// teardown stops reading inference results from the device and destroys all the resources allocated for it.
+// Inferences which are in flight are requeued or failed by dispatch before the resources are destroyed.
+func (pd *PoolDevice) teardown() {
+	pd.state.Lock()
+	reader, exited := pd.reader, pd.exited
+	pd.reader = nil
+	pd.state.Unlock()
+
+	if reader != nil {
+		reader.Destroy()
+		<-exited
+	}
+
+	pd.state.Lock()
+	r := OpenResult{Device: pd.Device, Graph: pd.Graph, Queue: pd.Queue}
+	pd.Device, pd.Graph, pd.Queue = nil, nil, nil
+	pd.state.Unlock()
+
+	pd.queueMu.Lock()
+	defer pd.queueMu.Unlock()
+
+	r.Destroy()
+}
+
+// sampleFill samples the fill levels of the device queue into fill or resets them if the device does not take inferences
+func (pd *PoolDevice) sampleFill(fill *fillLevels) {
+	pd.queueMu.RLock()
+	defer pd.queueMu.RUnlock()
+
+	pd.state.RLock()
+	q := pd.Queue
+	if pd.closed || pd.failed {
+		q = nil
+	}
+	pd.state.RUnlock()
+
+	if q == nil {
+		fill.reset()
+		return
+	}
+
+	fill.sample(q)
+}
+
+// load returns the number of inputs waiting in inbound FIFO and the number of inferences in flight.
+// It returns error if the device does not take inferences.
+func (pd *PoolDevice) load() (uint, int, error) {
+	pd.state.RLock()
+	defer pd.state.RUnlock()
+
+	if pd.closed || pd.failed || pd.err != nil {
+		return 0, 0, fmt.Errorf("Failed to query device %d load: device not available", pd.Index)
+	}
+
+	opts, err := pd.Queue.In.GetOptionWithByteSize(ROFifoWriteFillLevel, fifoOptSize[ROFifoWriteFillLevel])
+	if err != nil {
+		return 0, 0, err
+	}
+
+	level, err := ROFifoWriteFillLevel.Decode(opts, 1)
+	if err != nil {
+		return 0, 0, err
+	}
+
+	return level.(uint), len(pd.pending), nil
+}
+
+// thermalThrottle queries the thermal throttle level of the device.
+// It returns error if the device is not available.
+func (pd *PoolDevice) thermalThrottle() (uint, error) {
+	pd.state.RLock()
+	defer pd.state.RUnlock()
+
+	if pd.closed || pd.failed || pd.Device == nil {
+		return 0, fmt.Errorf("Failed to query device %d thermal throttle: device not available", pd.Index)
+	}
+
+	return pd.Device.uintOption(RODeviceThermalThrottle)
+}
+
+// Healthy returns true if the device takes inferences, i.e. it has not failed or it has been recovered
+func (pd *PoolDevice) Healthy() bool {
+	pd.state.RLock()
+	defer pd.state.RUnlock()
+
+	return !pd.closed && !pd.failed && pd.err == nil
+}
+
+// Recoveries returns the number of times the device has been recovered after it failed
+func (pd *PoolDevice) Recoveries() uint64 {
+	return atomic.LoadUint64(&pd.recoveries)
+}
+
+// destroy destroys all the resources allocated for the device
+func (pd *PoolDevice) destroy() {
+	pd.state.Lock()
+	pd.closed = true
+	pd.state.Unlock()
+
+	pd.teardown()
+}
+
+// deviceFailure returns true if NCSDK status s means the device has failed, e.g. because it has been reset or unplugged
+func deviceFailure(s Status) bool {
+	switch s {
+	case StatusError, StatusTimeout, StatusMyriadError, StatusDeviceNotFound:
+		return true
+	}
+
+	return false
+}
+
+const (
+	// recoverBackoff is the time DevicePool waits before retrying to bring up the failed device for the first time
+	recoverBackoff = 100 * time.Millisecond
+	// maxRecoverBackoff is the maximum time DevicePool waits between retries to bring up the failed device
+	maxRecoverBackoff = 10 * time.Second
+)
+
+// DevicePool is a pool of all NCS devices attached to the host with the same graph allocated on each of them.
+// Inferences are dispatched to the least loaded device, so throughput scales with the number of devices.
+// When any call on a device fails with a status which means the device has failed, e.g. because it has been reset or unplugged,
+// the inferences in flight on it are requeued on the healthy devices and the device is re-created, opened and the graph re-allocated on it in the background.
+// DevicePool is safe for concurrent use.
+type DevicePool struct {
+	// name, graphData, inOpts and outOpts configure the graph allocated on recovered devices
+	name      string
+	graphData []byte
+	inOpts    *FifoOpts
+	outOpts   *FifoOpts
+	// mu guards devices and closed so no device is recovered once the pool has been destroyed
+	mu      sync.RWMutex
+	devices []*PoolDevice
+	closed  bool
+	// done is closed when the pool is destroyed
+	done chan struct{}
+	// wg waits for the devices being recovered
+	wg sync.WaitGroup
+}
+
+// NewDevicePool creates and opens all NCS devices attached to the host and allocates graphData graph with FIFOs configured by inOpts and outOpts on each of them.
+// Devices are enumerated from index 0 until creating a device fails and they are all brought up concurrently by OpenAll.
+// It returns error if no device is found or if any found device fails to be opened or to allocate the graph.
+func NewDevicePool(name string, graphData []byte, inOpts, outOpts *FifoOpts) (*DevicePool, error) {
+	results, err := OpenAll(context.Background(), &OpenOpts{
+		GraphName: name,
+		GraphData: graphData,
+		InOpts:    inOpts,
+		OutOpts:   outOpts,
+	})
+	if err != nil {
+		return nil, fmt.Errorf("Failed to create device pool: %s", err)
+	}
+
+	p := &DevicePool{
+		name:      name,
+		graphData: graphData,
+		inOpts:    inOpts,
+		outOpts:   outOpts,
+		done:      make(chan struct{}),
+	}
+
+	// all the results are collected so no device is left behind if any of them fails
+	var failure error
+	for r := range results {
+		if r.Err != nil {
+			if failure == nil {
+				failure = fmt.Errorf("Failed to add device %d to pool: %s", r.Index, r.Err)
+			}
+			continue
+		}
+
+		pd, err := newPoolDevice(p, r, inOpts, outOpts)
+		if err != nil {
+			if failure == nil {
+				failure = fmt.Errorf("Failed to add device %d to pool: %s", r.Index, err)
+			}
+			continue
+		}
+		p.mu.Lock()
+		p.devices = append(p.devices, pd)
+		p.mu.Unlock()
+	}
+
+	if failure != nil {
+		p.Destroy()
+		return nil, failure
+	}
+
+	// devices are brought up in the order they become ready
+	p.mu.Lock()
+	sort.Slice(p.devices, func(i, j int) bool { return p.devices[i].Index < p.devices[j].Index })
+	p.mu.Unlock()
+
+	return p, nil
+}
+
+// Devices returns pool devices
+func (p *DevicePool) Devices() []*PoolDevice {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	return p.devices
+}
+
+// leastLoaded returns the healthy device with the fewest inputs waiting in its inbound FIFO.
+// Ties are broken by the number of inferences in flight.
+func (p *DevicePool) leastLoaded() (*PoolDevice, error) {
+	var best *PoolDevice
+	var bestLevel uint
+	var bestPending int
+
+	for _, pd := range p.Devices() {
+		level, pending, err := pd.load()
+		if err != nil {
+			continue
+		}
+
+		if best == nil || level < bestLevel || (level == bestLevel && pending < bestPending) {
+			best, bestLevel, bestPending = pd, level, pending
+		}
+	}
+
+	if best == nil {
+		return nil, fmt.Errorf("Failed to find available device: %s", StatusDeviceNotFound)
+	}
+
+	return best, nil
+}
+
+// requeue queues request which was queued on a failed device on the least loaded healthy device.
+// A request is requeued at most once per pool device, so an input which fails every device does not bounce between them forever.
+// The request fails with err if no healthy device takes it.
+func (p *DevicePool) requeue(req *schedRequest, err error) {
+	for req.requeues < len(p.Devices()) {
+		req.requeues++
+
+		pd, e := p.leastLoaded()
+		if e != nil {
+			err = e
+			break
+		}
+
+		retry, e := pd.enqueue(req)
+		if e == nil {
+			return
+		}
+
+		err = e
+		if !retry {
+			break
+		}
+	}
+
+	req.reply <- poolResult{err: err}
+}
+
+// recover starts recovering the failed device in the background unless the pool has been destroyed
+func (p *DevicePool) recover(pd *PoolDevice) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if p.closed {
+		return
+	}
+
+	p.wg.Add(1)
+	go p.recoverDevice(pd)
+}
+
+// recoverDevice destroys the resources of the failed device and brings it up again.
+// Bringing up the device is retried with exponential backoff until it succeeds or the pool is destroyed.
+func (p *DevicePool) recoverDevice(pd *PoolDevice) {
+	defer p.wg.Done()
+
+	pd.teardown()
+
+	backoff := recoverBackoff
+	for {
+		r := p.open(pd.Index)
+		if r.Err == nil {
+			if err := pd.start(r); err == nil {
+				atomic.AddUint64(&pd.recoveries, 1)
+				return
+			}
+			r.Destroy()
+		}
+
+		t := time.NewTimer(backoff)
+		select {
+		case <-t.C:
+		case <-p.done:
+			t.Stop()
+			return
+		}
+
+		if backoff *= 2; backoff > maxRecoverBackoff {
+			backoff = maxRecoverBackoff
+		}
+	}
+}
+
+// open creates and opens the device with the given index and allocates the pool graph on it.
+// A device which has been reset or replugged into the same port is enumerated with the same index.
+func (p *DevicePool) open(index int) OpenResult {
+	r := OpenResult{Index: index}
+
+	fail := func(err error) OpenResult {
+		r.Destroy()
+		return OpenResult{Index: index, Err: fmt.Errorf("Failed to open device %d: %s", index, err)}
+	}
+
+	var err error
+	if r.Device, err = NewDevice(index); err != nil {
+		return fail(err)
+	}
+
+	if err = r.Device.Open(); err != nil {
+		return fail(err)
+	}
+
+	if r.Graph, err = NewGraph(p.name); err != nil {
+		return fail(err)
+	}
+
+	if r.Queue, err = r.Graph.AllocateWithFifosOpts(r.Device, p.graphData, p.inOpts, p.outOpts); err != nil {
+		return fail(err)
+	}
+
+	return r
+}
+
+// Infer queues data for inference on the least loaded device and waits for its result.
+// If the device fails before the result is read the inference is requeued on another healthy device.
+// It returns error if it fails to queue the inference or to read its result.
+func (p *DevicePool) Infer(data []byte) (*Tensor, error) {
+	pd, err := p.leastLoaded()
+	if err != nil {
+		return nil, err
+	}
+
+	reply, err := pd.queue(data)
+	if err != nil {
+		return nil, err
+	}
+
+	res := <-reply
+
+	return res.tensor, res.err
+}
+
+// Destroy stops recovering failed devices and destroys all pool devices along with their graphs and FIFOs.
+// Inferences which are in flight when Destroy is called fail with error.
+// Destroying already destroyed pool has no effect.
+func (p *DevicePool) Destroy() error {
+	p.mu.Lock()
+	if p.closed {
+		p.mu.Unlock()
+		return nil
+	}
+	p.closed = true
+	close(p.done)
+	p.mu.Unlock()
+
+	p.wg.Wait()
+
+	for _, pd := range p.Devices() {
+		pd.destroy()
+	}
+
+	p.mu.Lock()
+	p.devices = nil
+	p.mu.Unlock()
+
+	return nil
+}
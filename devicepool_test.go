@@ -0,0 +1,99 @@
+//go:build ncsmock
+// +build ncsmock
+
+package ncs
+
+import (
+	"os"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+// TestMain configures the simulated devices the tests run on.
+// The mock reads its configuration once per process, so device 0 resets once after NCS_MOCK_FAULT inferences for the whole test binary.
+func TestMain(m *testing.M) {
+	mockEnv := map[string]string{
+		"NCS_MOCK_DEVICES": "2",
+		"NCS_MOCK_LATENCY": "1ms",
+		"NCS_MOCK_FAULT":   "20",
+	}
+	for k, v := range mockEnv {
+		if _, ok := os.LookupEnv(k); !ok {
+			os.Setenv(k, v)
+		}
+	}
+
+	os.Exit(m.Run())
+}
+
+// mockFaulted is set once a test has run device 0 past its fault, since later tests, including repeated runs, never see it fail
+var mockFaulted bool
+
+func newTestPool(t testing.TB) *DevicePool {
+	in := &FifoOpts{Type: FifoHostWO, DataType: FifoFP32, NumElem: 2}
+	out := &FifoOpts{Type: FifoHostRO, DataType: FifoFP32, NumElem: 2}
+
+	p, err := NewDevicePool("test", make([]byte, 1<<10), in, out)
+	if err != nil {
+		t.Fatalf("failed to create device pool: %s", err)
+	}
+
+	return p
+}
+
+func TestDevicePoolFaultUnderLoad(t *testing.T) {
+	p := newTestPool(t)
+	defer p.Destroy()
+
+	const workers, inferences = 32, 25
+	data := make([]byte, 224*224*3*4)
+
+	var fails int64
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := 0; i < inferences; i++ {
+				if _, err := p.Infer(data); err != nil {
+					atomic.AddInt64(&fails, 1)
+				}
+			}
+		}()
+	}
+
+	done := make(chan struct{})
+	go func() {
+		wg.Wait()
+		close(done)
+	}()
+
+	select {
+	case <-done:
+	case <-time.After(30 * time.Second):
+		t.Fatal("inferences did not complete: pool deadlocked while device was failing")
+	}
+
+	if fails != 0 {
+		t.Errorf("expected failed device inferences to be requeued, got %d failed inferences", fails)
+	}
+
+	devices := p.Devices()
+	deadline := time.Now().Add(10 * time.Second)
+	for !devices[0].Healthy() && time.Now().Before(deadline) {
+		time.Sleep(10 * time.Millisecond)
+	}
+
+	if !mockFaulted && devices[0].Recoveries() == 0 {
+		t.Errorf("expected device 0 to be recovered")
+	}
+	mockFaulted = true
+
+	for i := 0; i < 2*inferences; i++ {
+		if _, err := p.Infer(data); err != nil {
+			t.Fatalf("failed to infer on recovered pool: %s", err)
+		}
+	}
+}
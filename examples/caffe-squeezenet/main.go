@@ -2,10 +2,6 @@ package main
 
 import (
 	"bufio"
-	"bytes"
-	"encoding/binary"
-	"image"
-	"io/ioutil"
 	"log"
 	"os"
 	"path/filepath"
@@ -14,32 +10,7 @@ import (
 	"gocv.io/x/gocv"
 )
 
-var meanBGR = []float64{0.40787054 * 255.0, 0.45752458 * 255.0, 0.48109378 * 255.0}
-var imgSize = image.Point{227, 227}
-
-// meanCenter pre-preprocesses image so each of its layer pixels have zero mean
-func meanCenter(img gocv.Mat, meanBGR []float64) gocv.Mat {
-	r, c := img.Rows(), img.Cols()
-	meanB, meanG, meanR := meanBGR[0], meanBGR[1], meanBGR[2]
-
-	// create mean centered image layer by layer
-	meanBMat := gocv.NewMatWithSizeFromScalar(gocv.NewScalar(meanB, meanB, meanB, 0.0), r, c, gocv.MatTypeCV64F)
-	meanGMat := gocv.NewMatWithSizeFromScalar(gocv.NewScalar(meanG, meanG, meanG, 0.0), r, c, gocv.MatTypeCV64F)
-	meanRMat := gocv.NewMatWithSizeFromScalar(gocv.NewScalar(meanR, meanR, meanR, 0.0), r, c, gocv.MatTypeCV64F)
-
-	meanMatImg := gocv.NewMat()
-	gocv.Merge([]gocv.Mat{meanBMat, meanGMat, meanRMat}, &meanMatImg)
-	defer meanMatImg.Close()
-
-	floatImg := gocv.NewMat()
-	defer floatImg.Close()
-	img.ConvertTo(&floatImg, gocv.MatTypeCV64F)
-
-	zeroMean := gocv.NewMat()
-	gocv.Subtract(floatImg, meanMatImg, &zeroMean)
-
-	return zeroMean
-}
+var meanBGR = [3]float32{0.40787054 * 255.0, 0.45752458 * 255.0, 0.48109378 * 255.0}
 
 // readLabels reads labels file stored in labelsPath and returns it as a slice of strings
 func readLabels(path string) ([]string, error) {
@@ -58,19 +29,14 @@ func readLabels(path string) ([]string, error) {
 	return lines, scanner.Err()
 }
 
-// prepareImg preprocesses image for NCS
-func prepareImg(img gocv.Mat) gocv.Mat {
-	// resize the image
-	resized := gocv.NewMat()
-	defer resized.Close()
-	gocv.Resize(img, &resized, image.Pt(227, 227), 0, 0, gocv.InterpolationDefault)
-	// zero-mean centering
-	zeroMeanImg := meanCenter(resized, meanBGR)
-	// convert to FP32 for NCS
-	fp32Image := gocv.NewMat()
-	zeroMeanImg.ConvertTo(&fp32Image, gocv.MatTypeCV32F)
-
-	return fp32Image
+// bgrImage wraps gocv image pixels in ncs.BGRImage
+func bgrImage(img gocv.Mat) *ncs.BGRImage {
+	return &ncs.BGRImage{
+		Data:   img.ToBytes(),
+		Width:  img.Cols(),
+		Height: img.Rows(),
+		Stride: img.Cols() * 3,
+	}
 }
 
 func main() {
@@ -107,14 +73,15 @@ func main() {
 	log.Printf("NCS graph handle successfully created")
 
 	graphFileName := "squeezenet_graph"
-	graphData, e := ioutil.ReadFile(graphFileName)
+	graphFile, e := ncs.LoadGraphFile(graphFileName)
 	if e != nil {
 		err = e
 		return
 	}
+	defer graphFile.Close()
 
 	log.Printf("Attempting to allocate NCS graph")
-	queue, e := graph.AllocateWithFifosOpts(dev, graphData,
+	queue, e := graph.AllocateWithFifosOpts(dev, graphFile.Data(),
 		&ncs.FifoOpts{ncs.FifoHostWO, ncs.FifoFP32, 2},
 		&ncs.FifoOpts{ncs.FifoHostRO, ncs.FifoFP32, 2})
 	if e != nil {
@@ -130,9 +97,11 @@ func main() {
 	log.Printf("Attempting to read image %s", imgPath)
 	img := gocv.IMRead(imgPath, gocv.IMReadColor)
 
-	ncsImg := prepareImg(img)
+	// image is resized to graph input size and zero-mean centered when it's queued for inference
+	pre := ncs.NewPreprocessor(&ncs.PreprocessOpts{Mean: meanBGR, Scale: [3]float32{1.0, 1.0, 1.0}})
+	defer pre.Destroy()
 	log.Printf("Attempting to queue %s for inference", imgPath)
-	err = graph.QueueInferenceWithFifoElem(queue, ncsImg.ToBytes(), nil)
+	err = graph.QueueInferenceWithFifoElemBGR(queue, pre, bgrImage(img), nil)
 	if err != nil {
 		return
 	}
@@ -155,21 +124,13 @@ func main() {
 	}
 	log.Printf("Read %d labels from %s", len(labels), labelsPath)
 
-	// Decode the result
-	var result [1000]float32
-	buf := bytes.NewReader(tensor.Data)
-	if e := binary.Read(buf, binary.LittleEndian, &result); e != nil {
+	// select the most probable classes
+	preds, e := ncs.TopK(tensor, ncs.FifoFP32, 5)
+	if e != nil {
 		err = e
 		return
 	}
-	// find max and value
-	max := result[0]
-	idx := 0
-	for i, val := range result {
-		if max < val {
-			max = val
-			idx = i
-		}
+	for _, p := range preds {
+		log.Printf("Prediction: %v, Probability: %v", labels[p.ClassID], p.Probability)
 	}
-	log.Printf("Prediction: %v, Probability: %v", labels[idx], max)
 }
@@ -5,9 +5,7 @@ import (
 	"fmt"
 	"image"
 	"image/color"
-	"io/ioutil"
 	"log"
-	"math"
 	"os"
 	"path/filepath"
 
@@ -15,23 +13,6 @@ import (
 	"gocv.io/x/gocv"
 )
 
-// checks if the number is finite i.e. not NaN or in (-Inf, Inf) interval
-func isFinite(f float64) bool {
-	if math.IsNaN(f) {
-		return false
-	}
-
-	if math.IsInf(f, 1) {
-		return false
-	}
-
-	if math.IsInf(f, -1) {
-		return false
-	}
-
-	return true
-}
-
 // readLabels reads labels file stored in labelsPath and returns it as a slice of strings
 func readLabels(path string) ([]string, error) {
 	file, err := os.Open(path)
@@ -49,49 +30,21 @@ func readLabels(path string) ([]string, error) {
 	return lines, scanner.Err()
 }
 
-// prepareImg preprocesses image for NCS
-func prepareImg(img gocv.Mat) gocv.Mat {
-	// resize the image
-	resized := gocv.NewMat()
-	defer resized.Close()
-	gocv.Resize(img, &resized, image.Pt(300, 300), 0, 0, gocv.InterpolationDefault)
-
-	floatImg := gocv.NewMat()
-	defer floatImg.Close()
-	resized.ConvertTo(&floatImg, gocv.MatTypeCV64F)
-
-	fp32Image := gocv.NewMat()
-	floatImg.ConvertTo(&fp32Image, gocv.MatTypeCV32F)
-
-	fp32Image.SubtractFloat(127.5)
-	fp32Image.MultiplyFloat(0.007843)
-
-	return fp32Image
-}
-
 // drawBoxes draws the boxes and labels of all detected objects into the original image
-func drawBoxesAndLabels(img, result gocv.Mat, labels []string) {
-	boxes := int(result.GetFloatAt(0, 0))
+func drawBoxesAndLabels(img gocv.Mat, detections []ncs.Detection, labels []string) {
 	rows, cols := img.Rows(), img.Cols()
-	for i := 0; i < boxes; i++ {
-		idx := 7 + i*7
-		if !(isFinite(float64(result.GetFloatAt(0, idx))) &&
-			isFinite(float64(result.GetFloatAt(0, idx+1))) &&
-			isFinite(float64(result.GetFloatAt(0, idx+2))) &&
-			isFinite(float64(result.GetFloatAt(0, idx+3))) &&
-			isFinite(float64(result.GetFloatAt(0, idx+4))) &&
-			isFinite(float64(result.GetFloatAt(0, idx+5))) &&
-			isFinite(float64(result.GetFloatAt(0, idx+6)))) {
+	for i, d := range detections {
+		if int(d.ClassID) >= len(labels) {
 			continue
 		}
 
-		x1 := math.Max(0, float64(result.GetFloatAt(0, idx+3))*float64(rows))
-		y1 := math.Max(0, float64(result.GetFloatAt(0, idx+4))*float64(cols))
-		x2 := math.Min(float64(rows), float64(result.GetFloatAt(0, idx+5))*float64(rows))
-		y2 := math.Min(float64(cols), float64(result.GetFloatAt(0, idx+6))*float64(cols))
+		x1 := float64(d.Left) * float64(cols)
+		y1 := float64(d.Top) * float64(rows)
+		x2 := float64(d.Right) * float64(cols)
+		y2 := float64(d.Bottom) * float64(rows)
 
-		classID := labels[int(result.GetFloatAt(0, idx+1))]
-		confidence := result.GetFloatAt(0, idx+2) * 100.0
+		classID := labels[d.ClassID]
+		confidence := d.Confidence * 100.0
 
 		log.Printf("Box at: %d: ClassID: %s Confidence: %.2f, Top Left: (%d, %d) Bottom Right: (%d, %d)",
 			i, classID, confidence, int(x1), int(y1), int(x2), int(y2))
@@ -116,6 +69,16 @@ func drawBoxesAndLabels(img, result gocv.Mat, labels []string) {
 	}
 }
 
+// bgrImage wraps gocv image pixels in ncs.BGRImage
+func bgrImage(img gocv.Mat) *ncs.BGRImage {
+	return &ncs.BGRImage{
+		Data:   img.ToBytes(),
+		Width:  img.Cols(),
+		Height: img.Rows(),
+		Stride: img.Cols() * 3,
+	}
+}
+
 func main() {
 	var err error
 	defer func() {
@@ -151,14 +114,15 @@ func main() {
 	log.Printf("NCS graph handle successfully created")
 
 	graphFileName := "ssd_mobilenet_graph"
-	graphData, e := ioutil.ReadFile(graphFileName)
+	graphFile, e := ncs.LoadGraphFile(graphFileName)
 	if e != nil {
 		err = e
 		return
 	}
+	defer graphFile.Close()
 
 	log.Printf("Attempting to allocate NCS graph")
-	queue, err := graph.AllocateWithFifosOpts(dev, graphData,
+	queue, err := graph.AllocateWithFifosOpts(dev, graphFile.Data(),
 		&ncs.FifoOpts{ncs.FifoHostWO, ncs.FifoFP16, 2},
 		&ncs.FifoOpts{ncs.FifoHostRO, ncs.FifoFP16, 2})
 	if e != nil {
@@ -173,11 +137,14 @@ func main() {
 	imgPath := filepath.Join("nps_chair.png")
 	log.Printf("Attempting to read image %s", imgPath)
 	img := gocv.IMRead(imgPath, gocv.IMReadColor)
-	// need to submit FP16 image
-	fp32Image := prepareImg(img)
-	ncsImg := fp32Image.ConvertFp16()
+	// image is resized to graph input size, scaled and converted to FP16 when it's queued for inference
+	pre := ncs.NewPreprocessor(&ncs.PreprocessOpts{
+		Mean:  [3]float32{127.5, 127.5, 127.5},
+		Scale: [3]float32{0.007843, 0.007843, 0.007843},
+	})
+	defer pre.Destroy()
 	log.Printf("Attempting to queue %s for inference", imgPath)
-	err = graph.QueueInferenceWithFifoElem(queue, ncsImg.ToBytes(), nil)
+	err = graph.QueueInferenceWithFifoElemBGR(queue, pre, bgrImage(img), nil)
 	if err != nil {
 		return
 	}
@@ -200,17 +167,14 @@ func main() {
 	}
 	log.Printf("Read %d labels from %s", len(labels), labelsPath)
 
-	// Result is returned as 32bit float, but we are data into 16bit floats hence we
-	// need only half the size of the original 32bit float result data buffer
-	fp16Result, err := gocv.NewMatFromBytes(1, len(tensor.Data)/2, gocv.MatTypeCV16S, tensor.Data)
+	// Result is returned as 16bit floats which are decoded natively
+	detections, e := ncs.DecodeSSD(nil, tensor.Data, ncs.FifoFP16, 0)
 	if e != nil {
 		err = e
 		return
 	}
-
-	result := fp16Result.ConvertFp16()
-	log.Printf("Detected boxes: %d", int(result.GetFloatAt(0, 0)))
-	drawBoxesAndLabels(img, result, labels)
+	log.Printf("Detected boxes: %d", len(detections))
+	drawBoxesAndLabels(img, detections, labels)
 
 	resultPath := filepath.Join("result.png")
 	if !gocv.IMWrite(resultPath, img) {
@@ -1,11 +1,7 @@
 package main
 
 import (
-	"bytes"
-	"encoding/binary"
 	"encoding/json"
-	"image"
-	"io/ioutil"
 	"log"
 	"os"
 	"path/filepath"
@@ -33,20 +29,14 @@ func readLabels(path string) (map[string][]string, error) {
 	return labels, nil
 }
 
-// prepareImg preprocesses image for NCS
-func prepareImg(img gocv.Mat) gocv.Mat {
-	// resize the image
-	resized := gocv.NewMat()
-	defer resized.Close()
-	gocv.Resize(img, &resized, image.Pt(224, 224), 0, 0, gocv.InterpolationDefault)
-
-	fp32Image := gocv.NewMat()
-	resized.ConvertTo(&fp32Image, gocv.MatTypeCV32F)
-
-	fp32Image.DivideFloat(128.0)
-	fp32Image.SubtractFloat(1.0)
-
-	return fp32Image
+// bgrImage wraps gocv image pixels in ncs.BGRImage
+func bgrImage(img gocv.Mat) *ncs.BGRImage {
+	return &ncs.BGRImage{
+		Data:   img.ToBytes(),
+		Width:  img.Cols(),
+		Height: img.Rows(),
+		Stride: img.Cols() * 3,
+	}
 }
 
 func main() {
@@ -83,14 +73,15 @@ func main() {
 	log.Printf("NCS graph handle successfully created")
 
 	graphFileName := "mobilenet_graph"
-	graphData, e := ioutil.ReadFile(graphFileName)
+	graphFile, e := ncs.LoadGraphFile(graphFileName)
 	if e != nil {
 		err = e
 		return
 	}
+	defer graphFile.Close()
 
 	log.Printf("Attempting to allocate NCS graph")
-	queue, e := graph.AllocateWithFifosOpts(dev, graphData,
+	queue, e := graph.AllocateWithFifosOpts(dev, graphFile.Data(),
 		&ncs.FifoOpts{ncs.FifoHostWO, ncs.FifoFP32, 2},
 		&ncs.FifoOpts{ncs.FifoHostRO, ncs.FifoFP32, 2})
 	if e != nil {
@@ -106,9 +97,14 @@ func main() {
 	log.Printf("Attempting to read image %s", imgPath)
 	img := gocv.IMRead(imgPath, gocv.IMReadColor)
 
-	ncsImg := prepareImg(img)
+	// image is resized to graph input size and scaled to [-1, 1] interval when it's queued for inference
+	pre := ncs.NewPreprocessor(&ncs.PreprocessOpts{
+		Mean:  [3]float32{128.0, 128.0, 128.0},
+		Scale: [3]float32{1.0 / 128.0, 1.0 / 128.0, 1.0 / 128.0},
+	})
+	defer pre.Destroy()
 	log.Printf("Attempting to queue %s for inference", imgPath)
-	err = graph.QueueInferenceWithFifoElem(queue, ncsImg.ToBytes(), nil)
+	err = graph.QueueInferenceWithFifoElemBGR(queue, pre, bgrImage(img), nil)
 	if err != nil {
 		return
 	}
@@ -131,24 +127,15 @@ func main() {
 	}
 	log.Printf("Read %d labels from %s", len(labels), labelsPath)
 
-	// Decode the result
-	var result [1000]float32
-	buf := bytes.NewReader(tensor.Data)
-	if e := binary.Read(buf, binary.LittleEndian, &result); e != nil {
+	// select the most probable classes
+	preds, e := ncs.TopK(tensor, ncs.FifoFP32, 5)
+	if e != nil {
 		err = e
 		return
 	}
-
-	// find max and label
-	max := result[0]
-	idx := 0
-	for i, val := range result {
-		if max < val {
-			max = val
-			idx = i
-		}
-	}
-	// need to subtract 1 from idx as Mobilenet indexes from 1, our labels index from 0
+	// need to subtract 1 from class id as Mobilenet indexes from 1, our labels index from 0
 	// https://github.com/mldbai/tensorflow-models/blob/master/inception/inception/data/imagenet_lsvrc_2015_synsets.txt
-	log.Printf("Prediction: %v, Probability: %v", labels[strconv.Itoa(idx-1)], max)
+	for _, p := range preds {
+		log.Printf("Prediction: %v, Probability: %v", labels[strconv.Itoa(int(p.ClassID)-1)], p.Probability)
+	}
 }
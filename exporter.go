@@ -0,0 +1,564 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"net/http"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+	"unsafe"
+)
+
+// DefaultLatencyBuckets are the default upper bounds of exported latency histogram buckets
+var DefaultLatencyBuckets = []time.Duration{
+	250 * time.Microsecond,
+	500 * time.Microsecond,
+	time.Millisecond,
+	2500 * time.Microsecond,
+	5 * time.Millisecond,
+	10 * time.Millisecond,
+	25 * time.Millisecond,
+	50 * time.Millisecond,
+	100 * time.Millisecond,
+	250 * time.Millisecond,
+	500 * time.Millisecond,
+	time.Second,
+	2500 * time.Millisecond,
+}
+
+// callClasses are the names of native shim call classes in NCS_CALL_* order
+var callClasses = [...]string{"write", "queue", "read", "option"}
+
+// ExporterOpts configures Exporter
+type ExporterOpts struct {
+	// Buckets are the upper bounds of latency histogram buckets in increasing order; DefaultLatencyBuckets are used if it's empty
+	Buckets []time.Duration
+	// FillLevelPeriod is the time between FIFO fill level samples; fill levels are not exported if it's 0.
+	// Querying fill levels goes to the device, so they are sampled in the background and scrapes read the last sample.
+	FillLevelPeriod time.Duration
+}
+
+// fillLevels are the last sampled FIFO queue fill levels; they are -1 until they are sampled successfully
+type fillLevels struct {
+	// write is the inbound FIFO write fill level
+	write int64
+	// read is the outbound FIFO read fill level
+	read int64
+}
+
+// exportedGraph is a graph registered with Exporter along with the FIFO queue its inferences are queued to
+type exportedGraph struct {
+	graph *Graph
+	queue *FifoQueue
+	fill  *fillLevels
+}
+
+// exportedDevice is a device registered with Exporter along with the monitor of its health
+type exportedDevice struct {
+	device  *Device
+	monitor *Monitor
+}
+
+// Exporter exports the native instrumentation of the registered graphs, devices and pools in Prometheus text format.
+// It exports inference latency histograms, inferences in flight, shim call counts, tensor pool usage and, for devices registered
+// with a Monitor, their thermal state. Every value is read from lock-free native counters or from the last sample taken in
+// the background, so scraping never contends with the inference hot path and never queries the devices.
+// Exporter implements http.Handler, e.g. http.Handle("/metrics", exporter). Exporter is safe for concurrent use.
+type Exporter struct {
+	bounds []C.ulonglong
+	// les are the bucket bounds formatted as le label values
+	les []string
+	// mu guards the registered resources
+	mu          sync.RWMutex
+	graphs      map[string]*exportedGraph
+	devices     map[string]*exportedDevice
+	tensorPools map[string]*TensorPool
+	devicePools map[string]*DevicePool
+	// poolFills maps pool devices to their fill levels
+	poolFills sync.Map
+	// sampleMu is held while fill levels are sampled, so Remove returns only once the removed queues are no longer sampled
+	sampleMu sync.Mutex
+	done     chan struct{}
+	wg       sync.WaitGroup
+}
+
+// NewExporter creates new Exporter configured by opts and starts sampling FIFO fill levels if opts.FillLevelPeriod is set.
+// It returns error if the options are invalid.
+func NewExporter(opts *ExporterOpts) (*Exporter, error) {
+	buckets := opts.Buckets
+	if len(buckets) == 0 {
+		buckets = DefaultLatencyBuckets
+	}
+
+	if opts.FillLevelPeriod < 0 {
+		return nil, fmt.Errorf("Failed to create exporter: negative fill level period")
+	}
+
+	e := &Exporter{
+		bounds:      make([]C.ulonglong, len(buckets)),
+		les:         make([]string, len(buckets)),
+		graphs:      make(map[string]*exportedGraph),
+		devices:     make(map[string]*exportedDevice),
+		tensorPools: make(map[string]*TensorPool),
+		devicePools: make(map[string]*DevicePool),
+		done:        make(chan struct{}),
+	}
+
+	for i, b := range buckets {
+		if b <= 0 || (i > 0 && b <= buckets[i-1]) {
+			return nil, fmt.Errorf("Failed to create exporter: bucket bounds must be positive and increasing")
+		}
+		e.bounds[i] = C.ulonglong(b)
+		e.les[i] = formatFloat(b.Seconds())
+	}
+
+	if opts.FillLevelPeriod > 0 {
+		e.wg.Add(1)
+		go e.sampleFillLevels(opts.FillLevelPeriod)
+	}
+
+	return e, nil
+}
+
+// AddGraph registers allocated graph g under name along with FIFO queue q its inferences are queued to.
+// The graph must be removed from the exporter before it or its FIFOs are destroyed.
+// It returns error if the name is already registered.
+func (e *Exporter) AddGraph(name string, g *Graph, q *FifoQueue) error {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+
+	if _, ok := e.graphs[name]; ok {
+		return fmt.Errorf("Failed to add graph: %s already registered", name)
+	}
+
+	e.graphs[name] = &exportedGraph{graph: g, queue: q, fill: &fillLevels{write: -1, read: -1}}
+
+	return nil
+}
+
+// AddDevice registers opened device d under name along with monitor m its thermal state is read from.
+// Thermal state is not exported if m is nil. The device must be removed from the exporter before it or m is destroyed.
+// It returns error if the name is already registered.
+func (e *Exporter) AddDevice(name string, d *Device, m *Monitor) error {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+
+	if _, ok := e.devices[name]; ok {
+		return fmt.Errorf("Failed to add device: %s already registered", name)
+	}
+
+	e.devices[name] = &exportedDevice{device: d, monitor: m}
+
+	return nil
+}
+
+// AddTensorPool registers tensor pool p under name.
+// The pool must be removed from the exporter before it is destroyed.
+// It returns error if the name is already registered.
+func (e *Exporter) AddTensorPool(name string, p *TensorPool) error {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+
+	if _, ok := e.tensorPools[name]; ok {
+		return fmt.Errorf("Failed to add tensor pool: %s already registered", name)
+	}
+
+	e.tensorPools[name] = p
+
+	return nil
+}
+
+// AddDevicePool registers device pool p under name. Graphs and devices of the pool are exported as name/index
+// and they keep being exported as the pool recovers them. The pool must be removed from the exporter before it is destroyed.
+// It returns error if the name is already registered.
+func (e *Exporter) AddDevicePool(name string, p *DevicePool) error {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+
+	if _, ok := e.devicePools[name]; ok {
+		return fmt.Errorf("Failed to add device pool: %s already registered", name)
+	}
+
+	e.devicePools[name] = p
+
+	return nil
+}
+
+// Remove removes all the resources registered under name.
+// It waits for the fill level sample being taken, so the removed resources can be destroyed once it returns.
+func (e *Exporter) Remove(name string) {
+	e.mu.Lock()
+	if p, ok := e.devicePools[name]; ok {
+		for _, pd := range p.Devices() {
+			e.poolFills.Delete(pd)
+		}
+	}
+
+	delete(e.graphs, name)
+	delete(e.devices, name)
+	delete(e.tensorPools, name)
+	delete(e.devicePools, name)
+	e.mu.Unlock()
+
+	e.sampleMu.Lock()
+	e.sampleMu.Unlock()
+}
+
+// Destroy stops sampling FIFO fill levels. The registered resources are not destroyed.
+func (e *Exporter) Destroy() {
+	e.mu.Lock()
+	select {
+	case <-e.done:
+	default:
+		close(e.done)
+	}
+	e.mu.Unlock()
+
+	e.wg.Wait()
+}
+
+// sampleFillLevels samples fill levels of the registered FIFO queues every period until the exporter is destroyed
+func (e *Exporter) sampleFillLevels(period time.Duration) {
+	defer e.wg.Done()
+
+	ticker := time.NewTicker(period)
+	defer ticker.Stop()
+
+	for {
+		e.sampleFills()
+
+		select {
+		case <-e.done:
+			return
+		case <-ticker.C:
+		}
+	}
+}
+
+// sampleFills samples fill levels of the registered FIFO queues once.
+// The queues are listed under mu and sampled without it, so the device round trips never hold up scrapes or registrations.
+func (e *Exporter) sampleFills() {
+	e.sampleMu.Lock()
+	defer e.sampleMu.Unlock()
+
+	var graphs []*exportedGraph
+	var poolDevices []*PoolDevice
+	e.mu.RLock()
+	for _, g := range e.graphs {
+		if g.queue != nil {
+			graphs = append(graphs, g)
+		}
+	}
+	for _, p := range e.devicePools {
+		poolDevices = append(poolDevices, p.Devices()...)
+	}
+	e.mu.RUnlock()
+
+	for _, g := range graphs {
+		g.fill.sample(g.queue)
+	}
+
+	for _, pd := range poolDevices {
+		fill, _ := e.poolFills.LoadOrStore(pd, &fillLevels{write: -1, read: -1})
+		pd.sampleFill(fill.(*fillLevels))
+	}
+}
+
+// sample samples fill levels of FIFO queue q
+func (fl *fillLevels) sample(q *FifoQueue) {
+	atomic.StoreInt64(&fl.write, fifoFillLevel(q.In, ROFifoWriteFillLevel))
+	atomic.StoreInt64(&fl.read, fifoFillLevel(q.Out, ROFifoReadFillLevel))
+}
+
+// reset marks the fill levels as not sampled
+func (fl *fillLevels) reset() {
+	atomic.StoreInt64(&fl.write, -1)
+	atomic.StoreInt64(&fl.read, -1)
+}
+
+// fifoFillLevel queries FIFO fill level option opt and returns -1 if the query fails
+func fifoFillLevel(f *Fifo, opt FifoOption) int64 {
+	opts, err := f.GetOptionWithByteSize(opt, fifoOptSize[opt])
+	if err != nil {
+		return -1
+	}
+
+	level, err := opt.Decode(opts, 1)
+	if err != nil {
+		return -1
+	}
+
+	return int64(level.(uint))
+}
+
+// ServeHTTP writes the exported metrics in Prometheus text format
+func (e *Exporter) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	w.Header().Set("Content-Type", "text/plain; version=0.0.4; charset=utf-8")
+
+	if _, err := e.WriteTo(w); err != nil {
+		http.Error(w, err.Error(), http.StatusInternalServerError)
+	}
+}
+
+// WriteTo writes the exported metrics to w in Prometheus text format.
+// It returns the number of bytes written and error if it fails to write them.
+func (e *Exporter) WriteTo(w io.Writer) (int64, error) {
+	x := &exposition{families: make(map[string]*metricFamily)}
+
+	e.collectCalls(x)
+
+	e.mu.RLock()
+	var names []string
+	for name := range e.graphs {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	for _, name := range names {
+		g := e.graphs[name]
+		e.collectGraph(x, name, g.graph, g.queue, g.fill)
+	}
+
+	names = names[:0]
+	for name := range e.devices {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	for _, name := range names {
+		d := e.devices[name]
+		e.collectDevice(x, name, d.device, d.monitor)
+	}
+
+	names = names[:0]
+	for name := range e.devicePools {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	for _, name := range names {
+		e.collectDevicePool(x, name, e.devicePools[name])
+	}
+
+	names = names[:0]
+	for name := range e.tensorPools {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	for _, name := range names {
+		bufs, inUse := e.tensorPools[name].Usage()
+		x.add("ncs_tensor_pool_buffers", "gauge", "Number of buffers allocated by tensor pool.",
+			"", []string{"pool", name}, float64(bufs))
+		x.add("ncs_tensor_pool_buffers_in_use", "gauge", "Number of tensor pool buffers which have not been returned to the pool.",
+			"", []string{"pool", name}, float64(inUse))
+	}
+	e.mu.RUnlock()
+
+	return x.writeTo(w)
+}
+
+// collectCalls collects native shim call counts
+func (e *Exporter) collectCalls(x *exposition) {
+	var counts [len(callClasses)]C.ulonglong
+
+	if Status(C.ncs_StatsCalls(&counts[0], C.uint(len(counts)))) != StatusOK {
+		return
+	}
+
+	for i, call := range callClasses {
+		x.add("ncs_cgo_calls_total", "counter", "Number of native shim calls; batched calls are counted once.",
+			"", []string{"call", call}, float64(counts[i]))
+	}
+}
+
+// collectGraph collects latency histograms of graph g and the load of FIFO queue q its inferences are queued to
+func (e *Exporter) collectGraph(x *exposition, name string, g *Graph, q *FifoQueue, fill *fillLevels) {
+	e.collectLatency(x, "ncs_graph_latency_seconds", "Inference latency of graph by stage.", []string{"graph", name}, g.handle)
+
+	if q == nil {
+		return
+	}
+
+	var inflight C.uint
+	if Status(C.ncs_StatsInflight(q.Out.handle, &inflight)) == StatusOK {
+		x.add("ncs_graph_inferences_in_flight", "gauge", "Number of queued inferences whose results have not been read yet.",
+			"", []string{"graph", name}, float64(inflight))
+	}
+
+	if fill == nil {
+		return
+	}
+
+	if level := atomic.LoadInt64(&fill.write); level >= 0 {
+		x.add("ncs_fifo_write_fill_level", "gauge", "Number of tensors in inbound FIFO write buffer as last sampled.",
+			"", []string{"graph", name}, float64(level))
+	}
+	if level := atomic.LoadInt64(&fill.read); level >= 0 {
+		x.add("ncs_fifo_read_fill_level", "gauge", "Number of tensors in outbound FIFO read buffer as last sampled.",
+			"", []string{"graph", name}, float64(level))
+	}
+}
+
+// collectDevice collects latency histograms of device d and its health last sampled by monitor m unless it's nil
+func (e *Exporter) collectDevice(x *exposition, name string, d *Device, m *Monitor) {
+	e.collectLatency(x, "ncs_device_latency_seconds", "Inference latency of all graphs on device by stage.", []string{"device", name}, d.handle)
+
+	if m == nil {
+		return
+	}
+
+	h, err := m.Health()
+	if err != nil {
+		return
+	}
+
+	l := []string{"device", name}
+	x.add("ncs_device_temperature_celsius", "gauge", "Device temperature in degrees Celsius.", "", l, float64(h.Temperature))
+	x.add("ncs_device_thermal_throttle", "gauge", "Device firmware thermal throttling level.", "", l, float64(h.Throttle))
+	x.add("ncs_device_memory_used_bytes", "gauge", "Device memory in use in bytes.", "", l, float64(h.MemoryUsed))
+	x.add("ncs_device_memory_size_bytes", "gauge", "Total device memory in bytes.", "", l, float64(h.MemorySize))
+	x.add("ncs_device_inference_interval_seconds", "gauge", "Minimum interval between inferences queued on thermally throttled device.",
+		"", l, h.Interval.Seconds())
+	x.add("ncs_device_health_sample_age_seconds", "gauge", "Time since the last successful device health sample.",
+		"", l, time.Since(h.SampledAt).Seconds())
+}
+
+// collectDevicePool collects the state of all the devices of pool p along with their latency histograms and load
+func (e *Exporter) collectDevicePool(x *exposition, name string, p *DevicePool) {
+	for _, pd := range p.Devices() {
+		device := name + "/" + strconv.Itoa(pd.Index)
+		l := []string{"pool", name, "device", strconv.Itoa(pd.Index)}
+
+		healthy := 0.0
+		if pd.Healthy() {
+			healthy = 1
+		}
+		x.add("ncs_pool_device_healthy", "gauge", "Whether pool device takes inferences.", "", l, healthy)
+		x.add("ncs_pool_device_recoveries_total", "counter", "Number of times pool device has been recovered after it failed.",
+			"", l, float64(pd.Recoveries()))
+		x.add("ncs_pool_device_pending", "gauge", "Number of pool device inferences waiting for their results.",
+			"", l, float64(len(pd.pending)))
+
+		var fill *fillLevels
+		if f, ok := e.poolFills.Load(pd); ok {
+			fill = f.(*fillLevels)
+		}
+
+		// the resources are torn down and replaced while the device is recovered
+		pd.state.RLock()
+		if !pd.closed && !pd.failed && pd.Graph != nil {
+			e.collectGraph(x, device, pd.Graph, pd.Queue, fill)
+			e.collectDevice(x, device, pd.Device, nil)
+		}
+		pd.state.RUnlock()
+	}
+}
+
+// collectLatency collects latency histograms of every Stats stage of resource handle
+func (e *Exporter) collectLatency(x *exposition, metric, help string, l []string, handle unsafe.Pointer) {
+	if handle == nil {
+		return
+	}
+
+	hists, err := statsHistograms(handle, e.bounds)
+	if err != nil {
+		return
+	}
+
+	for i, stage := range statsStages {
+		sl := append(append([]string{}, l...), "stage", stage)
+		for j, le := range e.les {
+			x.add(metric, "histogram", help, "_bucket", append(sl, "le", le), float64(hists[i].buckets[j]))
+		}
+		x.add(metric, "histogram", help, "_bucket", append(sl, "le", "+Inf"), float64(hists[i].count))
+		x.add(metric, "histogram", help, "_sum", sl, hists[i].sum.Seconds())
+		x.add(metric, "histogram", help, "_count", sl, float64(hists[i].count))
+	}
+}
+
+// exposition collects metric families in the order they are first added
+type exposition struct {
+	order    []*metricFamily
+	families map[string]*metricFamily
+}
+
+// metricFamily holds samples of a metric in Prometheus text format
+type metricFamily struct {
+	name    string
+	typ     string
+	help    string
+	samples strings.Builder
+}
+
+// add adds sample of metric with name suffix, label pairs l and value v.
+// The metric family is created with its type and help on first use.
+func (x *exposition) add(name, typ, help, suffix string, l []string, v float64) {
+	f, ok := x.families[name]
+	if !ok {
+		f = &metricFamily{name: name, typ: typ, help: help}
+		x.families[name] = f
+		x.order = append(x.order, f)
+	}
+
+	f.samples.WriteString(name)
+	f.samples.WriteString(suffix)
+	if len(l) > 0 {
+		f.samples.WriteByte('{')
+		for i := 0; i+1 < len(l); i += 2 {
+			if i > 0 {
+				f.samples.WriteByte(',')
+			}
+			f.samples.WriteString(l[i])
+			f.samples.WriteString(`="`)
+			f.samples.WriteString(labelEscaper.Replace(l[i+1]))
+			f.samples.WriteByte('"')
+		}
+		f.samples.WriteByte('}')
+	}
+	f.samples.WriteByte(' ')
+	f.samples.WriteString(formatFloat(v))
+	f.samples.WriteByte('\n')
+}
+
+// writeTo writes all the metric families to w
+func (x *exposition) writeTo(w io.Writer) (int64, error) {
+	cw := &countingWriter{w: w}
+	bw := bufio.NewWriter(cw)
+
+	for _, f := range x.order {
+		fmt.Fprintf(bw, "# HELP %s %s\n# TYPE %s %s\n", f.name, f.help, f.name, f.typ)
+		bw.WriteString(f.samples.String())
+	}
+
+	err := bw.Flush()
+
+	return cw.n, err
+}
+
+// countingWriter counts the bytes written to w
+type countingWriter struct {
+	w io.Writer
+	n int64
+}
+
+func (cw *countingWriter) Write(p []byte) (int, error) {
+	n, err := cw.w.Write(p)
+	cw.n += int64(n)
+
+	return n, err
+}
+
+// labelEscaper escapes label values as required by Prometheus text format
+var labelEscaper = strings.NewReplacer(`\`, `\\`, `"`, `\"`, "\n", `\n`)
+
+// formatFloat formats sample value in Prometheus text format
+func formatFloat(v float64) string {
+	return strconv.FormatFloat(v, 'g', -1, 64)
+}
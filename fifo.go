@@ -1,6 +1,6 @@
 package ncs
 
-// #cgo LDFLAGS: -lmvnc
+// #cgo !ncsmock LDFLAGS: -lmvnc
 /*
 #include <ncs.h>
 */
@@ -93,7 +93,7 @@ const (
 	RWFifoConsumerCount
 	// RWFifoDataType configures fifo data type to either of FifoDataType options
 	RWFifoDataType
-	// RWFifoDontBlock configures to return StatusOutOfMemory instead of blocking
+	// RWFifoNoBlock configures FIFO reads and writes to return StatusOutOfMemory instead of blocking
 	RWFifoNoBlock
 	// ROFifoCapacity allows to query number of maximum elements in the buffer
 	ROFifoCapacity
@@ -129,6 +129,19 @@ var fifoOptSize = map[Option]uint{
 	RWFifoHostTensorDesc:  C.sizeof_struct_ncTensorDescriptor_t,
 }
 
+// fifoImmutableOpts are FIFO options which do not change once the FIFO is allocated
+var fifoImmutableOpts = []Option{
+	RWFifoType,
+	RWFifoConsumerCount,
+	RWFifoDataType,
+	RWFifoNoBlock,
+	ROFifoCapacity,
+	ROFifoGraphTensorDesc,
+	ROFifoName,
+	ROFifoElemDataSize,
+	RWFifoHostTensorDesc,
+}
+
 // String implements fmt.Stringer interface
 func (fo FifoOption) String() string {
 	switch fo {
@@ -195,7 +208,8 @@ func (fo FifoOption) Decode(data []byte, count int) (interface{}, error) {
 	case ROFifoName:
 		return string(data), nil
 
-	case RWFifoHostTensorDesc:
+	case ROFifoGraphTensorDesc,
+		RWFifoHostTensorDesc:
 		var val struct {
 			BatchSize uint32
 			Channels  uint32
@@ -229,6 +243,9 @@ func (fo FifoOption) Decode(data []byte, count int) (interface{}, error) {
 	}
 }
 
+// DefaultFifoNumElem is the number of elements FIFOs allocated by AllocateWithFifosDefault can hold
+const DefaultFifoNumElem = 2
+
 // FifoOpts specifies FIFO configuration options
 type FifoOpts struct {
 	// Type is FIFO type
@@ -244,6 +261,33 @@ type Fifo struct {
 	name   string
 	handle unsafe.Pointer
 	device *Device
+	// elemSize is FIFO element data size in bytes cached when the FIFO is allocated
+	elemSize uint
+	// capacity is the number of elements the FIFO holds cached when the FIFO is allocated
+	capacity uint
+	// info is reused by every FIFO element read
+	info *C.ncs_FifoElemInfo
+	// batch is reused by every batched FIFO element read or write
+	batch *C.ncs_FifoBatchInfo
+	// desc is FIFO host tensor descriptor cached when the FIFO is allocated; it's nil if it's not available
+	desc *C.struct_ncTensorDescriptor_t
+	// opts caches FIFO options
+	opts optCache
+	// meta holds metadata of the elements written to the FIFO; it's nil until an element with metadata is written
+	meta *metaTable
+	// unqueued tracks the elements written to the FIFO whose inferences have not been queued yet
+	unqueued unqueuedElems
+}
+
+// newFifo returns new Fifo for the given NCS FIFO handle
+func newFifo(name string, handle unsafe.Pointer, d *Device) *Fifo {
+	return &Fifo{
+		name:   name,
+		handle: handle,
+		device: d,
+		info:   (*C.ncs_FifoElemInfo)(C.malloc(C.sizeof_ncs_FifoElemInfo)),
+		batch:  (*C.ncs_FifoBatchInfo)(C.calloc(1, C.sizeof_ncs_FifoBatchInfo)),
+	}
 }
 
 // NewFifo creates new FIFO queue with given name and returns it
@@ -263,7 +307,7 @@ func NewFifo(name string, t FifoType) (*Fifo, error) {
 		return nil, fmt.Errorf("Failed to create new FIFO: %s", Status(s))
 	}
 
-	return &Fifo{name: name, handle: handle}, nil
+	return newFifo(name, handle, nil), nil
 }
 
 // Allocate allocates memory for a FIFO for the specified device based on the number of elements the FIFO will hold and tensorDesc, which describes the expected shape of the FIFO’s elements
@@ -272,7 +316,111 @@ func NewFifo(name string, t FifoType) (*Fifo, error) {
 // More information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoAllocate.html
 func (f *Fifo) Allocate(d *Device, td *TensorDesc, numElem uint) error {
-	_td := C.struct_ncTensorDescriptor_t{
+	_td := cTensorDesc(td)
+
+	s := C.ncs_FifoAllocate(f.handle, d.handle, &_td, C.uint(numElem))
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to allocate FIFO: %s", Status(s))
+	}
+
+	f.device = d
+
+	return f.cacheOpts()
+}
+
+// cacheOpts caches immutable FIFO options, registers the FIFO for instrumentation and decodes FIFO element data size, capacity and host tensor descriptor so they do not need to be queried on every read or write.
+// Host tensor descriptor is only used by fused preprocessing, so failing to query it does not fail the caching.
+func (f *Fifo) cacheOpts() error {
+	cacheOptions("fifo", f.handle, &f.opts, fifoImmutableOpts, fifoOptSize)
+	C.ncs_StatsRegisterFifo(f.handle)
+
+	opts, err := f.GetOptionWithByteSize(ROFifoElemDataSize, C.sizeof_int)
+	if err != nil {
+		return err
+	}
+
+	elemSize, err := ROFifoElemDataSize.Decode(opts, 1)
+	if err != nil {
+		return err
+	}
+
+	f.elemSize = elemSize.(uint)
+
+	opts, err = f.GetOptionWithByteSize(ROFifoCapacity, fifoOptSize[ROFifoCapacity])
+	if err != nil {
+		return err
+	}
+
+	capacity, err := ROFifoCapacity.Decode(opts, 1)
+	if err != nil {
+		return err
+	}
+
+	f.capacity = capacity.(uint)
+
+	if td, err := f.hostTensorDesc(); err == nil {
+		if f.desc == nil {
+			f.desc = (*C.struct_ncTensorDescriptor_t)(C.malloc(C.sizeof_struct_ncTensorDescriptor_t))
+		}
+		*f.desc = cTensorDesc(td)
+	}
+
+	return nil
+}
+
+// hostTensorDesc returns the descriptor of FIFO host tensors.
+// If the FIFO does not report its host tensor descriptor it's derived from its graph tensor descriptor and element size assuming the default dense channel minor layout.
+func (f *Fifo) hostTensorDesc() (*TensorDesc, error) {
+	size := fifoOptSize[RWFifoHostTensorDesc]
+
+	if opts, err := f.GetOptionWithByteSize(RWFifoHostTensorDesc, size); err == nil {
+		if td, err := RWFifoHostTensorDesc.Decode(opts, 1); err == nil && td.(*TensorDesc).Size == f.elemSize && td.(*TensorDesc).Channels > 0 {
+			return td.(*TensorDesc), nil
+		}
+	}
+
+	opts, err := f.GetOptionWithByteSize(ROFifoGraphTensorDesc, size)
+	if err != nil {
+		return nil, err
+	}
+
+	gtd, err := ROFifoGraphTensorDesc.Decode(opts, 1)
+	if err != nil {
+		return nil, err
+	}
+	td := *gtd.(*TensorDesc)
+
+	vals := td.Channels * td.Width * td.Height
+	if td.BatchSize > 1 {
+		vals *= td.BatchSize
+	}
+
+	if vals == 0 || f.elemSize%vals != 0 {
+		return nil, fmt.Errorf("Element size %d does not match tensor %dx%dx%d", f.elemSize, td.Width, td.Height, td.Channels)
+	}
+
+	valSize := f.elemSize / vals
+	switch valSize {
+	case 2:
+		td.DataType = FifoFP16
+	case 4:
+		td.DataType = FifoFP32
+	default:
+		return nil, fmt.Errorf("Unsupported tensor value size: %d", valSize)
+	}
+
+	td.Size = f.elemSize
+	td.CStride = valSize
+	td.WStride = td.Channels * valSize
+	td.HStride = td.Width * td.WStride
+
+	return &td, nil
+}
+
+// cTensorDesc converts TensorDesc to NCSDK tensor descriptor
+func cTensorDesc(td *TensorDesc) C.struct_ncTensorDescriptor_t {
+	return C.struct_ncTensorDescriptor_t{
 		n:         C.uint(td.BatchSize),
 		c:         C.uint(td.Channels),
 		w:         C.uint(td.Width),
@@ -283,36 +431,42 @@ func (f *Fifo) Allocate(d *Device, td *TensorDesc, numElem uint) error {
 		hStride:   C.uint(td.HStride),
 		dataType:  C.ncFifoDataType(td.DataType),
 	}
+}
 
-	s := C.ncs_FifoAllocate(f.handle, d.handle, &_td, C.uint(numElem))
+// TensorDesc returns FIFO host tensor descriptor as cached when the FIFO was allocated.
+// It returns nil if the FIFO has not been allocated or its tensor descriptor is not available.
+func (f *Fifo) TensorDesc() *TensorDesc {
+	if f.desc == nil {
+		return nil
+	}
 
-	if Status(s) != StatusOK {
-		return fmt.Errorf("Failed to allocate FIFO: %s", Status(s))
+	return &TensorDesc{
+		BatchSize: uint(f.desc.n),
+		Channels:  uint(f.desc.c),
+		Width:     uint(f.desc.w),
+		Height:    uint(f.desc.h),
+		Size:      uint(f.desc.totalSize),
+		CStride:   uint(f.desc.cStride),
+		WStride:   uint(f.desc.wStride),
+		HStride:   uint(f.desc.hStride),
+		DataType:  FifoDataType(f.desc.dataType),
 	}
+}
 
-	return nil
+// ElemSize returns FIFO element data size in bytes.
+// It returns 0 if the FIFO has not been allocated yet.
+func (f *Fifo) ElemSize() uint {
+	return f.elemSize
 }
 
 // GetOptions queries FIFO options and returns it encoded in a byte slice
+// Immutable options are cached when the FIFO is allocated and are returned without querying the device
 // It returns error if it fails to retrieve the options
 //
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoGetOption.html
 func (f *Fifo) GetOption(opt FifoOption) ([]byte, error) {
-	if opt == RWFifoNoBlock {
-		return nil, fmt.Errorf("Option %s not implemented", opt)
-	}
-
-	var data unsafe.Pointer
-	var dataLen C.uint
-
-	s := C.ncs_FifoGetOption(f.handle, C.int(opt), data, &dataLen)
-
-	if Status(s) == StatusInvalidDataLength {
-		return f.GetOptionWithByteSize(opt, fifoOptSize[opt]*uint(dataLen))
-	}
-
-	return nil, fmt.Errorf("Failed to read %s option: %s", opt, Status(s))
+	return queryOption("fifo", f.handle, &f.opts, opt, fifoOptSize[opt])
 }
 
 // GetOptionsWithSize queries NCS fifo options and returns it encoded in a byte slice of size elements.
@@ -322,11 +476,27 @@ func (f *Fifo) GetOption(opt FifoOption) ([]byte, error) {
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoGetOption.html
 func (f *Fifo) GetOptionWithByteSize(opt FifoOption, size uint) ([]byte, error) {
-	if opt == RWFifoNoBlock {
-		return nil, fmt.Errorf("Option %s not implemented", opt)
+	return querySizedOption("fifo", f.handle, &f.opts, opt, size)
+}
+
+// SetNoBlock configures FIFO reads and writes to fail with StatusOutOfMemory instead of blocking when the FIFO is empty or full.
+// It must be called before the FIFO is allocated. It returns error if it fails to set the option.
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoSetOption.html
+func (f *Fifo) SetNoBlock(noBlock bool) error {
+	val := C.int(0)
+	if noBlock {
+		val = 1
 	}
 
-	return getOption("fifo", f.handle, opt, size)
+	s := C.ncs_FifoSetOption(f.handle, C.NC_RW_FIFO_DONT_BLOCK, unsafe.Pointer(&val), C.sizeof_int)
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to set %s option: %s", RWFifoNoBlock, Status(s))
+	}
+
+	return nil
 }
 
 // WriteElem writes an element to a FIFO, usually an input tensor for inference along with some metadata
@@ -335,13 +505,97 @@ func (f *Fifo) GetOptionWithByteSize(opt FifoOption, size uint) ([]byte, error)
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoWriteElem.html
 func (f *Fifo) WriteElem(data []byte, metaData interface{}) error {
+	metaID, err := f.putMeta(metaData)
+	if err != nil {
+		return fmt.Errorf("Failed to write FIFO element: %s", err)
+	}
+
 	dataLen := C.uint(len(data))
 
-	s := C.ncs_FifoWriteElem(f.handle, unsafe.Pointer(&data[0]), &dataLen, unsafe.Pointer(&metaData))
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_FifoWriteElem(f.handle, dataPtr, &dataLen, metaID)
+
+	if Status(s) != StatusOK {
+		takeMetaID(metaID)
+		return fmt.Errorf("Failed to write FIFO element: %s", Status(s))
+	}
+	f.written(metaID, 1)
+
+	return nil
+}
+
+// TryWriteElem writes an element to a FIFO along with some metadata unless the FIFO is full.
+// It returns straight away with false if the FIFO is full, so a single goroutine can feed many FIFOs without blocking on any of them.
+// TryWriteElem must not be called concurrently with other writes to the same FIFO.
+// If it fails to write the element it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoWriteElem.html
+func (f *Fifo) TryWriteElem(data []byte, metaData interface{}) (bool, error) {
+	metaID, err := f.putMeta(metaData)
+	if err != nil {
+		return false, fmt.Errorf("Failed to write FIFO element: %s", err)
+	}
+
+	dataLen := C.uint(len(data))
+
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_FifoTryWriteElem(f.handle, dataPtr, &dataLen, metaID, C.int(f.capacity))
+
+	if Status(s) != StatusOK {
+		takeMetaID(metaID)
+	}
+
+	switch Status(s) {
+	case StatusOK:
+		f.written(metaID, 1)
+		return true, nil
+	case StatusBusy:
+		return false, nil
+	default:
+		return false, fmt.Errorf("Failed to write FIFO element: %s", Status(s))
+	}
+}
+
+// WriteElemFP32 converts FP32 data to FP16 and writes it to a FIFO along with some metadata in a single call.
+// data contains little endian encoded FP32 values. FIFO must have been allocated with FifoFP16 data type.
+// This removes a separate FP16 conversion step and its allocation from the write path.
+// If it fails to write the element it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoWriteElem.html
+func (f *Fifo) WriteElemFP32(data []byte, metaData interface{}) error {
+	if err := f.checkFP32Elem(data); err != nil {
+		return fmt.Errorf("Failed to write FIFO element: %s", err)
+	}
+
+	metaID, err := f.putMeta(metaData)
+	if err != nil {
+		return fmt.Errorf("Failed to write FIFO element: %s", err)
+	}
+
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_FifoWriteElemFp32(f.handle, dataPtr, C.uint(len(data)), metaID)
 
 	if Status(s) != StatusOK {
+		takeMetaID(metaID)
 		return fmt.Errorf("Failed to write FIFO element: %s", Status(s))
 	}
+	f.written(metaID, 1)
+
+	return nil
+}
+
+// checkFP32Elem checks if FP32 data converted to FP16 matches FIFO element size
+func (f *Fifo) checkFP32Elem(data []byte) error {
+	count, err := fp32Count(data)
+	if err != nil {
+		return err
+	}
+
+	if f.elemSize != 0 && uint(count*2) != f.elemSize {
+		return fmt.Errorf("FP16 data size %d does not match element size %d", count*2, f.elemSize)
+	}
 
 	return nil
 }
@@ -352,39 +606,212 @@ func (f *Fifo) WriteElem(data []byte, metaData interface{}) error {
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoReadElem.html
 func (f *Fifo) ReadElem() (*Tensor, error) {
-	opts, err := f.GetOptionWithByteSize(ROFifoElemDataSize, C.sizeof_int)
+	data := make([]byte, f.elemSize)
+
+	n, metaData, err := f.readElemInto(data)
 	if err != nil {
 		return nil, err
 	}
 
-	elemSize, err := ROFifoElemDataSize.Decode(opts, 1)
-	if err != nil {
-		return nil, err
+	return &Tensor{
+		Data:     data[:n],
+		MetaData: metaData,
+	}, nil
+}
+
+// ReadElemInto reads an element from a FIFO into dst and returns the number of bytes read.
+// dst must be at least ElemSize() bytes long. The same dst can be reused across reads so the read path does not allocate.
+// The element metadata is discarded; use ReadElem to receive it.
+// ReadElemInto is not safe for concurrent use on the same FIFO.
+// If it fails to read the element it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoReadElem.html
+func (f *Fifo) ReadElemInto(dst []byte) (int, error) {
+	n, _, err := f.readElemInto(dst)
+
+	return n, err
+}
+
+// readElemInto reads an element from a FIFO into dst and returns the number of bytes read along with the element metadata
+func (f *Fifo) readElemInto(dst []byte) (int, interface{}, error) {
+	if f.elemSize == 0 {
+		return 0, nil, fmt.Errorf("Failed to read FIFO element: %s", StatusNotAllocated)
 	}
 
-	var metaData unsafe.Pointer
-	size := C.uint(elemSize.(uint))
-	data := C.malloc(C.sizeof_char * C.ulong(elemSize.(uint)))
+	if uint(len(dst)) < f.elemSize {
+		return 0, nil, fmt.Errorf("Failed to read FIFO element: buffer size %d smaller than element size %d", len(dst), f.elemSize)
+	}
 
-	s := C.ncs_FifoReadElem(f.handle, data, &size, &metaData)
+	dstPtr := unsafe.Pointer(&dst[0])
+	s := C.ncs_FifoReadElemInto(f.handle, dstPtr, C.uint(f.elemSize), f.info)
 
 	if Status(s) != StatusOK {
-		return nil, fmt.Errorf("Failed to read FIFO element: %s", Status(s))
+		return 0, nil, fmt.Errorf("Failed to read FIFO element: %s", Status(s))
+	}
+
+	return int(f.info.dataLength), takeMeta(f.info.userParam), nil
+}
+
+// TryReadElem reads an element from a FIFO unless the FIFO is empty.
+// It returns straight away with false if the FIFO is empty, so a single goroutine can poll many FIFOs without blocking on any of them.
+// TryReadElem must not be called concurrently with other reads from the same FIFO.
+// If it fails to read the element it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoReadElem.html
+func (f *Fifo) TryReadElem() (*Tensor, bool, error) {
+	data := make([]byte, f.elemSize)
+
+	n, metaData, ok, err := f.tryReadElemInto(data)
+	if !ok || err != nil {
+		return nil, ok, err
 	}
 
 	return &Tensor{
-		Data: C.GoBytes(data, C.int(size)),
-	}, nil
+		Data:     data[:n],
+		MetaData: metaData,
+	}, true, nil
+}
+
+// TryReadElemInto reads an element from a FIFO into dst unless the FIFO is empty and returns the number of bytes read.
+// It returns straight away with false if the FIFO is empty. dst must be at least ElemSize() bytes long and it can be reused across reads.
+// The element metadata is discarded; use TryReadElem to receive it.
+// TryReadElemInto must not be called concurrently with other reads from the same FIFO.
+// If it fails to read the element it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoReadElem.html
+func (f *Fifo) TryReadElemInto(dst []byte) (int, bool, error) {
+	n, _, ok, err := f.tryReadElemInto(dst)
+
+	return n, ok, err
 }
 
-// RemoveElem removes an element from a FIFO
+// tryReadElemInto reads an element from a FIFO into dst unless the FIFO is empty and returns the number of bytes read along with the element metadata
+func (f *Fifo) tryReadElemInto(dst []byte) (int, interface{}, bool, error) {
+	if f.elemSize == 0 {
+		return 0, nil, false, fmt.Errorf("Failed to read FIFO element: %s", StatusNotAllocated)
+	}
+
+	if uint(len(dst)) < f.elemSize {
+		return 0, nil, false, fmt.Errorf("Failed to read FIFO element: buffer size %d smaller than element size %d", len(dst), f.elemSize)
+	}
+
+	dstPtr := unsafe.Pointer(&dst[0])
+	s := C.ncs_FifoTryReadElemInto(f.handle, dstPtr, C.uint(f.elemSize), f.info)
+
+	switch Status(s) {
+	case StatusOK:
+		return int(f.info.dataLength), takeMeta(f.info.userParam), true, nil
+	case StatusBusy:
+		return 0, nil, false, nil
+	default:
+		return 0, nil, false, fmt.Errorf("Failed to read FIFO element: %s", Status(s))
+	}
+}
+
+// WriteElemBatch writes count elements stored back to back in data to a FIFO in a single call and returns the number of written elements.
+// The length of data must be a multiple of count. The elements are written in order and the function stops at the first failed write.
+// WriteElemBatch is not safe for concurrent use with other batched functions on the same FIFO.
+// If it fails to write all the elements it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoWriteElem.html
+func (f *Fifo) WriteElemBatch(data []byte, count int) (int, error) {
+	elemLen, err := batchElemLen(data, count)
+	if err != nil {
+		return 0, fmt.Errorf("Failed to write FIFO elements: %s", err)
+	}
+
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_FifoWriteElemBatch(f.handle, dataPtr, C.uint(elemLen), C.uint(count), f.batch)
+	f.written(0, int(f.batch.count))
+
+	if Status(s) != StatusOK {
+		return int(f.batch.count), fmt.Errorf("Failed to write FIFO element: %s", Status(s))
+	}
+
+	return int(f.batch.count), nil
+}
+
+// ReadElemBatch reads count elements from a FIFO in a single call and stores them back to back in dst, each of them at the offset of a multiple of ElemSize().
+// It returns the number of read elements. dst must be at least count*ElemSize() bytes long and it can be reused across reads so the read path does not allocate.
+// ReadElemBatch blocks until all count elements have been read or reading an element fails.
+// ReadElemBatch is not safe for concurrent use with other batched functions on the same FIFO.
+// If it fails to read all the elements it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoReadElem.html
+func (f *Fifo) ReadElemBatch(dst []byte, count int) (int, error) {
+	if f.elemSize == 0 {
+		return 0, fmt.Errorf("Failed to read FIFO elements: %s", StatusNotAllocated)
+	}
+
+	if count > maxBatchElems {
+		return 0, fmt.Errorf("Failed to read FIFO elements: %d elements exceed %d", count, maxBatchElems)
+	}
+
+	if count <= 0 || uint(len(dst)) < uint(count)*f.elemSize {
+		return 0, fmt.Errorf("Failed to read FIFO elements: buffer size %d can't hold %d elements of size %d", len(dst), count, f.elemSize)
+	}
+
+	dstPtr := unsafe.Pointer(&dst[0])
+	s := C.ncs_FifoReadElemBatch(f.handle, dstPtr, C.uint(f.elemSize), C.uint(count), f.batch)
+
+	// batched reads do not return metadata, so the metadata of the read elements is discarded
+	if n := int(f.batch.count); n > 0 {
+		for _, info := range (*[maxBatchElems]C.ncs_FifoElemInfo)(unsafe.Pointer(f.batch.elems))[:n:n] {
+			takeMeta(info.userParam)
+		}
+	}
+
+	if Status(s) != StatusOK {
+		return int(f.batch.count), fmt.Errorf("Failed to read FIFO element: %s", Status(s))
+	}
+
+	return int(f.batch.count), nil
+}
+
+// maxBatchElems is the maximum number of elements a single batched call writes, queues or reads; it bounds the native element info array addressed from Go
+const maxBatchElems = 1 << 16
+
+// batchElemLen returns the length of a single batch element stored in data holding count elements
+func batchElemLen(data []byte, count int) (int, error) {
+	if count > maxBatchElems {
+		return 0, fmt.Errorf("%d elements exceed %d", count, maxBatchElems)
+	}
+
+	if count <= 0 || len(data) == 0 || len(data)%count != 0 {
+		return 0, fmt.Errorf("data size %d is not a multiple of %d elements", len(data), count)
+	}
+
+	return len(data) / count, nil
+}
+
+// RemoveElem removes the oldest element from a FIFO, so the element is never inferred.
+// Metadata of the removed element is released as long as the elements of the FIFO are written and their inferences queued by Fifo and Graph methods which are not called concurrently with each other.
+// Removing elements is only allowed on FifoHostWO FIFOs and NCSDK releases which don't implement it return StatusUnsupportedFeature.
 // If it fails to remove the element it returns error
-// THIS FUNCTION IS NOT IMPLEMENTED YET
 //
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoRemoveElem.html
 func (f *Fifo) RemoveElem() error {
-	return fmt.Errorf("%s", StatusUnsupportedFeature)
+	if s := f.removeElem(); s != StatusOK {
+		return fmt.Errorf("Failed to remove FIFO element: %s", s)
+	}
+
+	return nil
+}
+
+// removeElem removes the oldest element from a FIFO and returns the status of the removal
+func (f *Fifo) removeElem() Status {
+	s := Status(C.ncs_FifoRemoveElem(f.handle))
+	if s == StatusOK {
+		f.removed()
+	}
+
+	return s
 }
 
 // Destroy destroys NCS FIFO handle and frees associated resources.
@@ -393,7 +820,26 @@ func (f *Fifo) RemoveElem() error {
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoDestroy.html
 func (f *Fifo) Destroy() error {
+	C.ncs_StatsUnregisterFifo(f.handle)
+	f.releaseMeta()
 	s := C.ncs_FifoDestroy(&f.handle)
+	f.opts.reset()
+
+	if f.info != nil {
+		C.free(unsafe.Pointer(f.info))
+		f.info = nil
+	}
+
+	if f.desc != nil {
+		C.free(unsafe.Pointer(f.desc))
+		f.desc = nil
+	}
+
+	if f.batch != nil {
+		C.free(unsafe.Pointer(f.batch.elems))
+		C.free(unsafe.Pointer(f.batch))
+		f.batch = nil
+	}
 
 	if Status(s) != StatusOK {
 		return fmt.Errorf("Failed to destroy FIFO: %s", Status(s))
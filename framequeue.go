@@ -0,0 +1,206 @@
+package ncs
+
+import "fmt"
+
+// LatestFrameQueue queues live frames, e.g. camera frames, for inference so that the latest frame always wins.
+// Frames are written to the inbound FIFO and their inferences are queued only while fewer than depth inferences are in flight.
+// When the device falls behind and the inbound FIFO is full, the oldest frame waiting in it is removed with RemoveElem and dropped,
+// so frames never wait for more than depth inferences and the inbound FIFO capacity and end-to-end latency stays bounded during overload.
+// If NCSDK does not implement RemoveElem the newest frame is held on the host instead and replaced by every frame which arrives before the FIFO has room for it.
+// LatestFrameQueue must be the only user of its graph FIFO queue. LatestFrameQueue is not safe for concurrent use.
+type LatestFrameQueue struct {
+	graph *Graph
+	queue *FifoQueue
+	depth int
+	// removable is cleared once RemoveElem turns out not to be supported
+	removable bool
+	// waiting holds metadata of the frames written to the inbound FIFO whose inferences have not been queued yet
+	waiting []interface{}
+	// inflight holds metadata of the frames whose inferences have been queued
+	inflight []interface{}
+	// held is the newest frame which did not fit into the inbound FIFO; it's only used if RemoveElem is not supported
+	held     []byte
+	heldMeta interface{}
+	holding  bool
+	dropped  uint64
+}
+
+// NewLatestFrameQueue creates new LatestFrameQueue which keeps up to depth inferences in flight on FIFO queue f allocated with graph g.
+// depth must be at least 1 and it must not exceed the capacity of the outbound FIFO.
+// For the lowest latency allocate the inbound FIFO with a single element, so only the latest frame waits for the device.
+// It returns error if the depth is invalid.
+func (g *Graph) NewLatestFrameQueue(f *FifoQueue, depth int) (*LatestFrameQueue, error) {
+	opts, err := f.Out.GetOptionWithByteSize(ROFifoCapacity, fifoOptSize[ROFifoCapacity])
+	if err != nil {
+		return nil, err
+	}
+
+	capacity, err := ROFifoCapacity.Decode(opts, 1)
+	if err != nil {
+		return nil, err
+	}
+
+	if depth < 1 || uint(depth) > capacity.(uint) {
+		return nil, fmt.Errorf("Failed to create latest frame queue: depth %d outside of [1, %d]", depth, capacity.(uint))
+	}
+
+	return &LatestFrameQueue{
+		graph:     g,
+		queue:     f,
+		depth:     depth,
+		removable: true,
+	}, nil
+}
+
+// Queue queues frame data for inference along with some metadata returned with its result. Queue never blocks.
+// If the inbound FIFO is full the oldest frame waiting for the device is dropped to make room for data.
+// The frame is copied if it has to be held on the host, so data can be reused once Queue returns.
+// It returns error if it fails to write the frame or to queue the inference.
+func (q *LatestFrameQueue) Queue(data []byte, metaData interface{}) error {
+	if err := q.pump(); err != nil {
+		return err
+	}
+
+	ok, err := q.write(data, metaData)
+	if err != nil || ok {
+		return err
+	}
+
+	// the inbound FIFO is full, so every frame waiting in it is older than data;
+	// frames whose inferences have been queued are never removed
+	if q.removable && len(q.waiting) > 0 {
+		switch s := q.queue.In.removeElem(); s {
+		case StatusOK:
+			q.waiting[0] = nil
+			q.waiting = q.waiting[1:]
+			q.dropped++
+
+			if ok, err = q.write(data, metaData); err != nil || ok {
+				return err
+			}
+		case StatusUnsupportedFeature:
+			q.removable = false
+		default:
+			return fmt.Errorf("Failed to drop stale frame: %s", s)
+		}
+	}
+
+	if q.holding {
+		q.dropped++
+	}
+	q.held = append(q.held[:0], data...)
+	q.heldMeta = metaData
+	q.holding = true
+
+	return nil
+}
+
+// write writes frame to the inbound FIFO and queues its inference if there is room for it.
+// It returns false if the inbound FIFO is full.
+func (q *LatestFrameQueue) write(data []byte, metaData interface{}) (bool, error) {
+	ok, err := q.queue.In.TryWriteElem(data, nil)
+	if err != nil || !ok {
+		return false, err
+	}
+	q.waiting = append(q.waiting, metaData)
+
+	return true, q.queueWaiting()
+}
+
+// queueWaiting queues inferences of the frames waiting in the inbound FIFO as long as fewer than depth inferences are in flight
+func (q *LatestFrameQueue) queueWaiting() error {
+	for len(q.waiting) > 0 && len(q.inflight) < q.depth {
+		if err := q.graph.QueueInference(q.queue); err != nil {
+			return err
+		}
+
+		q.inflight = append(q.inflight, q.waiting[0])
+		q.waiting[0] = nil
+		q.waiting = q.waiting[1:]
+	}
+
+	return nil
+}
+
+// pump queues inferences of the waiting frames and moves the held frame into the inbound FIFO once it has room for it
+func (q *LatestFrameQueue) pump() error {
+	if err := q.queueWaiting(); err != nil {
+		return err
+	}
+
+	if !q.holding {
+		return nil
+	}
+
+	ok, err := q.write(q.held, q.heldMeta)
+	if ok {
+		q.heldMeta = nil
+		q.holding = false
+	}
+
+	return err
+}
+
+// Next waits for the inference of the oldest queued frame to finish and reads its result into dst.
+// It returns the number of bytes read into dst along with the frame metadata. Call Next until Pending returns 0 to drain the queue.
+// It returns error if there are no frames queued or if it fails to read the result.
+func (q *LatestFrameQueue) Next(dst []byte) (int, interface{}, error) {
+	if err := q.pump(); err != nil {
+		return 0, nil, err
+	}
+
+	if len(q.inflight) == 0 {
+		return 0, nil, fmt.Errorf("Failed to read inference result: no inference in flight")
+	}
+
+	n, err := q.queue.Out.ReadElemInto(dst)
+	if err != nil {
+		return 0, nil, err
+	}
+
+	return n, q.finish(), nil
+}
+
+// TryNext reads result of the oldest queued frame into dst if its inference has finished. TryNext never blocks.
+// It returns the number of bytes read into dst along with the frame metadata and false if no result is available yet.
+// It returns error if it fails to read the result.
+func (q *LatestFrameQueue) TryNext(dst []byte) (int, interface{}, bool, error) {
+	if err := q.pump(); err != nil {
+		return 0, nil, false, err
+	}
+
+	if len(q.inflight) == 0 {
+		return 0, nil, false, nil
+	}
+
+	n, ok, err := q.queue.Out.TryReadElemInto(dst)
+	if err != nil || !ok {
+		return 0, nil, false, err
+	}
+
+	return n, q.finish(), true, nil
+}
+
+// finish releases the oldest inference in flight and returns its frame metadata
+func (q *LatestFrameQueue) finish() interface{} {
+	metaData := q.inflight[0]
+	q.inflight[0] = nil
+	q.inflight = q.inflight[1:]
+
+	return metaData
+}
+
+// Pending returns the number of queued frames whose results have not been read yet
+func (q *LatestFrameQueue) Pending() int {
+	n := len(q.waiting) + len(q.inflight)
+	if q.holding {
+		n++
+	}
+
+	return n
+}
+
+// Dropped returns the number of frames dropped because newer frames arrived before the device had room for them
+func (q *LatestFrameQueue) Dropped() uint64 {
+	return q.dropped
+}
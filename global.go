@@ -1,12 +1,15 @@
 package ncs
 
-// #cgo LDFLAGS: -lmvnc
+// #cgo !ncsmock LDFLAGS: -lmvnc
+// #cgo CXXFLAGS: -std=c++11
+// #cgo ncsmock CPPFLAGS: -I${SRCDIR}/mock
 /*
 #include <ncs.h>
 */
 import "C"
 import (
 	"fmt"
+	"sync"
 	"unsafe"
 )
 
@@ -134,34 +137,173 @@ type TensorDesc struct {
 type Tensor struct {
 	// Data contains raw tensor data
 	Data []byte
-	// MetaData contains tensor metadata
+	// MetaData contains metadata the tensor was written to the FIFO or queued for inference with
 	MetaData interface{}
 }
 
-// getOption is a function which unifies querying of various NCS resource options
-func getOption(resource string, handle unsafe.Pointer, option Option, size uint) ([]byte, error) {
-	// allocate buffer for options data
-	data := C.malloc(C.sizeof_char * C.ulong(size))
-	defer C.free(unsafe.Pointer(data))
-	dataLen := C.uint(size)
-
-	// NCCS API status code
-	var s C.int
-
+// resourceGetOption queries resource option data into dataLen bytes of data buffer
+func resourceGetOption(resource string, handle unsafe.Pointer, option Option, data unsafe.Pointer, dataLen *C.uint) (Status, error) {
 	switch resource {
 	case "device":
-		s = C.ncs_DeviceGetOption(handle, C.int(option.Value()), data, &dataLen)
+		return Status(C.ncs_DeviceGetOption(handle, C.int(option.Value()), data, dataLen)), nil
 	case "graph":
-		s = C.ncs_GraphGetOption(handle, C.int(option.Value()), data, &dataLen)
+		return Status(C.ncs_GraphGetOption(handle, C.int(option.Value()), data, dataLen)), nil
 	case "fifo":
-		s = C.ncs_FifoGetOption(handle, C.int(option.Value()), data, &dataLen)
+		return Status(C.ncs_FifoGetOption(handle, C.int(option.Value()), data, dataLen)), nil
 	default:
-		return nil, fmt.Errorf("Unknown resource: %s", resource)
+		return StatusOK, fmt.Errorf("Unknown resource: %s", resource)
+	}
+}
+
+// getOption is a function which unifies querying of various NCS resource options
+func getOption(resource string, handle unsafe.Pointer, option Option, size uint) ([]byte, error) {
+	if size == 0 {
+		return nil, fmt.Errorf("Failed to get %s option: %s", resource, StatusInvalidDataLength)
+	}
+
+	// option data is read straight into the returned buffer
+	data := make([]byte, size)
+	dataLen := C.uint(size)
+
+	s, err := resourceGetOption(resource, handle, option, unsafe.Pointer(&data[0]), &dataLen)
+	if err != nil {
+		return nil, err
+	}
+
+	if s != StatusOK {
+		return nil, fmt.Errorf("Failed to get %s option: %s", resource, s)
+	}
+
+	return data, nil
+}
+
+// queryOption queries resource option data.
+// Cached option data is returned without querying NCS. Option data size is queried only once and cached afterwards, so repeated queries take a single round-trip.
+func queryOption(resource string, handle unsafe.Pointer, cache *optCache, opt Option, elemSize uint) ([]byte, error) {
+	if data, ok := cache.load(opt); ok {
+		return data, nil
+	}
+
+	size, err := optionSize(resource, handle, cache, opt, elemSize)
+	if err != nil {
+		return nil, err
+	}
+
+	return getOption(resource, handle, opt, size)
+}
+
+// querySizedOption queries resource option data of given size in bytes.
+// Cached option data is returned without querying NCS if it's at least as big as the requested size.
+func querySizedOption(resource string, handle unsafe.Pointer, cache *optCache, opt Option, size uint) ([]byte, error) {
+	if data, ok := cache.load(opt); ok && uint(len(data)) >= size {
+		return data[:size], nil
+	}
+
+	return getOption(resource, handle, opt, size)
+}
+
+// cacheOptions queries data of immutable resource options and caches it.
+// Options which fail to be queried are not cached and are queried from NCS on every request.
+func cacheOptions(resource string, handle unsafe.Pointer, cache *optCache, opts []Option, sizes map[Option]uint) {
+	cache.reset()
+
+	for _, opt := range opts {
+		data, err := queryOption(resource, handle, cache, opt, sizes[opt])
+		if err != nil {
+			continue
+		}
+		cache.store(opt, data)
+	}
+}
+
+// optionSize returns resource option data size in bytes.
+// The size is queried from NCS when it's not cached yet.
+func optionSize(resource string, handle unsafe.Pointer, cache *optCache, opt Option, elemSize uint) (uint, error) {
+	if size, ok := cache.loadSize(opt); ok {
+		return size, nil
+	}
+
+	var dataLen C.uint
+
+	s, err := resourceGetOption(resource, handle, opt, nil, &dataLen)
+	if err != nil {
+		return 0, err
+	}
+
+	if s != StatusInvalidDataLength {
+		return 0, fmt.Errorf("Failed to read %s option: %s", opt, s)
 	}
 
-	if Status(s) != StatusOK {
-		return nil, fmt.Errorf("Failed to get %s option: %s", resource, Status(s))
+	size := elemSize * uint(dataLen)
+	cache.storeSize(opt, size)
+
+	return size, nil
+}
+
+// optCache caches NCS resource options.
+// Data of immutable options is cached once the resource is allocated; data sizes are cached for all options once they are first queried.
+// Zero value optCache is empty and ready to use.
+type optCache struct {
+	mu   sync.RWMutex
+	data map[Option][]byte
+	size map[Option]uint
+}
+
+// load returns a copy of cached option data
+func (c *optCache) load(opt Option) ([]byte, bool) {
+	c.mu.RLock()
+	defer c.mu.RUnlock()
+
+	data, ok := c.data[opt]
+	if !ok {
+		return nil, false
 	}
 
-	return C.GoBytes(unsafe.Pointer(data), C.int(size)), nil
+	return append([]byte(nil), data...), true
+}
+
+// loadSize returns cached option data size
+func (c *optCache) loadSize(opt Option) (uint, bool) {
+	c.mu.RLock()
+	defer c.mu.RUnlock()
+
+	size, ok := c.size[opt]
+
+	return size, ok
+}
+
+// store caches option data
+func (c *optCache) store(opt Option, data []byte) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	if c.data == nil {
+		c.data = make(map[Option][]byte)
+	}
+	c.data[opt] = data
+
+	if c.size == nil {
+		c.size = make(map[Option]uint)
+	}
+	c.size[opt] = uint(len(data))
+}
+
+// storeSize caches option data size
+func (c *optCache) storeSize(opt Option, size uint) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	if c.size == nil {
+		c.size = make(map[Option]uint)
+	}
+	c.size[opt] = size
+}
+
+// reset drops all cached options
+func (c *optCache) reset() {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	c.data = nil
+	c.size = nil
 }
@@ -1,6 +1,6 @@
 package ncs
 
-// #cgo LDFLAGS: -lmvnc
+// #cgo !ncsmock LDFLAGS: -lmvnc
 /*
 #include <ncs.h>
 */
@@ -90,6 +90,18 @@ var graphOptSize = map[Option]uint{
 	ROGraphInferenceTimeSize: C.sizeof_int,
 }
 
+// graphImmutableOpts are graph options which do not change once the graph is allocated
+var graphImmutableOpts = []Option{
+	ROGraphInputCount,
+	ROGraphOutputCount,
+	ROGraphInputTensorDesc,
+	ROGraphOutputTensorDesc,
+	ROGraphName,
+	ROGraphOptionClassLimit,
+	ROGraphVersion,
+	ROGraphInferenceTimeSize,
+}
+
 // String implements fmt.Stringer interface for GraphOption
 func (g GraphOption) String() string {
 	switch g {
@@ -220,6 +232,7 @@ type Graph struct {
 	name   string
 	handle unsafe.Pointer
 	device *Device
+	opts   optCache
 }
 
 // NewGraph creates new Graph with given name and returns it
@@ -254,17 +267,24 @@ func (g *Graph) Allocate(d *Device, graphData []byte) error {
 		return fmt.Errorf("Failed to allocate new graph: %s", Status(s))
 	}
 
-	g.device = d
+	g.allocated(d)
 
 	return nil
 }
 
-// AllocateWithFifosDefault allocates a graph and creates and allocates FIFO queues with default parameters for inference. Both FIFOs have FifoDataType set to FifoFP32. Inbound FIFO queue is initialized with FifoHostWO type and outbound FIFO queue with FifoHostRO type. It returns FifoQueue or error if it fails to allocate the graph.
+// allocated records the device the graph has been allocated on, caches its immutable options and registers it for instrumentation
+func (g *Graph) allocated(d *Device) {
+	g.device = d
+	cacheOptions("graph", g.handle, &g.opts, graphImmutableOpts, graphOptSize)
+	C.ncs_StatsRegister(g.handle, d.handle)
+}
+
+// AllocateWithFifosDefault allocates a graph and creates and allocates FIFO queues with default parameters for inference. Both FIFOs have FifoDataType set to FifoFP32. Inbound FIFO queue is initialized with FifoHostWO type and outbound FIFO queue with FifoHostRO type. Both FIFOs can hold DefaultFifoNumElem elements. It returns FifoQueue or error if it fails to allocate the graph.
 //
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphAllocateWithFifos.html
 func (g *Graph) AllocateWithFifosDefault(d *Device, graphData []byte) (*FifoQueue, error) {
-	return g.AllocateWithFifosOpts(d, graphData, &FifoOpts{FifoHostWO, FifoFP32, 2}, &FifoOpts{FifoHostRO, FifoFP32, 2})
+	return g.AllocateWithFifosOpts(d, graphData, &FifoOpts{FifoHostWO, FifoFP32, DefaultFifoNumElem}, &FifoOpts{FifoHostRO, FifoFP32, DefaultFifoNumElem})
 }
 
 // AllocateWithFifosOpts allocates a graph and creates and allocates FIFO queues for inference. This function is similar to AllocateWithFifosDefault, but rather than initializing FIFOs with default values it accepts parameters that allow to specify FIFO queue parameters
@@ -283,12 +303,35 @@ func (g *Graph) AllocateWithFifosOpts(d *Device, graphData []byte, inOpts *FifoO
 		return nil, fmt.Errorf("Failed to allocate graph with FIFOs: %s", Status(s))
 	}
 
-	g.device = d
+	g.allocated(d)
+
+	queue, err := newFifoQueue(d, inHandle, outHandle)
+	if err != nil {
+		queue.In.Destroy()
+		queue.Out.Destroy()
+		return nil, err
+	}
 
-	return &FifoQueue{
-		In:  &Fifo{handle: inHandle, device: d},
-		Out: &Fifo{handle: outHandle, device: d},
-	}, nil
+	return queue, nil
+}
+
+// newFifoQueue wraps FIFOs allocated along with a graph on device d into FifoQueue.
+// The queue is returned even if caching FIFO options fails so the FIFOs can be destroyed.
+func newFifoQueue(d *Device, inHandle, outHandle unsafe.Pointer) (*FifoQueue, error) {
+	queue := &FifoQueue{
+		In:  newFifo("", inHandle, d),
+		Out: newFifo("", outHandle, d),
+	}
+
+	if err := queue.In.cacheOpts(); err != nil {
+		return queue, err
+	}
+
+	if err := queue.Out.cacheOpts(); err != nil {
+		return queue, err
+	}
+
+	return queue, nil
 }
 
 // QueueInference queues data for inference to be processed by a graph with specified input and output FIFOs
@@ -302,6 +345,7 @@ func (g *Graph) QueueInference(f *FifoQueue) error {
 	if Status(s) != StatusOK {
 		return fmt.Errorf("Failed to queue inference: %s", Status(s))
 	}
+	f.In.queued(1)
 
 	return nil
 }
@@ -311,18 +355,92 @@ func (g *Graph) QueueInference(f *FifoQueue) error {
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphQueueInferenceWithFifoElem.html
 func (g *Graph) QueueInferenceWithFifoElem(f *FifoQueue, data []byte, metaData interface{}) error {
+	_, err := g.queueInferenceWithFifoElem(f, data, metaData)
+
+	return err
+}
+
+// queueInferenceWithFifoElem writes an element to the inbound FIFO and queues an inference in one call.
+// It returns the status of the native call along with the error, so callers can tell device failures apart; the status is StatusOK if data never reached NCSDK.
+func (g *Graph) queueInferenceWithFifoElem(f *FifoQueue, data []byte, metaData interface{}) (Status, error) {
+	metaID, err := f.In.putMeta(metaData)
+	if err != nil {
+		return StatusOK, fmt.Errorf("Failed to queue inference: %s", err)
+	}
+
 	dataLen := C.uint(len(data))
 
-	s := C.ncs_GraphQueueInferenceWithFifoElem(g.handle, f.In.handle, f.Out.handle, unsafe.Pointer(&data[0]), &dataLen, unsafe.Pointer(&metaData))
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_GraphQueueInferenceWithFifoElem(g.handle, f.In.handle, f.Out.handle, dataPtr, &dataLen, metaID)
 
 	if Status(s) != StatusOK {
+		takeMetaID(metaID)
+		return Status(s), fmt.Errorf("Failed to queue inference: %s", Status(s))
+	}
+	f.In.writtenQueued(metaID, 1)
+
+	return StatusOK, nil
+}
+
+// QueueInferenceWithFifoElemFP32 converts FP32 data to FP16, writes it to the inbound FIFO and queues an inference in a single call.
+// data contains little endian encoded FP32 values. The inbound FIFO must have been allocated with FifoFP16 data type.
+// This removes a separate FP16 conversion step and its allocation from the inference path.
+// If it fails to queue the data tensor it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphQueueInferenceWithFifoElem.html
+func (g *Graph) QueueInferenceWithFifoElemFP32(f *FifoQueue, data []byte, metaData interface{}) error {
+	if err := f.In.checkFP32Elem(data); err != nil {
+		return fmt.Errorf("Failed to queue inference: %s", err)
+	}
+
+	metaID, err := f.In.putMeta(metaData)
+	if err != nil {
+		return fmt.Errorf("Failed to queue inference: %s", err)
+	}
+
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_GraphQueueInferenceWithFifoElemFp32(g.handle, f.In.handle, f.Out.handle,
+		dataPtr, C.uint(len(data)), metaID)
+
+	if Status(s) != StatusOK {
+		takeMetaID(metaID)
 		return fmt.Errorf("Failed to queue inference: %s", Status(s))
 	}
+	f.In.writtenQueued(metaID, 1)
 
 	return nil
 }
 
+// QueueInferenceBatch writes count input tensors stored back to back in data to the inbound FIFO and queues an inference for each of them in a single call.
+// It returns the number of queued inferences. The length of data must be a multiple of count.
+// The inferences are queued in order and the function stops at the first one which fails to be queued.
+// Unless the outbound FIFO is drained concurrently, count should not exceed its capacity, otherwise the call may block forever.
+// QueueInferenceBatch is not safe for concurrent use with other batched functions on the same inbound FIFO.
+// If it fails to queue all the tensors it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphQueueInferenceWithFifoElem.html
+func (g *Graph) QueueInferenceBatch(f *FifoQueue, data []byte, count int) (int, error) {
+	elemLen, err := batchElemLen(data, count)
+	if err != nil {
+		return 0, fmt.Errorf("Failed to queue inference: %s", err)
+	}
+
+	dataPtr := unsafe.Pointer(&data[0])
+	s := C.ncs_GraphQueueInferenceBatch(g.handle, f.In.handle, f.Out.handle,
+		dataPtr, C.uint(elemLen), C.uint(count), f.In.batch)
+	f.In.writtenQueued(0, int(f.In.batch.count))
+
+	if Status(s) != StatusOK {
+		return int(f.In.batch.count), fmt.Errorf("Failed to queue inference: %s", Status(s))
+	}
+
+	return int(f.In.batch.count), nil
+}
+
 // GetOption queries the value of an option for a graph and returns it encoded in a byte slice
+// Immutable options are cached when the graph is allocated and are returned without querying the device
 // It returns error if it failed to retrieve the option value
 //
 // For more information:
@@ -332,16 +450,7 @@ func (g *Graph) GetOption(opt GraphOption) ([]byte, error) {
 		return nil, fmt.Errorf("Option %s not implemented", opt)
 	}
 
-	var data unsafe.Pointer
-	var dataLen C.uint
-
-	s := C.ncs_GraphGetOption(g.handle, C.int(opt), data, &dataLen)
-
-	if Status(s) == StatusInvalidDataLength {
-		return g.GetOptionWithByteSize(opt, graphOptSize[opt]*uint(dataLen))
-	}
-
-	return nil, fmt.Errorf("Failed to read %s option: %s", opt, Status(s))
+	return queryOption("graph", g.handle, &g.opts, opt, graphOptSize[opt])
 }
 
 // GetOptionsWithSize queries NCS grapg options and returns it encoded in a byte slice of size elements.
@@ -355,7 +464,25 @@ func (g *Graph) GetOptionWithByteSize(opt GraphOption, size uint) ([]byte, error
 		return nil, fmt.Errorf("Option %s not implemented", opt)
 	}
 
-	return getOption("graph", g.handle, opt, size)
+	return querySizedOption("graph", g.handle, &g.opts, opt, size)
+}
+
+// SetExecutorsCount sets the number of executors (NCEs) the graph runs its inferences on.
+// Running inferences on more executors lets more of them be in flight at the same time.
+// It must be called before the graph is allocated. It returns error if it fails to set the option.
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphSetOption.html
+func (g *Graph) SetExecutorsCount(count uint) error {
+	val := C.int(count)
+
+	s := C.ncs_GraphSetOption(g.handle, C.NC_RW_GRAPH_EXECUTORS_NUM, unsafe.Pointer(&val), C.sizeof_int)
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to set %s option: %s", RWGraphExecutorsCount, Status(s))
+	}
+
+	return nil
 }
 
 // Destroy destroys NCS graph handle and frees associated resources.
@@ -364,7 +491,9 @@ func (g *Graph) GetOptionWithByteSize(opt GraphOption, size uint) ([]byte, error
 // For more information:
 // https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphDestroy.html
 func (g *Graph) Destroy() error {
+	C.ncs_StatsUnregister(g.handle)
 	s := C.ncs_GraphDestroy(&g.handle)
+	g.opts.reset()
 
 	if Status(s) != StatusOK {
 		return fmt.Errorf("Failed to destroy graph: %s", Status(s))
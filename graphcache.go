@@ -0,0 +1,254 @@
+package ncs
+
+import (
+	"container/list"
+	"fmt"
+	"sync"
+)
+
+// CachedGraph is a graph resident on a device along with its FIFO queue
+type CachedGraph struct {
+	// Name is the name the graph is cached under
+	Name string
+	// Graph is the allocated graph
+	Graph *Graph
+	// Queue is FIFO queue allocated along with the graph
+	Queue *FifoQueue
+	// refs is the number of Get calls not yet paired with Release
+	refs  int
+	cache *GraphCache
+}
+
+// Release releases the graph acquired by GraphCache.Get so it can be evicted
+func (cg *CachedGraph) Release() {
+	cg.cache.mu.Lock()
+	defer cg.cache.mu.Unlock()
+
+	if cg.refs > 0 {
+		cg.refs--
+	}
+}
+
+// destroy destroys the graph FIFOs and the graph
+func (cg *CachedGraph) destroy() error {
+	cg.Queue.In.Destroy()
+	cg.Queue.Out.Destroy()
+
+	return cg.Graph.Destroy()
+}
+
+// graphLoad is a graph being uploaded to the device by one of the Get calls requesting it
+type graphLoad struct {
+	// size is the size of the graph being uploaded
+	size uint
+	// done is closed once the upload finishes
+	done chan struct{}
+	err  error
+}
+
+// GraphCache keeps graphs along with their FIFOs resident on a device, so switching between models does not upload their graphs again.
+// It holds at most as many graphs as the device can hold and when the device runs out of graph slots or memory the least recently used graphs which are not in use are evicted.
+// GraphCache is safe for concurrent use.
+type GraphCache struct {
+	device  *Device
+	inOpts  *FifoOpts
+	outOpts *FifoOpts
+	mu      sync.Mutex
+	// graphs maps graph names to their elements in lru
+	graphs map[string]*list.Element
+	// lru lists cached graphs from the most to the least recently used
+	lru *list.List
+	// loading maps names of graphs which are being uploaded to their uploads
+	loading map[string]*graphLoad
+	// loadingSize is the total size of graphs which are being uploaded
+	loadingSize uint
+}
+
+// NewGraphCache creates new GraphCache for the opened device d.
+// Graphs are allocated with FIFOs configured by inOpts and outOpts.
+func NewGraphCache(d *Device, inOpts, outOpts *FifoOpts) *GraphCache {
+	return &GraphCache{
+		device:  d,
+		inOpts:  inOpts,
+		outOpts: outOpts,
+		graphs:  make(map[string]*list.Element),
+		lru:     list.New(),
+		loading: make(map[string]*graphLoad),
+	}
+}
+
+// Get returns graph cached under name and marks it as the most recently used one.
+// If the graph is not cached graphData is allocated on the device, evicting as many least recently used graphs as needed to make room for it.
+// The graph is uploaded without holding the cache lock, so Get calls requesting other graphs are not blocked by the upload; concurrent Get calls requesting the same graph wait for it to be uploaded once.
+// The returned graph is not evicted until it's released, so every Get call must be paired with CachedGraph.Release once the graph is no longer used.
+// It returns error if the graph fails to be allocated or if there is no room for it because all the cached graphs are in use.
+func (c *GraphCache) Get(name string, graphData []byte) (*CachedGraph, error) {
+	c.mu.Lock()
+
+	for {
+		if elem, ok := c.graphs[name]; ok {
+			c.lru.MoveToFront(elem)
+			cg := elem.Value.(*CachedGraph)
+			cg.refs++
+			c.mu.Unlock()
+			return cg, nil
+		}
+
+		load, ok := c.loading[name]
+		if !ok {
+			break
+		}
+
+		c.mu.Unlock()
+		<-load.done
+		if load.err != nil {
+			return nil, load.err
+		}
+		c.mu.Lock()
+	}
+
+	if len(graphData) == 0 {
+		c.mu.Unlock()
+		return nil, fmt.Errorf("Failed to cache graph %s: empty graph", name)
+	}
+
+	size := uint(len(graphData))
+	if err := c.makeRoom(size); err != nil {
+		c.mu.Unlock()
+		return nil, fmt.Errorf("Failed to cache graph %s: %s", name, err)
+	}
+
+	// the device resources are reserved for the graph until its upload finishes
+	load := &graphLoad{size: size, done: make(chan struct{})}
+	c.loading[name] = load
+	c.loadingSize += size
+	c.mu.Unlock()
+
+	cg, err := c.load(name, graphData)
+
+	c.mu.Lock()
+	delete(c.loading, name)
+	c.loadingSize -= size
+	if err == nil {
+		c.graphs[name] = c.lru.PushFront(cg)
+	}
+	load.err = err
+	close(load.done)
+	c.mu.Unlock()
+
+	return cg, err
+}
+
+// load allocates graphData on the device along with the graph FIFOs
+func (c *GraphCache) load(name string, graphData []byte) (*CachedGraph, error) {
+	graph, err := NewGraph(name)
+	if err != nil {
+		return nil, err
+	}
+
+	queue, err := graph.AllocateWithFifosOpts(c.device, graphData, c.inOpts, c.outOpts)
+	if err != nil {
+		graph.Destroy()
+		return nil, err
+	}
+
+	return &CachedGraph{
+		Name:  name,
+		Graph: graph,
+		Queue: queue,
+		refs:  1,
+		cache: c,
+	}, nil
+}
+
+// makeRoom evicts least recently used graphs until the device has a free graph slot and size bytes of free memory left over by the graphs being uploaded.
+// It must be called with the cache lock held.
+func (c *GraphCache) makeRoom(size uint) error {
+	for {
+		maxGraphs, err := c.device.uintOption(RODeviceMaxGraphCount)
+		if err != nil {
+			return err
+		}
+
+		graphs, err := c.device.uintOption(RODeviceAllocatedGraphCount)
+		if err != nil {
+			return err
+		}
+
+		memSize, err := c.device.uintOption(RODeviceMemorySize)
+		if err != nil {
+			return err
+		}
+
+		memUsed, err := c.device.uintOption(RODeviceMemoryUsed)
+		if err != nil {
+			return err
+		}
+
+		graphs += uint(len(c.loading))
+		memUsed += c.loadingSize
+		if graphs < maxGraphs && memUsed+size <= memSize {
+			return nil
+		}
+
+		if !c.evict() {
+			return fmt.Errorf("%s: all %d cached graphs are in use", StatusOutOfMemory, c.lru.Len()+len(c.loading))
+		}
+	}
+}
+
+// evict destroys the least recently used graph which is not in use.
+// It returns false if there is no graph to evict.
+func (c *GraphCache) evict() bool {
+	for elem := c.lru.Back(); elem != nil; elem = elem.Prev() {
+		cg := elem.Value.(*CachedGraph)
+		if cg.refs > 0 {
+			continue
+		}
+
+		c.lru.Remove(elem)
+		delete(c.graphs, cg.Name)
+		cg.destroy()
+
+		return true
+	}
+
+	return false
+}
+
+// Len returns the number of cached graphs
+func (c *GraphCache) Len() int {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	return c.lru.Len()
+}
+
+// Destroy destroys all cached graphs along with their FIFOs, including those which are still in use.
+// Graphs which are being uploaded are destroyed once their upload finishes.
+// It returns the first error encountered while destroying the graphs.
+func (c *GraphCache) Destroy() error {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	for len(c.loading) > 0 {
+		for _, load := range c.loading {
+			c.mu.Unlock()
+			<-load.done
+			c.mu.Lock()
+			break
+		}
+	}
+
+	var err error
+	for elem := c.lru.Front(); elem != nil; elem = elem.Next() {
+		if e := elem.Value.(*CachedGraph).destroy(); e != nil && err == nil {
+			err = e
+		}
+	}
+
+	c.graphs = make(map[string]*list.Element)
+	c.lru.Init()
+
+	return err
+}
@@ -0,0 +1,124 @@
+package ncs
+
+import (
+	"fmt"
+	"math"
+	"os"
+	"path/filepath"
+	"sync"
+	"syscall"
+)
+
+// GraphFile is compiled graph file memory mapped read-only into the process address space.
+// Its data can be passed to Graph allocation functions on any number of devices without copying the graph to heap.
+// All GraphFiles loaded from the same unmodified file share a single mapping.
+type GraphFile struct {
+	path string
+	info os.FileInfo
+	data []byte
+	// refs is the number of LoadGraphFile calls not yet paired with Close
+	refs int
+}
+
+// graphFiles maps absolute graph file paths to their mappings
+var graphFiles = struct {
+	sync.Mutex
+	m map[string]*GraphFile
+}{m: make(map[string]*GraphFile)}
+
+// LoadGraphFile memory maps compiled graph file stored in path and returns it.
+// If the file is already mapped and has not changed since, its existing mapping is returned.
+// Every LoadGraphFile call must be paired with exactly one Close call once the graph has been allocated.
+// It returns error if the file can't be opened or mapped.
+func LoadGraphFile(path string) (*GraphFile, error) {
+	absPath, err := filepath.Abs(path)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to load graph file %s: %s", path, err)
+	}
+
+	f, err := os.Open(absPath)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to load graph file %s: %s", path, err)
+	}
+	defer f.Close()
+
+	info, err := f.Stat()
+	if err != nil {
+		return nil, fmt.Errorf("Failed to load graph file %s: %s", path, err)
+	}
+
+	graphFiles.Lock()
+	defer graphFiles.Unlock()
+
+	if gf, ok := graphFiles.m[absPath]; ok && sameFile(gf.info, info) {
+		gf.refs++
+		return gf, nil
+	}
+
+	if info.Size() == 0 || info.Size() > math.MaxUint32 {
+		return nil, fmt.Errorf("Failed to load graph file %s: invalid size %d", path, info.Size())
+	}
+
+	data, err := syscall.Mmap(int(f.Fd()), 0, int(info.Size()), syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to map graph file %s: %s", path, err)
+	}
+	// the whole graph is sent to device when it's allocated, so the pages are prefetched; failing to do so is harmless
+	syscall.Madvise(data, syscall.MADV_WILLNEED)
+
+	gf := &GraphFile{
+		path: absPath,
+		info: info,
+		data: data,
+		refs: 1,
+	}
+	graphFiles.m[absPath] = gf
+
+	return gf, nil
+}
+
+// sameFile returns true if a and b describe the same file with the same contents as far as its metadata can tell
+func sameFile(a, b os.FileInfo) bool {
+	return os.SameFile(a, b) && a.Size() == b.Size() && a.ModTime().Equal(b.ModTime())
+}
+
+// Path returns absolute path of the graph file
+func (gf *GraphFile) Path() string {
+	return gf.path
+}
+
+// Data returns memory mapped graph file data which can be passed to Graph allocation functions.
+// The returned slice is read-only and it is only valid until the graph file is closed.
+func (gf *GraphFile) Data() []byte {
+	return gf.data
+}
+
+// Close releases the graph file. The file is unmapped when all of its loads have been closed.
+// Graphs allocated from the file data keep working after it's closed as the data is copied to devices during allocation.
+// It returns error if the file fails to be unmapped.
+func (gf *GraphFile) Close() error {
+	graphFiles.Lock()
+	defer graphFiles.Unlock()
+
+	if gf.refs == 0 {
+		return nil
+	}
+
+	gf.refs--
+	if gf.refs > 0 {
+		return nil
+	}
+
+	if graphFiles.m[gf.path] == gf {
+		delete(graphFiles.m, gf.path)
+	}
+
+	data := gf.data
+	gf.data = nil
+
+	if err := syscall.Munmap(data); err != nil {
+		return fmt.Errorf("Failed to unmap graph file %s: %s", gf.path, err)
+	}
+
+	return nil
+}
@@ -0,0 +1,224 @@
+//go:build linux
+// +build linux
+
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <stdlib.h>
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"sync"
+	"unsafe"
+)
+
+// DefaultIngestBuffers is the default number of capture buffers mapped by Ingest
+const DefaultIngestBuffers = 4
+
+// PixelFormat is V4L2 pixel format frames are captured in
+type PixelFormat uint32
+
+const (
+	// PixelYUYV is packed YUV 4:2:2 format most USB cameras capture uncompressed frames in
+	PixelYUYV PixelFormat = 'Y' | 'U'<<8 | 'Y'<<16 | 'V'<<24
+	// PixelBGR24 is packed 8 bit BGR format
+	PixelBGR24 PixelFormat = 'B' | 'G'<<8 | 'R'<<16 | '3'<<24
+)
+
+// String method to satisfy fmt.Stringer interface
+func (pf PixelFormat) String() string {
+	switch pf {
+	case PixelYUYV:
+		return "PIXEL_YUYV"
+	case PixelBGR24:
+		return "PIXEL_BGR24"
+	default:
+		return "PIXEL_UNKNOWN_FORMAT"
+	}
+}
+
+// IngestOpts configures Ingest
+type IngestOpts struct {
+	// Device is the path of V4L2 capture device, e.g. /dev/video0
+	Device string
+	// Width and Height are the requested capture size; the driver captures frames of the closest size it supports
+	Width  int
+	Height int
+	// Format is the pixel format frames are captured in
+	Format PixelFormat
+	// Buffers is the number of capture buffers; DefaultIngestBuffers buffers are mapped if it's 0
+	Buffers int
+	// Preprocess configures preprocessing of frames into the graph input; pixel values are used as they are if it's nil
+	Preprocess *PreprocessOpts
+}
+
+// IngestTarget is a graph along with the FIFO queue Ingest queues inferences of captured frames on
+type IngestTarget struct {
+	// Graph is the allocated graph
+	Graph *Graph
+	// Queue is FIFO queue allocated along with the graph
+	Queue *FifoQueue
+}
+
+// IngestFrame is the metadata of inference results of the frames captured by Ingest
+type IngestFrame struct {
+	// Source is the capture device the frame was captured by
+	Source string
+	// Seq is the sequence number of the captured frame modulo 2^16
+	Seq uint32
+}
+
+// IngestStats are statistics of frames captured by Ingest
+type IngestStats struct {
+	// Frames is the number of captured frames
+	Frames uint64
+	// Queued is the number of frames whose inferences have been queued
+	Queued uint64
+	// Dropped is the number of frames dropped because newer frames were captured or all the inbound FIFOs were full
+	Dropped uint64
+	// Err is the error which stopped the capture; it's nil while frames are captured
+	Err error
+}
+
+// Ingest captures frames from V4L2 device into mmap'd buffers on a native thread, preprocesses them straight into the graph input
+// and queues their inferences on the target whose inbound FIFO holds the fewest elements, so the frames never touch Go heap.
+// When the devices fall behind only the newest captured frame is queued and frames are dropped while all the inbound FIFOs are full.
+// Inference results are read from the target outbound FIFOs and their MetaData holds IngestFrame of the frame they were inferred from,
+// so several cameras can feed the same targets, e.g. the devices brought up by OpenAll.
+// Targets must not be written to by anything else until the ingest is destroyed. Ingest is safe for concurrent use.
+type Ingest struct {
+	handle unsafe.Pointer
+	// tag is the metadata ID frames are tagged with
+	tag uint32
+	// Width and Height are the capture size negotiated with the device
+	Width  int
+	Height int
+	// mu guards handle
+	mu sync.RWMutex
+}
+
+// NewIngest opens V4L2 capture device configured by opts and starts queueing inferences of the captured frames on targets.
+// Target inbound FIFOs must hold 3 channel tensors.
+// It returns error if the options or targets are invalid or if it fails to start capturing frames.
+func NewIngest(opts *IngestOpts, targets []IngestTarget) (*Ingest, error) {
+	if len(targets) == 0 {
+		return nil, fmt.Errorf("Failed to create ingest: no targets")
+	}
+
+	if opts.Width <= 0 || opts.Height <= 0 || opts.Buffers < 0 {
+		return nil, fmt.Errorf("Failed to create ingest: invalid capture size %dx%d or buffers %d", opts.Width, opts.Height, opts.Buffers)
+	}
+
+	cTargets := make([]C.ncs_IngestTarget, len(targets))
+	for i, t := range targets {
+		if t.Queue.In.desc == nil || t.Queue.In.desc.c != 3 {
+			return nil, fmt.Errorf("Failed to create ingest: target %d inbound FIFO does not hold 3 channel tensors", i)
+		}
+
+		cTargets[i] = C.ncs_IngestTarget{
+			graphHandle:   t.Graph.handle,
+			inFifoHandle:  t.Queue.In.handle,
+			outFifoHandle: t.Queue.Out.handle,
+			inDesc:        *t.Queue.In.desc,
+		}
+	}
+
+	buffers := opts.Buffers
+	if buffers == 0 {
+		buffers = DefaultIngestBuffers
+	}
+
+	preprocess := opts.Preprocess
+	if preprocess == nil {
+		preprocess = &PreprocessOpts{Scale: [3]float32{1, 1, 1}}
+	}
+
+	p := NewPreprocessor(preprocess)
+	defer p.Destroy()
+
+	source := opts.Device
+	tag, err := newTagTable(func(slot uint32) interface{} {
+		return IngestFrame{Source: source, Seq: slot}
+	})
+	if err != nil {
+		return nil, fmt.Errorf("Failed to create ingest: %s", err)
+	}
+
+	device := C.CString(opts.Device)
+	defer C.free(unsafe.Pointer(device))
+
+	cOpts := C.ncs_IngestOpts{
+		device:      device,
+		width:       C.uint(opts.Width),
+		height:      C.uint(opts.Height),
+		pixelFormat: C.uint(opts.Format),
+		buffers:     C.uint(buffers),
+		preprocess:  *p.opts,
+		tag:         C.uint(tag),
+		seqMask:     C.uint(maxMetaSlots),
+	}
+
+	var handle unsafe.Pointer
+
+	s := C.ncs_IngestStart(&cOpts, &cTargets[0], C.uint(len(cTargets)), &handle)
+
+	if Status(s) != StatusOK {
+		releaseTagTable(tag)
+		return nil, fmt.Errorf("Failed to create ingest: %s", Status(s))
+	}
+
+	return &Ingest{
+		handle: handle,
+		tag:    tag,
+		Width:  int(cOpts.width),
+		Height: int(cOpts.height),
+	}, nil
+}
+
+// Stats returns statistics of the captured frames.
+// It returns error if the ingest has been destroyed.
+func (in *Ingest) Stats() (*IngestStats, error) {
+	in.mu.RLock()
+	defer in.mu.RUnlock()
+
+	if in.handle == nil {
+		return nil, fmt.Errorf("Failed to read ingest stats: %s", StatusInvalidHandle)
+	}
+
+	var s C.ncs_IngestStats
+	C.ncs_IngestSnapshot(in.handle, &s)
+
+	stats := &IngestStats{
+		Frames:  uint64(s.frames),
+		Queued:  uint64(s.queued),
+		Dropped: uint64(s.dropped),
+	}
+
+	if Status(s.status) != StatusOK {
+		stats.Err = fmt.Errorf("Failed to ingest frame: %s", Status(s.status))
+	}
+
+	return stats, nil
+}
+
+// Destroy stops capturing frames and releases the capture device.
+// It waits for the inference of the frame being queued, so the target outbound FIFOs must keep being read until Destroy returns.
+// Results of the frames read after Destroy returns carry no metadata: the metadata table index of the frames is retired with a new generation,
+// so their metadata IDs never match a table registered later. Ingest must be destroyed before its targets are destroyed.
+func (in *Ingest) Destroy() error {
+	in.mu.Lock()
+	defer in.mu.Unlock()
+
+	s := C.ncs_IngestStop(&in.handle)
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to destroy ingest: %s", Status(s))
+	}
+
+	releaseTagTable(in.tag)
+
+	return nil
+}
@@ -0,0 +1,293 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"unsafe"
+)
+
+// Metadata IDs consist of the index of the metadata table, the generation of the slot and the slot holding the metadata, from the most significant bits.
+// Generations are bumped every time a slot or a table index is reused, so IDs of elements whose metadata has been released never match the metadata stored after them.
+const (
+	// metaSlotBits is the number of metadata ID bits which address a slot of a metadata table
+	metaSlotBits = 16
+	// maxMetaSlots is the maximum number of elements with metadata a single FIFO can hold
+	maxMetaSlots = 1<<metaSlotBits - 1
+	// metaGenBits is the number of metadata ID bits which hold the slot generation
+	metaGenBits = 6
+	metaGenMask = 1<<metaGenBits - 1
+	// metaIndexShift is the offset of the table index in metadata ID
+	metaIndexShift = metaSlotBits + metaGenBits
+	// maxMetaTables is the maximum number of FIFOs which can hold elements with metadata at the same time
+	maxMetaTables = 1<<(32-metaIndexShift) - 1
+)
+
+// metaTable holds metadata of the elements written to a FIFO until the elements are read back.
+// Elements carry metadata IDs as their user parameters, so no Go pointers are handed over to NCSDK.
+type metaTable struct {
+	// index is the index of the table in metaTables
+	index uint32
+	// gen is the generation of the table index; slots of natively tagged tables carry it
+	gen uint32
+	// slots holds the metadata; its slot 0 is never used so metadata ID 0 means no metadata.
+	// A slot is occupied while it holds metadata, as nil metadata is never stored.
+	slots []interface{}
+	// gens holds the slot generations
+	gens []uint32
+	// free holds the unused slots
+	free []uint32
+	// decode returns metadata of the elements tagged natively with their slot; it's nil if the table holds metadata stored by putMeta
+	decode func(slot uint32) interface{}
+}
+
+var (
+	// metaMu guards metaTables and all the metadata tables
+	metaMu sync.Mutex
+	// metaTables maps table indices to metadata tables, index 0 is never used
+	metaTables = []*metaTable{nil}
+	// metaGens holds the generations of table indices
+	metaGens = []uint32{0}
+	// metaFree holds the released table indices in the order they were released.
+	// Released indices are quarantined: they are reused, oldest first, only once no fresh index is left,
+	// so elements still carrying IDs of a released table are unlikely to decode into the table registered after it.
+	metaFree []uint32
+)
+
+// metaID returns metadata ID of slot with generation gen of table index
+func metaID(index, gen, slot uint32) uint32 {
+	return index<<metaIndexShift | gen<<metaSlotBits | slot
+}
+
+// splitMetaID splits metadata ID into its table index, slot generation and slot
+func splitMetaID(id uint32) (uint32, uint32, uint32) {
+	return id >> metaIndexShift, id >> metaSlotBits & metaGenMask, id & maxMetaSlots
+}
+
+// putMeta stores metaData in the metadata table of the FIFO the element is written to and returns its metadata ID.
+// Nil metadata is not stored and its metadata ID is 0. Stored metadata must be released with takeMetaID unless the write succeeds.
+func (f *Fifo) putMeta(metaData interface{}) (C.uint, error) {
+	if metaData == nil {
+		return 0, nil
+	}
+
+	metaMu.Lock()
+	defer metaMu.Unlock()
+
+	t := f.meta
+	if t == nil {
+		var err error
+		if t, err = newMetaTable(nil); err != nil {
+			return 0, err
+		}
+		f.meta = t
+	}
+
+	var slot uint32
+	if n := len(t.free); n > 0 {
+		slot = t.free[n-1]
+		t.free = t.free[:n-1]
+		t.gens[slot] = (t.gens[slot] + 1) & metaGenMask
+	} else {
+		if len(t.slots) > maxMetaSlots {
+			return 0, fmt.Errorf("%d FIFO elements hold metadata", maxMetaSlots)
+		}
+		slot = uint32(len(t.slots))
+		t.slots = append(t.slots, nil)
+		t.gens = append(t.gens, t.gen)
+	}
+	t.slots[slot] = metaData
+
+	return C.uint(metaID(t.index, t.gens[slot], slot)), nil
+}
+
+// newMetaTable registers new metadata table which decodes natively tagged metadata with decode unless it's nil.
+// It must be called with metaMu held.
+func newMetaTable(decode func(slot uint32) interface{}) (*metaTable, error) {
+	var index uint32
+	switch {
+	case len(metaTables) <= maxMetaTables:
+		index = uint32(len(metaTables))
+		metaTables = append(metaTables, nil)
+		metaGens = append(metaGens, 0)
+	case len(metaFree) > 0:
+		index = metaFree[0]
+		metaFree = metaFree[1:]
+	default:
+		return nil, fmt.Errorf("%d FIFOs hold metadata", maxMetaTables)
+	}
+
+	t := &metaTable{index: index, gen: metaGens[index], slots: []interface{}{nil}, gens: []uint32{0}, decode: decode}
+	metaTables[index] = t
+
+	return t, nil
+}
+
+// newTagTable registers metadata table for elements tagged natively and returns the metadata ID its slot 0 is tagged with.
+// Metadata of an element tagged with slot is decoded by decode when the element is read.
+func newTagTable(decode func(slot uint32) interface{}) (uint32, error) {
+	metaMu.Lock()
+	defer metaMu.Unlock()
+
+	t, err := newMetaTable(decode)
+	if err != nil {
+		return 0, err
+	}
+
+	return metaID(t.index, t.gen, 0), nil
+}
+
+// releaseTagTable drops the metadata table registered by newTagTable with metadata ID tag of its slot 0
+func releaseTagTable(tag uint32) {
+	metaMu.Lock()
+	defer metaMu.Unlock()
+
+	releaseMetaTable(tag >> metaIndexShift)
+}
+
+// releaseMetaTable drops the metadata table registered under index and quarantines the index.
+// It must be called with metaMu held.
+func releaseMetaTable(index uint32) {
+	metaTables[index] = nil
+	metaGens[index] = (metaGens[index] + 1) & metaGenMask
+	metaFree = append(metaFree, index)
+}
+
+// takeMeta removes the metadata stored under element user parameter userParam and returns it.
+// It returns nil if no metadata is stored under userParam, including when the metadata has already been taken
+// and its slot or table may have been reused since, so taking the same user parameter twice never releases the slot twice.
+func takeMeta(userParam unsafe.Pointer) interface{} {
+	if userParam == nil {
+		return nil
+	}
+
+	// the ID is converted in Go, since cgo rejects user parameters which happen to look like pointers into Go memory
+	return takeMetaID(C.uint(uintptr(userParam)))
+}
+
+// takeMetaID removes the metadata stored under metadata ID id and returns it like takeMeta does
+func takeMetaID(id C.uint) interface{} {
+	if id == 0 {
+		return nil
+	}
+
+	index, gen, slot := splitMetaID(uint32(id))
+
+	metaMu.Lock()
+	defer metaMu.Unlock()
+
+	if index >= uint32(len(metaTables)) || metaTables[index] == nil {
+		return nil
+	}
+
+	t := metaTables[index]
+	if t.decode != nil {
+		if gen != t.gen {
+			return nil
+		}
+		return t.decode(slot)
+	}
+
+	if slot == 0 || slot >= uint32(len(t.slots)) || t.gens[slot] != gen || t.slots[slot] == nil {
+		return nil
+	}
+
+	metaData := t.slots[slot]
+	t.slots[slot] = nil
+	t.free = append(t.free, slot)
+
+	return metaData
+}
+
+// releaseMeta drops the FIFO metadata table along with the metadata of all the elements which have not been read back
+func (f *Fifo) releaseMeta() {
+	metaMu.Lock()
+	defer metaMu.Unlock()
+
+	if f.meta == nil {
+		return
+	}
+
+	releaseMetaTable(f.meta.index)
+	f.meta = nil
+}
+
+// unqueuedElems tracks metadata IDs of the elements written to an inbound FIFO whose inferences have not been queued yet, oldest first,
+// so the metadata of the element removed by RemoveElem can be released. Only the elements written and queued through Fifo and Graph methods are tracked.
+type unqueuedElems struct {
+	mu  sync.Mutex
+	ids []C.uint
+	// n is the number of tracked elements; it's read atomically so queueing does not lock while no element is waiting
+	n int32
+}
+
+// written records count elements with metadata ID metaID written to a FIFO
+func (f *Fifo) written(metaID C.uint, count int) {
+	u := &f.unqueued
+	u.mu.Lock()
+	defer u.mu.Unlock()
+
+	for i := 0; i < count; i++ {
+		u.ids = append(u.ids, metaID)
+	}
+	atomic.StoreInt32(&u.n, int32(len(u.ids)))
+}
+
+// queued records count inferences queued on a FIFO; every inference consumes the oldest element in the FIFO
+func (f *Fifo) queued(count int) {
+	u := &f.unqueued
+	if atomic.LoadInt32(&u.n) == 0 {
+		return
+	}
+
+	u.mu.Lock()
+	defer u.mu.Unlock()
+
+	u.pop(count)
+}
+
+// writtenQueued records count elements with metadata ID metaID written to a FIFO and queued for inference in a single call.
+// The inferences consume the oldest elements, so the written elements are only tracked if older elements are waiting in the FIFO.
+func (f *Fifo) writtenQueued(metaID C.uint, count int) {
+	if atomic.LoadInt32(&f.unqueued.n) == 0 {
+		return
+	}
+
+	f.written(metaID, count)
+	f.queued(count)
+}
+
+// removed releases the metadata of the oldest element waiting in a FIFO once the element has been removed
+func (f *Fifo) removed() {
+	u := &f.unqueued
+	if atomic.LoadInt32(&u.n) == 0 {
+		return
+	}
+
+	u.mu.Lock()
+	if len(u.ids) == 0 {
+		u.mu.Unlock()
+		return
+	}
+	metaID := u.ids[0]
+	u.pop(1)
+	u.mu.Unlock()
+
+	takeMetaID(metaID)
+}
+
+// pop drops up to count oldest tracked elements; it must be called with mu held
+func (u *unqueuedElems) pop(count int) {
+	if count >= len(u.ids) {
+		u.ids = u.ids[:0]
+	} else {
+		copy(u.ids, u.ids[count:])
+		u.ids = u.ids[:len(u.ids)-count]
+	}
+	atomic.StoreInt32(&u.n, int32(len(u.ids)))
+}
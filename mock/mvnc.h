@@ -0,0 +1,202 @@
+// mvnc.h mirrors the NCSDK API V2 C header for the simulated NCS backend built with the ncsmock build tag.
+// The API is implemented by mvnc_mock.cpp; see its documentation for how the simulated devices are configured.
+#ifndef __NC_H_INCLUDED__
+#define __NC_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NC_MAX_NAME_SIZE 28
+#define NC_THERMAL_BUFFER_SIZE 100
+#define NC_DEBUG_BUFFER_SIZE 120
+#define NC_VERSION_MAX_SIZE 4
+
+typedef enum {
+        NC_OK = 0,
+        NC_BUSY = -1,
+        NC_ERROR = -2,
+        NC_OUT_OF_MEMORY = -3,
+        NC_DEVICE_NOT_FOUND = -4,
+        NC_INVALID_PARAMETERS = -5,
+        NC_TIMEOUT = -6,
+        NC_MVCMD_NOT_FOUND = -7,
+        NC_NOT_ALLOCATED = -8,
+        NC_UNAUTHORIZED = -9,
+        NC_UNSUPPORTED_GRAPH_FILE = -10,
+        NC_UNSUPPORTED_CONFIGURATION_FILE = -11,
+        NC_UNSUPPORTED_FEATURE = -12,
+        NC_MYRIAD_ERROR = -13,
+        NC_INVALID_DATA_LENGTH = -14,
+        NC_INVALID_HANDLE = -15
+} ncStatus_t;
+
+typedef enum {
+        NC_LOG_DEBUG = 0,
+        NC_LOG_INFO,
+        NC_LOG_WARN,
+        NC_LOG_ERROR,
+        NC_LOG_FATAL
+} ncLogLevel_t;
+
+typedef enum {
+        NC_RW_LOG_LEVEL = 0,
+        NC_RO_API_VERSION = 1
+} ncGlobalOption_t;
+
+typedef enum {
+        NC_RO_GRAPH_STATE = 1000,
+        NC_RO_GRAPH_TIME_TAKEN = 1001,
+        NC_RO_GRAPH_INPUT_COUNT = 1002,
+        NC_RO_GRAPH_OUTPUT_COUNT = 1003,
+        NC_RO_GRAPH_INPUT_TENSOR_DESCRIPTORS = 1004,
+        NC_RO_GRAPH_OUTPUT_TENSOR_DESCRIPTORS = 1005,
+        NC_RO_GRAPH_DEBUG_INFO = 1006,
+        NC_RO_GRAPH_NAME = 1007,
+        NC_RO_GRAPH_OPTION_CLASS_LIMIT = 1008,
+        NC_RO_GRAPH_VERSION = 1009,
+        NC_RO_GRAPH_TIME_TAKEN_ARRAY_SIZE = 1011,
+        NC_RW_GRAPH_EXECUTORS_NUM = 1110
+} ncGraphOption_t;
+
+typedef enum {
+        NC_DEVICE_CREATED = 0,
+        NC_DEVICE_OPENED = 1,
+        NC_DEVICE_CLOSED = 2
+} ncDeviceState_t;
+
+typedef enum {
+        NC_GRAPH_CREATED = 0,
+        NC_GRAPH_ALLOCATED = 1,
+        NC_GRAPH_WAITING_FOR_BUFFERS = 2,
+        NC_GRAPH_RUNNING = 3
+} ncGraphState_t;
+
+typedef enum {
+        NC_FIFO_CREATED = 0,
+        NC_FIFO_ALLOCATED = 1
+} ncFifoState_t;
+
+typedef enum {
+        NC_MA2450 = 0,
+        NC_MA2480 = 1
+} ncDeviceHwVersion_t;
+
+typedef enum {
+        NC_RO_DEVICE_THERMAL_STATS = 2000,
+        NC_RO_DEVICE_THERMAL_THROTTLING_LEVEL = 2001,
+        NC_RO_DEVICE_STATE = 2002,
+        NC_RO_DEVICE_CURRENT_MEMORY_USED = 2003,
+        NC_RO_DEVICE_MEMORY_SIZE = 2004,
+        NC_RO_DEVICE_MAX_FIFO_NUM = 2005,
+        NC_RO_DEVICE_ALLOCATED_FIFO_NUM = 2006,
+        NC_RO_DEVICE_MAX_GRAPH_NUM = 2007,
+        NC_RO_DEVICE_ALLOCATED_GRAPH_NUM = 2008,
+        NC_RO_DEVICE_OPTION_CLASS_LIMIT = 2009,
+        NC_RO_DEVICE_FW_VERSION = 2010,
+        NC_RO_DEVICE_DEBUG_INFO = 2011,
+        NC_RO_DEVICE_MVTENSOR_VERSION = 2012,
+        NC_RO_DEVICE_NAME = 2013,
+        NC_RO_DEVICE_MAX_EXECUTORS_NUM = 2014,
+        NC_RO_DEVICE_HW_VERSION = 2015
+} ncDeviceOption_t;
+
+typedef enum {
+        NC_FIFO_HOST_RO = 0,
+        NC_FIFO_HOST_WO = 1
+} ncFifoType_t;
+
+typedef enum {
+        NC_FIFO_FP16 = 0,
+        NC_FIFO_FP32 = 1
+} ncFifoDataType_t;
+
+typedef enum {
+        NC_RW_FIFO_TYPE = 0,
+        NC_RW_FIFO_CONSUMER_COUNT = 1,
+        NC_RW_FIFO_DATA_TYPE = 2,
+        NC_RW_FIFO_DONT_BLOCK = 3,
+        NC_RO_FIFO_CAPACITY = 4,
+        NC_RO_FIFO_READ_FILL_LEVEL = 5,
+        NC_RO_FIFO_WRITE_FILL_LEVEL = 6,
+        NC_RO_FIFO_GRAPH_TENSOR_DESCRIPTOR = 7,
+        NC_RO_FIFO_STATE = 8,
+        NC_RO_FIFO_NAME = 9,
+        NC_RO_FIFO_ELEMENT_DATA_SIZE = 10,
+        NC_RW_FIFO_HOST_TENSOR_DESCRIPTOR = 11
+} ncFifoOption_t;
+
+struct ncTensorDescriptor_t {
+        unsigned int n;
+        unsigned int c;
+        unsigned int w;
+        unsigned int h;
+        unsigned int totalSize;
+        unsigned int cStride;
+        unsigned int wStride;
+        unsigned int hStride;
+        ncFifoDataType_t dataType;
+};
+
+struct ncDeviceHandle_t {
+        void* private_data;
+};
+
+struct ncGraphHandle_t {
+        void* private_data;
+};
+
+struct ncFifoHandle_t {
+        void* private_data;
+};
+
+// Global
+ncStatus_t ncGlobalSetOption(int option, const void *data, unsigned int dataLength);
+ncStatus_t ncGlobalGetOption(int option, void *data, unsigned int *dataLength);
+
+// Device
+ncStatus_t ncDeviceSetOption(struct ncDeviceHandle_t *deviceHandle, int option, const void *data, unsigned int dataLength);
+ncStatus_t ncDeviceGetOption(struct ncDeviceHandle_t *deviceHandle, int option, void *data, unsigned int *dataLength);
+ncStatus_t ncDeviceCreate(int index, struct ncDeviceHandle_t **deviceHandle);
+ncStatus_t ncDeviceOpen(struct ncDeviceHandle_t *deviceHandle);
+ncStatus_t ncDeviceClose(struct ncDeviceHandle_t *deviceHandle);
+ncStatus_t ncDeviceDestroy(struct ncDeviceHandle_t **deviceHandle);
+
+// Graph
+ncStatus_t ncGraphCreate(const char* name, struct ncGraphHandle_t **graphHandle);
+ncStatus_t ncGraphAllocate(struct ncDeviceHandle_t *deviceHandle, struct ncGraphHandle_t *graphHandle,
+                const void *graphBuffer, unsigned int graphBufferLength);
+ncStatus_t ncGraphDestroy(struct ncGraphHandle_t **graphHandle);
+ncStatus_t ncGraphSetOption(struct ncGraphHandle_t *graphHandle, int option, const void *data, unsigned int dataLength);
+ncStatus_t ncGraphGetOption(struct ncGraphHandle_t *graphHandle, int option, void *data, unsigned int *dataLength);
+ncStatus_t ncGraphQueueInference(struct ncGraphHandle_t *graphHandle,
+                struct ncFifoHandle_t** fifoIn, unsigned int inFifoCount,
+                struct ncFifoHandle_t** fifoOut, unsigned int outFifoCount);
+ncStatus_t ncGraphQueueInferenceWithFifoElem(struct ncGraphHandle_t *graphHandle,
+                struct ncFifoHandle_t* fifoIn, struct ncFifoHandle_t* fifoOut, const void *inputTensor,
+                unsigned int * inputTensorLength, void *userParam);
+ncStatus_t ncGraphAllocateWithFifos(struct ncDeviceHandle_t* deviceHandle, struct ncGraphHandle_t* graphHandle,
+                const void *graphBuffer, unsigned int graphBufferLength,
+                struct ncFifoHandle_t ** inFifoHandle, struct ncFifoHandle_t ** outFifoHandle);
+ncStatus_t ncGraphAllocateWithFifosEx(struct ncDeviceHandle_t* deviceHandle, struct ncGraphHandle_t* graphHandle,
+                const void *graphBuffer, unsigned int graphBufferLength,
+                struct ncFifoHandle_t ** inFifoHandle, ncFifoType_t inFifoType, int inNumElem, ncFifoDataType_t inDataType,
+                struct ncFifoHandle_t ** outFifoHandle, ncFifoType_t outFifoType, int outNumElem, ncFifoDataType_t outDataType);
+
+// Fifo
+ncStatus_t ncFifoCreate(const char *name, ncFifoType_t type, struct ncFifoHandle_t **fifoHandle);
+ncStatus_t ncFifoAllocate(struct ncFifoHandle_t* fifoHandle, struct ncDeviceHandle_t* device,
+                struct ncTensorDescriptor_t* tensorDesc, unsigned int numElem);
+ncStatus_t ncFifoSetOption(struct ncFifoHandle_t* fifoHandle, int option, const void *data, unsigned int dataLength);
+ncStatus_t ncFifoGetOption(struct ncFifoHandle_t* fifoHandle, int option, void *data, unsigned int *dataLength);
+ncStatus_t ncFifoDestroy(struct ncFifoHandle_t** fifoHandle);
+ncStatus_t ncFifoWriteElem(struct ncFifoHandle_t* fifoHandle, const void *inputTensor,
+                unsigned int * inputTensorLength, void *userParam);
+ncStatus_t ncFifoReadElem(struct ncFifoHandle_t* fifoHandle, void *outputData, unsigned int* outputDataLen, void **userParam);
+ncStatus_t ncFifoRemoveElem(struct ncFifoHandle_t* fifoHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
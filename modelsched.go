@@ -0,0 +1,297 @@
+package ncs
+
+import (
+	"fmt"
+	"sync"
+)
+
+// ModelOpts configures a model co-scheduled on a device by ModelScheduler
+type ModelOpts struct {
+	// Name is the name inference requests for the model are scheduled under
+	Name string
+	// GraphData is compiled graph of the model
+	GraphData []byte
+	// Executors is the number of executors the graph runs its inferences on; NCSDK default is used if it's 0
+	Executors uint
+	// InOpts configures inbound FIFO of the graph; FifoHostWO FIFO of DefaultFifoNumElem FifoFP32 elements is allocated if nil
+	InOpts *FifoOpts
+	// OutOpts configures outbound FIFO of the graph; FifoHostRO FIFO of DefaultFifoNumElem FifoFP32 elements is allocated if nil
+	OutOpts *FifoOpts
+}
+
+// schedModel is a model resident on ModelScheduler device
+type schedModel struct {
+	name string
+	// pd serves the model graph; its Device is nil as the device is shared by all the models
+	pd *PoolDevice
+	// limit is the number of inferences the model can have in flight without blocking on its inbound FIFO
+	limit int
+	// reqs contains requests waiting to be queued on the device; it's guarded by ModelScheduler mu
+	reqs []*schedRequest
+	// inflight is the number of requests queued on the device; it's guarded by ModelScheduler mu
+	inflight int
+}
+
+// ModelScheduler multiplexes inference requests for several graphs resident on a single device.
+// Every graph has its own FIFOs and its requests are queued on the device round-robin with the requests of the other graphs.
+// Each graph is kept at most as many inferences in flight as its executors and inbound FIFO can take, so queueing never blocks and the device keeps working on the other graphs while any one of them waits for input.
+// ModelScheduler is safe for concurrent use.
+type ModelScheduler struct {
+	models map[string]*schedModel
+	order  []*schedModel
+	mu     sync.Mutex
+	// next is the index of the model in order which is served first in the next round
+	next int
+	// stopped is set once no more requests are accepted
+	stopped bool
+	wake    chan struct{}
+	done    chan struct{}
+	wg      sync.WaitGroup
+}
+
+// NewModelScheduler allocates graphs of all the models along with their FIFOs on the opened device d and starts scheduling their inferences.
+// The device is not owned by the scheduler and must stay open until the scheduler is destroyed.
+// It returns error if model names are not unique, if the device does not have enough free FIFOs for all the models or if any graph fails to be allocated.
+func NewModelScheduler(d *Device, models []ModelOpts) (*ModelScheduler, error) {
+	if len(models) == 0 {
+		return nil, fmt.Errorf("Failed to create model scheduler: no models")
+	}
+
+	maxFifos, err := d.uintOption(RODeviceMaxFifoCount)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to create model scheduler: %s", err)
+	}
+
+	fifos, err := d.uintOption(RODeviceAllocatedFifoCount)
+	if err != nil {
+		return nil, fmt.Errorf("Failed to create model scheduler: %s", err)
+	}
+
+	// every model needs its own inbound and outbound FIFO
+	if need := 2 * uint(len(models)); fifos+need > maxFifos {
+		return nil, fmt.Errorf("Failed to create model scheduler: %d models need %d FIFOs, %d of %d available",
+			len(models), need, maxFifos-fifos, maxFifos)
+	}
+
+	s := &ModelScheduler{
+		models: make(map[string]*schedModel),
+		wake:   make(chan struct{}, 1),
+		done:   make(chan struct{}),
+	}
+
+	for i := range models {
+		if _, ok := s.models[models[i].Name]; ok {
+			s.destroyModels()
+			return nil, fmt.Errorf("Failed to create model scheduler: duplicate model %s", models[i].Name)
+		}
+
+		m, err := newSchedModel(d, &models[i])
+		if err != nil {
+			s.destroyModels()
+			return nil, fmt.Errorf("Failed to create model scheduler: %s", err)
+		}
+
+		s.models[m.name] = m
+		s.order = append(s.order, m)
+	}
+
+	s.wg.Add(1)
+	go s.dispatch()
+
+	return s, nil
+}
+
+// newSchedModel allocates graph of the model configured by opts on device d and starts reading its inference results
+func newSchedModel(d *Device, opts *ModelOpts) (*schedModel, error) {
+	inOpts, outOpts := opts.InOpts, opts.OutOpts
+	if inOpts == nil {
+		inOpts = &FifoOpts{FifoHostWO, FifoFP32, DefaultFifoNumElem}
+	}
+	if outOpts == nil {
+		outOpts = &FifoOpts{FifoHostRO, FifoFP32, DefaultFifoNumElem}
+	}
+
+	graph, err := NewGraph(opts.Name)
+	if err != nil {
+		return nil, err
+	}
+
+	executors := opts.Executors
+	if executors > 0 {
+		if err := graph.SetExecutorsCount(executors); err != nil {
+			graph.Destroy()
+			return nil, err
+		}
+	} else {
+		// executors count can't be queried, so the single executor of NCSDK default is assumed
+		executors = 1
+	}
+
+	queue, err := graph.AllocateWithFifosOpts(d, opts.GraphData, inOpts, outOpts)
+	if err != nil {
+		graph.Destroy()
+		return nil, err
+	}
+
+	pd, err := newPoolDevice(nil, OpenResult{Graph: graph, Queue: queue}, inOpts, outOpts)
+	if err != nil {
+		return nil, err
+	}
+
+	// results of running inferences are held in outbound FIFO, so it limits the inferences in flight as much as executors do
+	running := int(executors)
+	if running > outOpts.NumElem {
+		running = outOpts.NumElem
+	}
+
+	return &schedModel{
+		name:  opts.Name,
+		pd:    pd,
+		limit: inOpts.NumElem + running,
+	}, nil
+}
+
+// dispatch queues waiting requests on the device as long as their models have room for them
+func (s *ModelScheduler) dispatch() {
+	defer s.wg.Done()
+
+	for {
+		if m, req := s.nextRequest(); req != nil {
+			s.submit(m, req)
+			continue
+		}
+
+		select {
+		case <-s.wake:
+		case <-s.done:
+			return
+		}
+	}
+}
+
+// nextRequest takes the first waiting request of the model following the last served one which has room for it on the device.
+// Models are served round-robin so the model with the most requests can't starve the others.
+func (s *ModelScheduler) nextRequest() (*schedModel, *schedRequest) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	for i := range s.order {
+		m := s.order[(s.next+i)%len(s.order)]
+		if len(m.reqs) == 0 || m.inflight >= m.limit {
+			continue
+		}
+
+		req := m.reqs[0]
+		m.reqs[0] = nil
+		m.reqs = m.reqs[1:]
+		m.inflight++
+		s.next = (s.next + i + 1) % len(s.order)
+
+		return m, req
+	}
+
+	return nil, nil
+}
+
+// submit queues request on the device and delivers its result once it's available
+func (s *ModelScheduler) submit(m *schedModel, req *schedRequest) {
+	reply, err := m.pd.queue(req.data)
+	if err != nil {
+		s.finish(m)
+		req.reply <- poolResult{err: err}
+		return
+	}
+
+	go func() {
+		res := <-reply
+		s.finish(m)
+		req.reply <- res
+	}()
+}
+
+// finish releases the room taken by finished request of m and wakes up the dispatcher
+func (s *ModelScheduler) finish(m *schedModel) {
+	s.mu.Lock()
+	m.inflight--
+	s.mu.Unlock()
+
+	select {
+	case s.wake <- struct{}{}:
+	default:
+	}
+}
+
+// Models returns names of the scheduled models in the order they were allocated
+func (s *ModelScheduler) Models() []string {
+	names := make([]string, len(s.order))
+	for i, m := range s.order {
+		names[i] = m.name
+	}
+
+	return names
+}
+
+// Infer schedules data inference request for model and waits for its result.
+// It returns error if the model is not scheduled, if the scheduler has been destroyed or if it fails to queue the inference or to read its result.
+func (s *ModelScheduler) Infer(model string, data []byte) (*Tensor, error) {
+	m, ok := s.models[model]
+	if !ok {
+		return nil, fmt.Errorf("Failed to schedule inference: unknown model %s", model)
+	}
+
+	req := &schedRequest{
+		data:  data,
+		reply: make(chan poolResult, 1),
+	}
+
+	s.mu.Lock()
+	if s.stopped {
+		s.mu.Unlock()
+		return nil, fmt.Errorf("Failed to schedule inference: scheduler stopped")
+	}
+	m.reqs = append(m.reqs, req)
+	s.mu.Unlock()
+
+	select {
+	case s.wake <- struct{}{}:
+	default:
+	}
+
+	res := <-req.reply
+
+	return res.tensor, res.err
+}
+
+// Destroy stops the scheduler and destroys graphs of all the models along with their FIFOs.
+// Requests which have not been queued on the device yet and inferences which are in flight fail with error.
+// Destroy does not close the scheduler device. Destroying already destroyed scheduler has no effect.
+func (s *ModelScheduler) Destroy() error {
+	s.mu.Lock()
+	if s.stopped {
+		s.mu.Unlock()
+		return nil
+	}
+	s.stopped = true
+	s.mu.Unlock()
+
+	close(s.done)
+	s.wg.Wait()
+
+	for _, m := range s.order {
+		for _, req := range m.reqs {
+			req.reply <- poolResult{err: fmt.Errorf("Failed to schedule inference: scheduler stopped")}
+		}
+		m.reqs = nil
+	}
+
+	s.destroyModels()
+
+	return nil
+}
+
+// destroyModels destroys graphs of all the models along with their FIFOs
+func (s *ModelScheduler) destroyModels() {
+	for _, m := range s.order {
+		m.pd.destroy()
+	}
+}
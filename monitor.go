@@ -0,0 +1,149 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"sync"
+	"time"
+	"unsafe"
+)
+
+// DefaultMonitorPeriod is the default time between device health samples
+const DefaultMonitorPeriod = time.Second
+
+// MonitorOpts configures Monitor
+type MonitorOpts struct {
+	// Period is the time between device health samples; DefaultMonitorPeriod is used if it's 0
+	Period time.Duration
+	// ThrottleTemp is the temperature in degrees Celsius inference submissions start to be throttled at
+	ThrottleTemp float32
+	// MaxTemp is the temperature in degrees Celsius inference submissions are throttled the most at.
+	// It should be set below the temperature the device firmware starts throttling at.
+	MaxTemp float32
+	// MaxInterval is the minimum interval between inferences queued on the device at MaxTemp or once the firmware throttles the device.
+	// Inference submissions are not throttled if it's 0.
+	MaxInterval time.Duration
+}
+
+// DeviceHealth is device health sampled by Monitor
+type DeviceHealth struct {
+	// SampledAt is the time of the last successful sample
+	SampledAt time.Time
+	// Samples is the number of samples taken, including the failed ones
+	Samples uint64
+	// Err is the error of the last sample; the other fields hold the last successful sample if it's set
+	Err error
+	// Temperature is the most recent device temperature in degrees Celsius
+	Temperature float32
+	// ThermalStats contains max temperatures for the last ThermalBufferSize seconds
+	ThermalStats []float32
+	// Throttle is the firmware thermal throttling level
+	Throttle DeviceThermalThrottle
+	// MemoryUsed is the device memory in use in bytes
+	MemoryUsed uint
+	// MemorySize is the total device memory in bytes
+	MemorySize uint
+	// Interval is the minimum interval between inferences queued on the device; it's 0 if they are not throttled
+	Interval time.Duration
+}
+
+// Monitor samples thermal and memory stats of a device on a native thread into a shared snapshot, so reading device health does not query the device.
+// When the device heats up above ThrottleTemp inferences queued on it are spaced apart by an interval which grows linearly up to MaxInterval at MaxTemp.
+// Easing off the submission rate before the firmware throttling kicks in keeps the throughput steady instead of swinging between full speed and throttled.
+// Throttling applies to all inferences queued on the device and a single device must not be monitored by more than one Monitor.
+// Monitor is safe for concurrent use.
+type Monitor struct {
+	handle unsafe.Pointer
+	// mu guards handle
+	mu sync.RWMutex
+}
+
+// NewMonitor samples health of the opened device d and starts monitoring it.
+// The device must stay open until the monitor is destroyed.
+// It returns error if the options are invalid or if it fails to sample the device health.
+func NewMonitor(d *Device, opts *MonitorOpts) (*Monitor, error) {
+	period := opts.Period
+	if period == 0 {
+		period = DefaultMonitorPeriod
+	}
+
+	if period < 0 || opts.MaxInterval < 0 {
+		return nil, fmt.Errorf("Failed to create monitor: negative period or interval")
+	}
+
+	if opts.MaxInterval > 0 && opts.MaxTemp <= opts.ThrottleTemp {
+		return nil, fmt.Errorf("Failed to create monitor: max temperature %.1f not above throttle temperature %.1f",
+			opts.MaxTemp, opts.ThrottleTemp)
+	}
+
+	cOpts := C.ncs_MonitorOpts{
+		period:       C.ulonglong(period),
+		throttleTemp: C.float(opts.ThrottleTemp),
+		maxTemp:      C.float(opts.MaxTemp),
+		maxInterval:  C.ulonglong(opts.MaxInterval),
+	}
+
+	var handle unsafe.Pointer
+
+	s := C.ncs_MonitorStart(d.handle, &cOpts, &handle)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to create monitor: %s", Status(s))
+	}
+
+	return &Monitor{handle: handle}, nil
+}
+
+// Health returns the last sampled device health.
+// It returns error if the monitor has been destroyed.
+func (m *Monitor) Health() (*DeviceHealth, error) {
+	m.mu.RLock()
+	defer m.mu.RUnlock()
+
+	if m.handle == nil {
+		return nil, fmt.Errorf("Failed to read device health: %s", StatusInvalidHandle)
+	}
+
+	var h C.ncs_DeviceHealth
+	C.ncs_MonitorHealth(m.handle, &h)
+
+	health := &DeviceHealth{
+		SampledAt:    time.Now().Add(-time.Duration(h.age)),
+		Samples:      uint64(h.samples),
+		Temperature:  float32(h.thermalStats[0]),
+		ThermalStats: make([]float32, ThermalBufferSize),
+		Throttle:     DeviceThermalThrottle(h.throttle),
+		MemoryUsed:   uint(h.memoryUsed),
+		MemorySize:   uint(h.memorySize),
+		Interval:     time.Duration(h.interval),
+	}
+
+	for i := range health.ThermalStats {
+		health.ThermalStats[i] = float32(h.thermalStats[i])
+	}
+
+	if Status(h.status) != StatusOK {
+		health.Err = fmt.Errorf("Failed to sample device health: %s", Status(h.status))
+	}
+
+	return health, nil
+}
+
+// Destroy stops monitoring the device and stops throttling inferences queued on it.
+// It waits for the device health sample which is being taken, so the device can be closed as soon as Destroy returns.
+func (m *Monitor) Destroy() error {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	s := C.ncs_MonitorStop(&m.handle)
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to destroy monitor: %s", Status(s))
+	}
+
+	return nil
+}
@@ -0,0 +1,1238 @@
+//go:build ncsmock
+// +build ncsmock
+
+// mvnc_mock.cpp implements NCSDK API V2 on top of simulated NCS devices so the package can be load tested without any hardware.
+// It's built instead of linking libmvnc when the package is built with the ncsmock build tag.
+//
+// Simulated devices are configured via the following environment variables read when the first device is created:
+//   NCS_MOCK_DEVICES    number of simulated devices (default 1)
+//   NCS_MOCK_LATENCY    time a single inference runs on a graph executor, e.g. 500us, 8ms (default 10ms)
+//   NCS_MOCK_EXECUTORS  default number of graph executors running inferences in parallel (default 1)
+//   NCS_MOCK_FIFO_DEPTH number of elements of FIFOs allocated by ncGraphAllocateWithFifos (default 2)
+//   NCS_MOCK_BOOT       time it takes to open a device (default 0)
+//   NCS_MOCK_INPUT      graph input tensor dimensions as WxHxC (default 224x224x3)
+//   NCS_MOCK_OUTPUT     graph output tensor dimensions as WxHxC or the number of output values (default 1000)
+//   NCS_MOCK_THERMAL    device temperature in degrees Celsius (default 38.5)
+//   NCS_MOCK_FAULT      number of inferences queued on device 0 after which it resets once, failing all its calls with NC_ERROR
+//                       until its handle is re-created (default 0, never)
+//   NCS_MOCK_REMOVE     set to 1 to implement ncFifoRemoveElem; otherwise it returns NC_UNSUPPORTED_FEATURE like released NCSDK versions do (default 0)
+//
+// Inferences complete in the order they were queued once an executor has spent the configured latency on them.
+// Every result is a one-hot tensor whose hot value index is derived from the input tensor data.
+#include <mvnc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock mockClock;
+
+// simulated device limits
+#define MOCK_MEMORY_SIZE (512 * 1024 * 1024)
+#define MOCK_MAX_FIFOS 20
+#define MOCK_MAX_GRAPHS 10
+#define MOCK_MAX_EXECUTORS 4
+#define MOCK_THERMAL 38.5f
+// temperatures simulated firmware reports thermal throttling levels at
+#define MOCK_LOWER_GUARD 70.0f
+#define MOCK_UPPER_GUARD 80.0f
+
+// mockConfig configures simulated devices
+struct mockConfig {
+        int devices;
+        mockClock::duration latency;
+        mockClock::duration boot;
+        unsigned int executors;
+        unsigned int fifoDepth;
+        unsigned int input[3];
+        unsigned int output[3];
+        float thermal;
+        unsigned int fault;
+        bool remove;
+};
+
+// envUint returns the value of unsigned integer environment variable name or def if it's not set or invalid
+static unsigned int envUint(const char* name, unsigned int def) {
+        const char* v = getenv(name);
+        if (v == NULL || *v == '\0') {
+                return def;
+        }
+
+        char* end = NULL;
+        unsigned long n = strtoul(v, &end, 10);
+        if (*end != '\0' || n == 0) {
+                return def;
+        }
+
+        return (unsigned int) n;
+}
+
+// envDuration returns the value of duration environment variable name or def if it's not set or invalid.
+// The value is a decimal number with an optional ns, us, ms or s unit suffix; milliseconds are assumed without a suffix.
+static mockClock::duration envDuration(const char* name, mockClock::duration def) {
+        const char* v = getenv(name);
+        if (v == NULL || *v == '\0') {
+                return def;
+        }
+
+        char* end = NULL;
+        double d = strtod(v, &end);
+        if (end == v || d < 0) {
+                return def;
+        }
+
+        double scale = 1e6;
+        if (strcmp(end, "ns") == 0) {
+                scale = 1;
+        } else if (strcmp(end, "us") == 0) {
+                scale = 1e3;
+        } else if (strcmp(end, "s") == 0) {
+                scale = 1e9;
+        } else if (*end != '\0' && strcmp(end, "ms") != 0) {
+                return def;
+        }
+
+        return std::chrono::duration_cast<mockClock::duration>(std::chrono::nanoseconds((long long) (d * scale)));
+}
+
+// envFloat returns the value of floating point environment variable name or def if it's not set or invalid
+static float envFloat(const char* name, float def) {
+        const char* v = getenv(name);
+        if (v == NULL || *v == '\0') {
+                return def;
+        }
+
+        char* end = NULL;
+        float f = strtof(v, &end);
+        if (end == v || *end != '\0') {
+                return def;
+        }
+
+        return f;
+}
+
+// envDims parses tensor dimensions environment variable name formatted as WxHxC or a single number of values into dims.
+// dims are left untouched if the variable is not set or invalid.
+static void envDims(const char* name, unsigned int dims[3]) {
+        const char* v = getenv(name);
+        if (v == NULL || *v == '\0') {
+                return;
+        }
+
+        unsigned int w = 0, h = 0, c = 0;
+        char tail = 0;
+        if (sscanf(v, "%ux%ux%u%c", &w, &h, &c, &tail) == 3 && w > 0 && h > 0 && c > 0) {
+                dims[0] = w;
+                dims[1] = h;
+                dims[2] = c;
+        } else if (sscanf(v, "%u%c", &c, &tail) == 1 && c > 0) {
+                dims[0] = 1;
+                dims[1] = 1;
+                dims[2] = c;
+        }
+}
+
+static mockConfig loadConfig() {
+        mockConfig c;
+        c.devices = int(envUint("NCS_MOCK_DEVICES", 1));
+        c.latency = envDuration("NCS_MOCK_LATENCY", std::chrono::milliseconds(10));
+        c.boot = envDuration("NCS_MOCK_BOOT", mockClock::duration::zero());
+        c.executors = envUint("NCS_MOCK_EXECUTORS", 1);
+        c.fifoDepth = envUint("NCS_MOCK_FIFO_DEPTH", 2);
+        c.input[0] = 224;
+        c.input[1] = 224;
+        c.input[2] = 3;
+        envDims("NCS_MOCK_INPUT", c.input);
+        c.output[0] = 1;
+        c.output[1] = 1;
+        c.output[2] = 1000;
+        envDims("NCS_MOCK_OUTPUT", c.output);
+        c.thermal = envFloat("NCS_MOCK_THERMAL", MOCK_THERMAL);
+        c.fault = envUint("NCS_MOCK_FAULT", 0);
+        c.remove = envUint("NCS_MOCK_REMOVE", 0) == 1;
+
+        return c;
+}
+
+static const mockConfig& config() {
+        static const mockConfig c = loadConfig();
+        return c;
+}
+
+// mockTensorDesc returns dense channel minor tensor descriptor of WxHxC tensor with values of dataType
+static struct ncTensorDescriptor_t mockTensorDesc(unsigned int w, unsigned int h, unsigned int c, ncFifoDataType_t dataType) {
+        unsigned int valSize = dataType == NC_FIFO_FP16 ? sizeof(uint16_t) : sizeof(float);
+
+        struct ncTensorDescriptor_t td;
+        td.n = 1;
+        td.c = c;
+        td.w = w;
+        td.h = h;
+        td.cStride = valSize;
+        td.wStride = c * valSize;
+        td.hStride = w * c * valSize;
+        td.totalSize = h * td.hStride;
+        td.dataType = dataType;
+
+        return td;
+}
+
+// getOption copies option value val of size bytes into data.
+// If data is NULL or too small it returns NC_INVALID_DATA_LENGTH and sets dataLength to the option size.
+static ncStatus_t getOption(void* data, unsigned int* dataLength, const void* val, unsigned int size) {
+        if (dataLength == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        if (data == NULL || *dataLength < size) {
+                *dataLength = size;
+                return NC_INVALID_DATA_LENGTH;
+        }
+
+        memcpy(data, val, size);
+        *dataLength = size;
+
+        return NC_OK;
+}
+
+static ncStatus_t getIntOption(void* data, unsigned int* dataLength, int val) {
+        return getOption(data, dataLength, &val, sizeof(val));
+}
+
+static ncStatus_t getStringOption(void* data, unsigned int* dataLength, const std::string& val) {
+        return getOption(data, dataLength, val.c_str(), (unsigned int) val.size() + 1);
+}
+
+static int logLevel = NC_LOG_WARN;
+
+ncStatus_t ncGlobalSetOption(int option, const void *data, unsigned int dataLength) {
+        if (option != NC_RW_LOG_LEVEL) {
+                return NC_UNAUTHORIZED;
+        }
+
+        if (data == NULL || dataLength != sizeof(int)) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        logLevel = *(const int*) data;
+
+        return NC_OK;
+}
+
+ncStatus_t ncGlobalGetOption(int option, void *data, unsigned int *dataLength) {
+        switch (option) {
+        case NC_RW_LOG_LEVEL:
+                return getIntOption(data, dataLength, logLevel);
+        case NC_RO_API_VERSION: {
+                unsigned int version[NC_VERSION_MAX_SIZE] = {2, 0, 0, 0};
+                return getOption(data, dataLength, version, sizeof(version));
+        }
+        }
+
+        return NC_INVALID_PARAMETERS;
+}
+
+// mockDevice is a simulated NCS device
+struct mockDevice {
+        std::mutex mu;
+        int index;
+        std::string name;
+        ncDeviceState_t state;
+        unsigned int memoryUsed;
+        int fifos;
+        int graphs;
+        // failed is set once the simulated device resets; it's atomic so FIFOs can check it without taking the device lock
+        std::atomic<bool> failed;
+};
+
+static mockDevice* deviceOf(struct ncDeviceHandle_t* h) {
+        return h == NULL ? NULL : (mockDevice*) h->private_data;
+}
+
+ncStatus_t ncDeviceCreate(int index, struct ncDeviceHandle_t **deviceHandle) {
+        if (deviceHandle == NULL || index < 0) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        if (index >= config().devices) {
+                return NC_DEVICE_NOT_FOUND;
+        }
+
+        mockDevice* d = new mockDevice;
+        d->index = index;
+        d->name = "mock-" + std::to_string(index);
+        d->state = NC_DEVICE_CREATED;
+        d->memoryUsed = 0;
+        d->fifos = 0;
+        d->graphs = 0;
+        d->failed.store(false);
+
+        *deviceHandle = new ncDeviceHandle_t;
+        (*deviceHandle)->private_data = d;
+
+        return NC_OK;
+}
+
+ncStatus_t ncDeviceOpen(struct ncDeviceHandle_t *deviceHandle) {
+        mockDevice* d = deviceOf(deviceHandle);
+        if (d == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        std::this_thread::sleep_for(config().boot);
+
+        std::lock_guard<std::mutex> lock(d->mu);
+        d->state = NC_DEVICE_OPENED;
+
+        return NC_OK;
+}
+
+ncStatus_t ncDeviceClose(struct ncDeviceHandle_t *deviceHandle) {
+        mockDevice* d = deviceOf(deviceHandle);
+        if (d == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        std::lock_guard<std::mutex> lock(d->mu);
+        d->state = NC_DEVICE_CLOSED;
+
+        return NC_OK;
+}
+
+ncStatus_t ncDeviceDestroy(struct ncDeviceHandle_t **deviceHandle) {
+        if (deviceHandle == NULL || deviceOf(*deviceHandle) == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        delete deviceOf(*deviceHandle);
+        delete *deviceHandle;
+        *deviceHandle = NULL;
+
+        return NC_OK;
+}
+
+ncStatus_t ncDeviceSetOption(struct ncDeviceHandle_t *deviceHandle, int option, const void *data, unsigned int dataLength) {
+        if (deviceOf(deviceHandle) == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        // all device options are read only
+        (void) option;
+        (void) data;
+        (void) dataLength;
+        return NC_UNAUTHORIZED;
+}
+
+ncStatus_t ncDeviceGetOption(struct ncDeviceHandle_t *deviceHandle, int option, void *data, unsigned int *dataLength) {
+        mockDevice* d = deviceOf(deviceHandle);
+        if (d == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (d->failed.load()) {
+                return NC_ERROR;
+        }
+
+        std::lock_guard<std::mutex> lock(d->mu);
+
+        switch (option) {
+        case NC_RO_DEVICE_THERMAL_STATS: {
+                float stats[NC_THERMAL_BUFFER_SIZE];
+                for (int i = 0; i < NC_THERMAL_BUFFER_SIZE; i++) {
+                        stats[i] = config().thermal;
+                }
+                return getOption(data, dataLength, stats, sizeof(stats));
+        }
+        case NC_RO_DEVICE_THERMAL_THROTTLING_LEVEL: {
+                float t = config().thermal;
+                return getIntOption(data, dataLength, t >= MOCK_UPPER_GUARD ? 2 : (t >= MOCK_LOWER_GUARD ? 1 : 0));
+        }
+        case NC_RO_DEVICE_STATE:
+                return getIntOption(data, dataLength, d->state);
+        case NC_RO_DEVICE_CURRENT_MEMORY_USED:
+                return getIntOption(data, dataLength, int(d->memoryUsed));
+        case NC_RO_DEVICE_MEMORY_SIZE:
+                return getIntOption(data, dataLength, MOCK_MEMORY_SIZE);
+        case NC_RO_DEVICE_MAX_FIFO_NUM:
+                return getIntOption(data, dataLength, MOCK_MAX_FIFOS);
+        case NC_RO_DEVICE_ALLOCATED_FIFO_NUM:
+                return getIntOption(data, dataLength, d->fifos);
+        case NC_RO_DEVICE_MAX_GRAPH_NUM:
+                return getIntOption(data, dataLength, MOCK_MAX_GRAPHS);
+        case NC_RO_DEVICE_ALLOCATED_GRAPH_NUM:
+                return getIntOption(data, dataLength, d->graphs);
+        case NC_RO_DEVICE_OPTION_CLASS_LIMIT:
+                return getIntOption(data, dataLength, 3);
+        case NC_RO_DEVICE_FW_VERSION: {
+                unsigned int version[NC_VERSION_MAX_SIZE] = {2, 10, 1, 0};
+                return getOption(data, dataLength, version, sizeof(version));
+        }
+        case NC_RO_DEVICE_DEBUG_INFO:
+                return getStringOption(data, dataLength, "");
+        case NC_RO_DEVICE_MVTENSOR_VERSION: {
+                unsigned int version[2] = {2, 0};
+                return getOption(data, dataLength, version, sizeof(version));
+        }
+        case NC_RO_DEVICE_NAME:
+                return getStringOption(data, dataLength, d->name);
+        case NC_RO_DEVICE_MAX_EXECUTORS_NUM:
+                return getIntOption(data, dataLength, MOCK_MAX_EXECUTORS);
+        case NC_RO_DEVICE_HW_VERSION:
+                return getIntOption(data, dataLength, NC_MA2480);
+        }
+
+        return NC_INVALID_PARAMETERS;
+}
+
+// mockElem is a FIFO element
+struct mockElem {
+        std::vector<char> data;
+        void* userParam;
+};
+
+// mockFifo is a simulated FIFO.
+// It is referenced by its handle and by the inferences in flight whose results it receives; it is freed when all of them release it.
+struct mockFifo {
+        std::mutex mu;
+        std::condition_variable cv;
+        std::atomic<int> refs;
+        std::string name;
+        ncFifoType_t type;
+        ncFifoState_t state;
+        int consumers;
+        ncFifoDataType_t dataType;
+        int dontBlock;
+        struct ncTensorDescriptor_t graphDesc;
+        struct ncTensorDescriptor_t hostDesc;
+        unsigned int capacity;
+        std::deque<mockElem> elems;
+        mockDevice* device;
+        bool closed;
+};
+
+static mockFifo* fifoOf(struct ncFifoHandle_t* h) {
+        return h == NULL ? NULL : (mockFifo*) h->private_data;
+}
+
+static void fifoUnref(mockFifo* f) {
+        if (f->refs.fetch_sub(1) == 1) {
+                delete f;
+        }
+}
+
+// fifoFailed returns true if the device FIFO f is allocated on has failed; it must be called with FIFO lock held
+static bool fifoFailed(mockFifo* f) {
+        return f->device != NULL && f->device->failed.load();
+}
+
+// fifoFail wakes up everyone waiting on FIFO f after its device has failed
+static void fifoFail(mockFifo* f) {
+        std::lock_guard<std::mutex> lock(f->mu);
+        f->cv.notify_all();
+}
+
+// fifoPush appends elem to FIFO f blocking until the FIFO has space for it.
+// Host writes to non-blocking FIFO fail with NC_OUT_OF_MEMORY instead of blocking.
+static ncStatus_t fifoPush(mockFifo* f, mockElem& elem, bool host) {
+        std::unique_lock<std::mutex> lock(f->mu);
+        if (host && f->dontBlock && !f->closed && !fifoFailed(f) && f->elems.size() >= f->capacity) {
+                return NC_OUT_OF_MEMORY;
+        }
+        f->cv.wait(lock, [f] { return f->closed || fifoFailed(f) || f->elems.size() < f->capacity; });
+        if (f->closed) {
+                return NC_INVALID_HANDLE;
+        }
+        if (fifoFailed(f)) {
+                return NC_ERROR;
+        }
+
+        f->elems.push_back(std::move(elem));
+        f->cv.notify_all();
+
+        return NC_OK;
+}
+
+// fifoPop removes the oldest element of FIFO f into elem blocking until the FIFO has an element.
+// Host reads from non-blocking FIFO fail with NC_OUT_OF_MEMORY instead of blocking.
+static ncStatus_t fifoPop(mockFifo* f, mockElem& elem, bool host) {
+        std::unique_lock<std::mutex> lock(f->mu);
+        if (host && f->dontBlock && !f->closed && !fifoFailed(f) && f->elems.empty()) {
+                return NC_OUT_OF_MEMORY;
+        }
+        f->cv.wait(lock, [f] { return f->closed || fifoFailed(f) || !f->elems.empty(); });
+        if (f->closed) {
+                return NC_INVALID_HANDLE;
+        }
+        if (fifoFailed(f)) {
+                return NC_ERROR;
+        }
+
+        elem = std::move(f->elems.front());
+        f->elems.pop_front();
+        f->cv.notify_all();
+
+        return NC_OK;
+}
+
+ncStatus_t ncFifoCreate(const char *name, ncFifoType_t type, struct ncFifoHandle_t **fifoHandle) {
+        if (name == NULL || fifoHandle == NULL || (type != NC_FIFO_HOST_RO && type != NC_FIFO_HOST_WO)) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        mockFifo* f = new mockFifo;
+        f->refs.store(1);
+        f->name = std::string(name).substr(0, NC_MAX_NAME_SIZE - 1);
+        f->type = type;
+        f->state = NC_FIFO_CREATED;
+        f->consumers = 1;
+        f->dataType = NC_FIFO_FP32;
+        f->dontBlock = 0;
+        memset(&f->graphDesc, 0, sizeof(f->graphDesc));
+        memset(&f->hostDesc, 0, sizeof(f->hostDesc));
+        f->capacity = 0;
+        f->device = NULL;
+        f->closed = false;
+
+        *fifoHandle = new ncFifoHandle_t;
+        (*fifoHandle)->private_data = f;
+
+        return NC_OK;
+}
+
+ncStatus_t ncFifoAllocate(struct ncFifoHandle_t* fifoHandle, struct ncDeviceHandle_t* device,
+                struct ncTensorDescriptor_t* tensorDesc, unsigned int numElem) {
+        mockFifo* f = fifoOf(fifoHandle);
+        mockDevice* d = deviceOf(device);
+        if (f == NULL || d == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (tensorDesc == NULL || numElem == 0 || tensorDesc->c == 0 || tensorDesc->w == 0 || tensorDesc->h == 0) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        std::lock_guard<std::mutex> devLock(d->mu);
+        if (d->state != NC_DEVICE_OPENED) {
+                return NC_UNAUTHORIZED;
+        }
+        if (d->fifos >= MOCK_MAX_FIFOS) {
+                return NC_OUT_OF_MEMORY;
+        }
+
+        std::lock_guard<std::mutex> lock(f->mu);
+        if (f->state != NC_FIFO_CREATED) {
+                return NC_UNAUTHORIZED;
+        }
+
+        f->graphDesc = *tensorDesc;
+        f->hostDesc = mockTensorDesc(tensorDesc->w, tensorDesc->h, tensorDesc->c, f->dataType);
+        f->capacity = numElem;
+        f->device = d;
+        f->state = NC_FIFO_ALLOCATED;
+        d->fifos++;
+
+        return NC_OK;
+}
+
+ncStatus_t ncFifoDestroy(struct ncFifoHandle_t** fifoHandle) {
+        if (fifoHandle == NULL || fifoOf(*fifoHandle) == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        mockFifo* f = fifoOf(*fifoHandle);
+        mockDevice* d = NULL;
+        {
+                std::lock_guard<std::mutex> lock(f->mu);
+                f->closed = true;
+                f->elems.clear();
+                f->cv.notify_all();
+                d = f->device;
+                f->device = NULL;
+        }
+
+        if (d != NULL) {
+                std::lock_guard<std::mutex> devLock(d->mu);
+                d->fifos--;
+        }
+
+        fifoUnref(f);
+        delete *fifoHandle;
+        *fifoHandle = NULL;
+
+        return NC_OK;
+}
+
+ncStatus_t ncFifoSetOption(struct ncFifoHandle_t* fifoHandle, int option, const void *data, unsigned int dataLength) {
+        mockFifo* f = fifoOf(fifoHandle);
+        if (f == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (data == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        std::lock_guard<std::mutex> lock(f->mu);
+
+        switch (option) {
+        case NC_RW_FIFO_TYPE:
+        case NC_RW_FIFO_CONSUMER_COUNT:
+        case NC_RW_FIFO_DATA_TYPE:
+        case NC_RW_FIFO_DONT_BLOCK: {
+                if (dataLength != sizeof(int)) {
+                        return NC_INVALID_DATA_LENGTH;
+                }
+                if (f->state != NC_FIFO_CREATED) {
+                        return NC_UNAUTHORIZED;
+                }
+
+                int val = *(const int*) data;
+                switch (option) {
+                case NC_RW_FIFO_TYPE:
+                        f->type = ncFifoType_t(val);
+                        break;
+                case NC_RW_FIFO_CONSUMER_COUNT:
+                        f->consumers = val;
+                        break;
+                case NC_RW_FIFO_DATA_TYPE:
+                        f->dataType = ncFifoDataType_t(val);
+                        break;
+                case NC_RW_FIFO_DONT_BLOCK:
+                        f->dontBlock = val;
+                        break;
+                }
+                return NC_OK;
+        }
+        case NC_RW_FIFO_HOST_TENSOR_DESCRIPTOR: {
+                if (dataLength != sizeof(struct ncTensorDescriptor_t)) {
+                        return NC_INVALID_DATA_LENGTH;
+                }
+                if (f->state != NC_FIFO_ALLOCATED) {
+                        return NC_UNAUTHORIZED;
+                }
+
+                const struct ncTensorDescriptor_t* td = (const struct ncTensorDescriptor_t*) data;
+                if (td->totalSize != f->hostDesc.totalSize) {
+                        return NC_INVALID_PARAMETERS;
+                }
+                f->hostDesc = *td;
+                return NC_OK;
+        }
+        case NC_RO_FIFO_CAPACITY:
+        case NC_RO_FIFO_READ_FILL_LEVEL:
+        case NC_RO_FIFO_WRITE_FILL_LEVEL:
+        case NC_RO_FIFO_GRAPH_TENSOR_DESCRIPTOR:
+        case NC_RO_FIFO_STATE:
+        case NC_RO_FIFO_NAME:
+        case NC_RO_FIFO_ELEMENT_DATA_SIZE:
+                return NC_UNAUTHORIZED;
+        }
+
+        return NC_INVALID_PARAMETERS;
+}
+
+ncStatus_t ncFifoGetOption(struct ncFifoHandle_t* fifoHandle, int option, void *data, unsigned int *dataLength) {
+        mockFifo* f = fifoOf(fifoHandle);
+        if (f == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        std::lock_guard<std::mutex> lock(f->mu);
+
+        switch (option) {
+        case NC_RW_FIFO_TYPE:
+                return getIntOption(data, dataLength, f->type);
+        case NC_RW_FIFO_CONSUMER_COUNT:
+                return getIntOption(data, dataLength, f->consumers);
+        case NC_RW_FIFO_DATA_TYPE:
+                return getIntOption(data, dataLength, f->dataType);
+        case NC_RW_FIFO_DONT_BLOCK:
+                return getIntOption(data, dataLength, f->dontBlock);
+        case NC_RO_FIFO_CAPACITY:
+                return getIntOption(data, dataLength, int(f->capacity));
+        case NC_RO_FIFO_READ_FILL_LEVEL:
+                return getIntOption(data, dataLength, f->type == NC_FIFO_HOST_RO ? int(f->elems.size()) : 0);
+        case NC_RO_FIFO_WRITE_FILL_LEVEL:
+                return getIntOption(data, dataLength, f->type == NC_FIFO_HOST_WO ? int(f->elems.size()) : 0);
+        case NC_RO_FIFO_GRAPH_TENSOR_DESCRIPTOR:
+                return getOption(data, dataLength, &f->graphDesc, sizeof(f->graphDesc));
+        case NC_RO_FIFO_STATE:
+                return getIntOption(data, dataLength, f->state);
+        case NC_RO_FIFO_NAME:
+                return getStringOption(data, dataLength, f->name);
+        case NC_RO_FIFO_ELEMENT_DATA_SIZE:
+                return getIntOption(data, dataLength, int(f->hostDesc.totalSize));
+        case NC_RW_FIFO_HOST_TENSOR_DESCRIPTOR:
+                return getOption(data, dataLength, &f->hostDesc, sizeof(f->hostDesc));
+        }
+
+        return NC_INVALID_PARAMETERS;
+}
+
+// fifoCheckLocked checks FIFO f is allocated and accessible by the host for operation of access type; it must be called with FIFO lock held
+static ncStatus_t fifoCheckLocked(mockFifo* f, ncFifoType_t access) {
+        if (f->state != NC_FIFO_ALLOCATED || f->closed) {
+                return NC_NOT_ALLOCATED;
+        }
+        if (fifoFailed(f)) {
+                return NC_ERROR;
+        }
+        if (f->type != access) {
+                return NC_UNAUTHORIZED;
+        }
+
+        return NC_OK;
+}
+
+// fifoCheck checks FIFO f is allocated and accessible by the host for operation of access type
+static ncStatus_t fifoCheck(mockFifo* f, ncFifoType_t access) {
+        std::lock_guard<std::mutex> lock(f->mu);
+        return fifoCheckLocked(f, access);
+}
+
+// fifoAcquire checks FIFO f like fifoCheck does and references it under the same lock so it is not freed by concurrent ncFifoDestroy.
+// The reference is released by fifoUnref.
+static ncStatus_t fifoAcquire(mockFifo* f, ncFifoType_t access) {
+        std::lock_guard<std::mutex> lock(f->mu);
+        ncStatus_t s = fifoCheckLocked(f, access);
+        if (s != NC_OK) {
+                return s;
+        }
+        f->refs.fetch_add(1);
+
+        return NC_OK;
+}
+
+ncStatus_t ncFifoWriteElem(struct ncFifoHandle_t* fifoHandle, const void *inputTensor,
+                unsigned int * inputTensorLength, void *userParam) {
+        mockFifo* f = fifoOf(fifoHandle);
+        if (f == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (inputTensor == NULL || inputTensorLength == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        ncStatus_t s = fifoCheck(f, NC_FIFO_HOST_WO);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        if (*inputTensorLength != f->hostDesc.totalSize) {
+                *inputTensorLength = f->hostDesc.totalSize;
+                return NC_INVALID_DATA_LENGTH;
+        }
+
+        mockElem elem;
+        elem.data.assign((const char*) inputTensor, (const char*) inputTensor + *inputTensorLength);
+        elem.userParam = userParam;
+
+        return fifoPush(f, elem, true);
+}
+
+ncStatus_t ncFifoReadElem(struct ncFifoHandle_t* fifoHandle, void *outputData, unsigned int* outputDataLen, void **userParam) {
+        mockFifo* f = fifoOf(fifoHandle);
+        if (f == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (outputData == NULL || outputDataLen == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        ncStatus_t s = fifoAcquire(f, NC_FIFO_HOST_RO);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        if (*outputDataLen < f->hostDesc.totalSize) {
+                *outputDataLen = f->hostDesc.totalSize;
+                fifoUnref(f);
+                return NC_INVALID_DATA_LENGTH;
+        }
+
+        mockElem elem;
+        s = fifoPop(f, elem, true);
+        fifoUnref(f);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        memcpy(outputData, elem.data.data(), elem.data.size());
+        *outputDataLen = (unsigned int) elem.data.size();
+        if (userParam != NULL) {
+                *userParam = elem.userParam;
+        }
+
+        return NC_OK;
+}
+
+// ncFifoRemoveElem removes the oldest element written to FIFO which has not been consumed by an inference yet.
+// It's only implemented if NCS_MOCK_REMOVE is set.
+ncStatus_t ncFifoRemoveElem(struct ncFifoHandle_t* fifoHandle) {
+        mockFifo* f = fifoOf(fifoHandle);
+        if (f == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (!config().remove) {
+                return NC_UNSUPPORTED_FEATURE;
+        }
+
+        ncStatus_t s = fifoCheck(f, NC_FIFO_HOST_WO);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        std::lock_guard<std::mutex> lock(f->mu);
+        if (f->elems.empty()) {
+                return NC_UNAUTHORIZED;
+        }
+
+        f->elems.pop_front();
+        f->cv.notify_all();
+
+        return NC_OK;
+}
+
+// mockInference is an inference in flight
+struct mockInference {
+        mockClock::time_point done;
+        uint64_t inputHash;
+        void* userParam;
+        mockFifo* out;
+};
+
+// mockGraph is a simulated graph.
+// Its executors run queued inferences in parallel; results are delivered to output FIFOs in queue order by the graph thread.
+struct mockGraph {
+        std::mutex mu;
+        std::condition_variable cv;
+        std::string name;
+        ncGraphState_t state;
+        unsigned int executors;
+        // executorsFree are the times graph executors finish their last queued inference
+        std::vector<mockClock::time_point> executorsFree;
+        std::deque<mockInference> inflight;
+        mockDevice* device;
+        unsigned int size;
+        struct ncTensorDescriptor_t inputDesc;
+        struct ncTensorDescriptor_t outputDesc;
+        float timeTaken;
+        std::thread thread;
+        bool stop;
+};
+
+static mockGraph* graphOf(struct ncGraphHandle_t* h) {
+        return h == NULL ? NULL : (mockGraph*) h->private_data;
+}
+
+// tensorHash hashes a sample of tensor data bytes
+static uint64_t tensorHash(const std::vector<char>& data) {
+        uint64_t h = 14695981039346656037ULL;
+        size_t step = data.size() / 64 + 1;
+        for (size_t i = 0; i < data.size(); i += step) {
+                h ^= uint8_t(data[i]);
+                h *= 1099511628211ULL;
+        }
+
+        return h;
+}
+
+// inferenceResult fills elem with the result of inference inf delivered to FIFO f
+static void inferenceResult(mockFifo* f, const mockInference& inf, mockElem& elem) {
+        const struct ncTensorDescriptor_t& td = f->hostDesc;
+
+        elem.data.assign(td.totalSize, 0);
+        elem.userParam = inf.userParam;
+
+        size_t vals = size_t(td.c) * td.w * td.h;
+        if (vals == 0) {
+                return;
+        }
+
+        size_t i = inf.inputHash % vals;
+        size_t off = (i / (size_t(td.c) * td.w)) * td.hStride + (i / td.c % td.w) * td.wStride + (i % td.c) * td.cStride;
+        if (td.dataType == NC_FIFO_FP16) {
+                uint16_t one = 0x3c00;
+                memcpy(&elem.data[off], &one, sizeof(one));
+        } else {
+                float one = 1.0f;
+                memcpy(&elem.data[off], &one, sizeof(one));
+        }
+}
+
+// graphRun delivers results of graph g inferences to their output FIFOs once they are done
+static void graphRun(mockGraph* g) {
+        std::unique_lock<std::mutex> lock(g->mu);
+        for (;;) {
+                if (g->stop) {
+                        return;
+                }
+
+                if (g->inflight.empty()) {
+                        g->cv.wait(lock);
+                        continue;
+                }
+
+                mockClock::time_point done = g->inflight.front().done;
+                if (mockClock::now() < done) {
+                        g->cv.wait_until(lock, done);
+                        continue;
+                }
+
+                mockInference inf = g->inflight.front();
+                g->inflight.pop_front();
+                g->cv.notify_all();
+                lock.unlock();
+
+                // results wait on the device, stalling the following inferences, until the output FIFO has space for them
+                mockElem elem;
+                inferenceResult(inf.out, inf, elem);
+                fifoPush(inf.out, elem, false);
+                fifoUnref(inf.out);
+
+                lock.lock();
+        }
+}
+
+ncStatus_t ncGraphCreate(const char* name, struct ncGraphHandle_t **graphHandle) {
+        if (name == NULL || graphHandle == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        mockGraph* g = new mockGraph;
+        g->name = std::string(name).substr(0, NC_MAX_NAME_SIZE - 1);
+        g->state = NC_GRAPH_CREATED;
+        g->executors = config().executors;
+        g->device = NULL;
+        g->size = 0;
+        memset(&g->inputDesc, 0, sizeof(g->inputDesc));
+        memset(&g->outputDesc, 0, sizeof(g->outputDesc));
+        g->timeTaken = 0;
+        g->stop = false;
+
+        *graphHandle = new ncGraphHandle_t;
+        (*graphHandle)->private_data = g;
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphAllocate(struct ncDeviceHandle_t *deviceHandle, struct ncGraphHandle_t *graphHandle,
+                const void *graphBuffer, unsigned int graphBufferLength) {
+        mockDevice* d = deviceOf(deviceHandle);
+        mockGraph* g = graphOf(graphHandle);
+        if (d == NULL || g == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (graphBuffer == NULL || graphBufferLength == 0) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        std::lock_guard<std::mutex> devLock(d->mu);
+        if (d->state != NC_DEVICE_OPENED) {
+                return NC_UNAUTHORIZED;
+        }
+        if (d->graphs >= MOCK_MAX_GRAPHS || d->memoryUsed + graphBufferLength > MOCK_MEMORY_SIZE) {
+                return NC_OUT_OF_MEMORY;
+        }
+
+        std::lock_guard<std::mutex> lock(g->mu);
+        if (g->state != NC_GRAPH_CREATED) {
+                return NC_UNAUTHORIZED;
+        }
+
+        const mockConfig& c = config();
+        g->inputDesc = mockTensorDesc(c.input[0], c.input[1], c.input[2], NC_FIFO_FP16);
+        g->outputDesc = mockTensorDesc(c.output[0], c.output[1], c.output[2], NC_FIFO_FP16);
+        g->executorsFree.assign(g->executors, mockClock::now());
+        g->device = d;
+        g->size = graphBufferLength;
+        g->state = NC_GRAPH_ALLOCATED;
+        g->thread = std::thread(graphRun, g);
+        d->memoryUsed += graphBufferLength;
+        d->graphs++;
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphDestroy(struct ncGraphHandle_t **graphHandle) {
+        if (graphHandle == NULL || graphOf(*graphHandle) == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        mockGraph* g = graphOf(*graphHandle);
+        {
+                std::lock_guard<std::mutex> lock(g->mu);
+                g->stop = true;
+                g->cv.notify_all();
+        }
+
+        if (g->thread.joinable()) {
+                g->thread.join();
+        }
+
+        for (size_t i = 0; i < g->inflight.size(); i++) {
+                fifoUnref(g->inflight[i].out);
+        }
+
+        if (g->device != NULL) {
+                std::lock_guard<std::mutex> devLock(g->device->mu);
+                g->device->memoryUsed -= g->size;
+                g->device->graphs--;
+        }
+
+        delete g;
+        delete *graphHandle;
+        *graphHandle = NULL;
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphSetOption(struct ncGraphHandle_t *graphHandle, int option, const void *data, unsigned int dataLength) {
+        mockGraph* g = graphOf(graphHandle);
+        if (g == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (data == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        if (option != NC_RW_GRAPH_EXECUTORS_NUM) {
+                return option >= NC_RO_GRAPH_STATE && option <= NC_RO_GRAPH_TIME_TAKEN_ARRAY_SIZE ? NC_UNAUTHORIZED : NC_INVALID_PARAMETERS;
+        }
+
+        if (dataLength != sizeof(int)) {
+                return NC_INVALID_DATA_LENGTH;
+        }
+
+        int executors = *(const int*) data;
+        if (executors < 1 || executors > MOCK_MAX_EXECUTORS) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        std::lock_guard<std::mutex> lock(g->mu);
+        if (g->state != NC_GRAPH_CREATED) {
+                return NC_UNAUTHORIZED;
+        }
+        g->executors = (unsigned int) executors;
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphGetOption(struct ncGraphHandle_t *graphHandle, int option, void *data, unsigned int *dataLength) {
+        mockGraph* g = graphOf(graphHandle);
+        if (g == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        std::lock_guard<std::mutex> lock(g->mu);
+
+        switch (option) {
+        case NC_RO_GRAPH_STATE:
+                return getIntOption(data, dataLength, g->state);
+        case NC_RO_GRAPH_TIME_TAKEN:
+                return getOption(data, dataLength, &g->timeTaken, sizeof(g->timeTaken));
+        case NC_RO_GRAPH_INPUT_COUNT:
+        case NC_RO_GRAPH_OUTPUT_COUNT:
+                return getIntOption(data, dataLength, 1);
+        case NC_RO_GRAPH_INPUT_TENSOR_DESCRIPTORS:
+                return getOption(data, dataLength, &g->inputDesc, sizeof(g->inputDesc));
+        case NC_RO_GRAPH_OUTPUT_TENSOR_DESCRIPTORS:
+                return getOption(data, dataLength, &g->outputDesc, sizeof(g->outputDesc));
+        case NC_RO_GRAPH_DEBUG_INFO:
+                return getStringOption(data, dataLength, "");
+        case NC_RO_GRAPH_NAME:
+                return getStringOption(data, dataLength, g->name);
+        case NC_RO_GRAPH_OPTION_CLASS_LIMIT:
+                return getIntOption(data, dataLength, 3);
+        case NC_RO_GRAPH_VERSION: {
+                unsigned int version[2] = {2, 0};
+                return getOption(data, dataLength, version, sizeof(version));
+        }
+        case NC_RO_GRAPH_TIME_TAKEN_ARRAY_SIZE:
+                return getIntOption(data, dataLength, sizeof(g->timeTaken));
+        case NC_RW_GRAPH_EXECUTORS_NUM:
+                return getIntOption(data, dataLength, int(g->executors));
+        }
+
+        return NC_INVALID_PARAMETERS;
+}
+
+ncStatus_t ncGraphQueueInference(struct ncGraphHandle_t *graphHandle,
+                struct ncFifoHandle_t** fifoIn, unsigned int inFifoCount,
+                struct ncFifoHandle_t** fifoOut, unsigned int outFifoCount) {
+        mockGraph* g = graphOf(graphHandle);
+        if (g == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        if (fifoIn == NULL || fifoOut == NULL || inFifoCount != 1 || outFifoCount != 1) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        mockFifo* in = fifoOf(fifoIn[0]);
+        mockFifo* out = fifoOf(fifoOut[0]);
+        if (in == NULL || out == NULL) {
+                return NC_INVALID_HANDLE;
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(g->mu);
+                if (g->state != NC_GRAPH_ALLOCATED) {
+                        return NC_NOT_ALLOCATED;
+                }
+        }
+
+        if (g->device->failed.load()) {
+                return NC_ERROR;
+        }
+
+        // the simulated reset fails the inferences in flight and wakes up everyone waiting on the device FIFOs
+        static std::atomic<unsigned int> faultQueued(0);
+        if (g->device->index == 0 && config().fault > 0 && faultQueued.fetch_add(1) + 1 == config().fault) {
+                g->device->failed.store(true);
+                fifoFail(in);
+                fifoFail(out);
+                return NC_ERROR;
+        }
+
+        // the inference holds the output FIFO reference until its result is delivered
+        ncStatus_t s = fifoAcquire(out, NC_FIFO_HOST_RO);
+        if (s != NC_OK) {
+                return s;
+        }
+        if ((s = fifoAcquire(in, NC_FIFO_HOST_WO)) != NC_OK) {
+                fifoUnref(out);
+                return s;
+        }
+        unsigned int inCapacity = in->capacity;
+
+        // the inference consumes the oldest input FIFO element, waiting for one if the FIFO is empty
+        mockElem elem;
+        s = fifoPop(in, elem, false);
+        fifoUnref(in);
+        if (s != NC_OK) {
+                fifoUnref(out);
+                return s;
+        }
+
+        std::unique_lock<std::mutex> lock(g->mu);
+        // inferences in flight are bounded by the graph executors and the input FIFO elements waiting on the device
+        g->cv.wait(lock, [g, inCapacity] { return g->stop || g->inflight.size() < g->executors + inCapacity; });
+        if (g->stop) {
+                lock.unlock();
+                fifoUnref(out);
+                return NC_INVALID_HANDLE;
+        }
+
+        // the inference runs on the executor which becomes free first
+        size_t e = 0;
+        for (size_t i = 1; i < g->executorsFree.size(); i++) {
+                if (g->executorsFree[i] < g->executorsFree[e]) {
+                        e = i;
+                }
+        }
+
+        mockClock::time_point start = std::max(mockClock::now(), g->executorsFree[e]);
+        g->executorsFree[e] = start + config().latency;
+        g->timeTaken = std::chrono::duration<float, std::milli>(config().latency).count();
+
+        mockInference inf;
+        inf.done = g->executorsFree[e];
+        inf.inputHash = tensorHash(elem.data);
+        inf.userParam = elem.userParam;
+        inf.out = out;
+
+        g->inflight.push_back(inf);
+        g->cv.notify_all();
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphQueueInferenceWithFifoElem(struct ncGraphHandle_t *graphHandle,
+                struct ncFifoHandle_t* fifoIn, struct ncFifoHandle_t* fifoOut, const void *inputTensor,
+                unsigned int * inputTensorLength, void *userParam) {
+        ncStatus_t s = ncFifoWriteElem(fifoIn, inputTensor, inputTensorLength, userParam);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        return ncGraphQueueInference(graphHandle, &fifoIn, 1, &fifoOut, 1);
+}
+
+// allocateFifo creates and allocates FIFO of type and dataType with numElem elements of tensor td
+static ncStatus_t allocateFifo(struct ncDeviceHandle_t* deviceHandle, const std::string& name, struct ncTensorDescriptor_t* td,
+                struct ncFifoHandle_t** fifoHandle, ncFifoType_t type, int numElem, ncFifoDataType_t dataType) {
+        if (numElem <= 0) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        ncStatus_t s = ncFifoCreate(name.c_str(), type, fifoHandle);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        int val = dataType;
+        if ((s = ncFifoSetOption(*fifoHandle, NC_RW_FIFO_DATA_TYPE, &val, sizeof(val))) != NC_OK) {
+                ncFifoDestroy(fifoHandle);
+                return s;
+        }
+
+        if ((s = ncFifoAllocate(*fifoHandle, deviceHandle, td, (unsigned int) numElem)) != NC_OK) {
+                ncFifoDestroy(fifoHandle);
+                return s;
+        }
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphAllocateWithFifosEx(struct ncDeviceHandle_t* deviceHandle, struct ncGraphHandle_t* graphHandle,
+                const void *graphBuffer, unsigned int graphBufferLength,
+                struct ncFifoHandle_t ** inFifoHandle, ncFifoType_t inFifoType, int inNumElem, ncFifoDataType_t inDataType,
+                struct ncFifoHandle_t ** outFifoHandle, ncFifoType_t outFifoType, int outNumElem, ncFifoDataType_t outDataType) {
+        if (inFifoHandle == NULL || outFifoHandle == NULL) {
+                return NC_INVALID_PARAMETERS;
+        }
+
+        ncStatus_t s = ncGraphAllocate(deviceHandle, graphHandle, graphBuffer, graphBufferLength);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        mockGraph* g = graphOf(graphHandle);
+        s = allocateFifo(deviceHandle, g->name + "_in", &g->inputDesc, inFifoHandle, inFifoType, inNumElem, inDataType);
+        if (s != NC_OK) {
+                return s;
+        }
+
+        s = allocateFifo(deviceHandle, g->name + "_out", &g->outputDesc, outFifoHandle, outFifoType, outNumElem, outDataType);
+        if (s != NC_OK) {
+                ncFifoDestroy(inFifoHandle);
+                return s;
+        }
+
+        return NC_OK;
+}
+
+ncStatus_t ncGraphAllocateWithFifos(struct ncDeviceHandle_t* deviceHandle, struct ncGraphHandle_t* graphHandle,
+                const void *graphBuffer, unsigned int graphBufferLength,
+                struct ncFifoHandle_t ** inFifoHandle, struct ncFifoHandle_t ** outFifoHandle) {
+        int depth = int(config().fifoDepth);
+
+        return ncGraphAllocateWithFifosEx(deviceHandle, graphHandle, graphBuffer, graphBufferLength,
+                        inFifoHandle, NC_FIFO_HOST_WO, depth, NC_FIFO_FP32,
+                        outFifoHandle, NC_FIFO_HOST_RO, depth, NC_FIFO_FP32);
+}
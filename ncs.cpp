@@ -1,111 +1,3363 @@
 #include "ncs.h"
+#include <math.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-int ncs_DeviceCreate(int idx, void** deviceHandle) {
-    ncStatus_t s = ncDeviceCreate(idx, (struct ncDeviceHandle_t**) deviceHandle);
-    return int(s);
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define NCS_F16C 1
+#elif defined(__aarch64__) || (defined(__ARM_NEON) && defined(__ARM_FP16_FORMAT_IEEE))
+#include <arm_neon.h>
+#define NCS_NEON_FP16 1
+#endif
+
+// tensor pool buffers are aligned to cache line size
+#define TENSOR_POOL_ALIGN 64
+
+// tensorPool is a pool of fixed size tensor buffers carved out of slabs of memory.
+// When the pool runs out of free buffers it allocates another slab of slabCount buffers.
+struct tensorPool {
+        std::mutex mu;
+        unsigned int bufSize;
+        size_t stride;
+        unsigned int slabCount;
+        std::vector<char*> slabs;
+        // buffers are addressed by their slot, i.e. their index across all the slabs
+        std::vector<size_t> freeSlots;
+        // taken marks the slots of the buffers which have been handed out and not returned yet
+        std::vector<bool> taken;
+        // bufs and inUse are updated with mu held and read without it
+        std::atomic<unsigned int> bufs;
+        std::atomic<unsigned int> inUse;
+};
+
+static int tensorPoolGrow(tensorPool* p) {
+        void* slab = NULL;
+        if (posix_memalign(&slab, TENSOR_POOL_ALIGN, p->stride * p->slabCount) != 0) {
+                return int(NC_OUT_OF_MEMORY);
+        }
+
+        size_t first = p->slabs.size() * p->slabCount;
+        p->slabs.push_back((char*) slab);
+        p->taken.resize(first + p->slabCount, false);
+        for (unsigned int i = 0; i < p->slabCount; i++) {
+                p->freeSlots.push_back(first + i);
+        }
+        p->bufs.fetch_add(p->slabCount, std::memory_order_relaxed);
+
+        return int(NC_OK);
 }
 
-int ncs_DeviceOpen(void* deviceHandle) {
-    ncStatus_t s = ncDeviceOpen((struct ncDeviceHandle_t*) deviceHandle);
-    return int(s);
+// tensorPoolSlot returns the slot of pool buffer buf or -1 if buf does not belong to the pool
+static long tensorPoolSlot(tensorPool* p, void* buf) {
+        char* b = (char*) buf;
+        for (size_t i = 0; i < p->slabs.size(); i++) {
+                char* slab = p->slabs[i];
+                if (b >= slab && b < slab + p->stride * p->slabCount && (b - slab) % p->stride == 0) {
+                        return long(i * p->slabCount + (b - slab) / p->stride);
+                }
+        }
+
+        return -1;
 }
 
-int ncs_DeviceGetOption(void* deviceHandle, int option, void *data, unsigned int *dataLength) {
-        ncStatus_t s = ncDeviceGetOption((struct ncDeviceHandle_t*) deviceHandle, option, data, dataLength);
-        return int(s);
+// fp32ToFp16Scalar converts single precision float to half precision float rounding to nearest even
+static inline uint16_t fp32ToFp16Scalar(const char* src) {
+        uint32_t x;
+        memcpy(&x, src, sizeof(x));
+
+        uint32_t sign = (x >> 16) & 0x8000;
+        uint32_t exp = (x >> 23) & 0xff;
+        uint32_t mant = x & 0x7fffff;
+
+        // infinity or NaN
+        if (exp == 0xff) {
+                return uint16_t(sign | 0x7c00 | (mant ? 0x200 | (mant >> 13) : 0));
+        }
+
+        int e = int(exp) - 127 + 15;
+        // overflow
+        if (e >= 0x1f) {
+                return uint16_t(sign | 0x7c00);
+        }
+
+        // subnormal half or underflow
+        if (e <= 0) {
+                if (e < -10) {
+                        return uint16_t(sign);
+                }
+                mant |= 0x800000;
+                int shift = 14 - e;
+                uint32_t half = mant >> shift;
+                uint32_t rem = mant & ((1u << shift) - 1);
+                uint32_t mid = 1u << (shift - 1);
+                if (rem > mid || (rem == mid && (half & 1))) {
+                        half++;
+                }
+                return uint16_t(sign | half);
+        }
+
+        // rounding may carry into exponent which correctly rounds up to infinity
+        uint32_t half = (uint32_t(e) << 10) | (mant >> 13);
+        uint32_t rem = mant & 0x1fff;
+        if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) {
+                half++;
+        }
+
+        return uint16_t(sign | half);
 }
 
-int ncs_DeviceClose(void* deviceHandle) {
-    ncStatus_t s = ncDeviceClose((struct ncDeviceHandle_t*) deviceHandle);
-    return int(s);
+// fp16ToFp32Scalar converts half precision float to single precision float
+static inline float fp16ToFp32Scalar(uint16_t h) {
+        uint32_t sign = uint32_t(h & 0x8000) << 16;
+        uint32_t exp = (h >> 10) & 0x1f;
+        uint32_t mant = h & 0x3ff;
+        uint32_t x;
+
+        if (exp == 0x1f) {
+                // infinity or NaN
+                x = sign | 0x7f800000 | (mant << 13);
+        } else if (exp == 0) {
+                if (mant == 0) {
+                        x = sign;
+                } else {
+                        // subnormal half is a normal float
+                        int e = -1;
+                        do {
+                                e++;
+                                mant <<= 1;
+                        } while (!(mant & 0x400));
+                        x = sign | (uint32_t(127 - 15 - e) << 23) | ((mant & 0x3ff) << 13);
+                }
+        } else {
+                x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+        }
+
+        float f;
+        memcpy(&f, &x, sizeof(f));
+
+        return f;
 }
 
-int ncs_DeviceDestroy(void** deviceHandle) {
-    ncStatus_t s = ncDeviceDestroy((struct ncDeviceHandle_t**) deviceHandle);
-    return int(s);
+#if defined(NCS_F16C)
+// hasF16C checks if both CPU and OS support AVX and F16C instructions
+static bool hasF16C() {
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+                return false;
+        }
+
+        if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX) || !(ecx & bit_F16C)) {
+                return false;
+        }
+
+        unsigned int xcr0, xcr0hi;
+        __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(xcr0hi) : "c"(0));
+
+        // OS saves both XMM and YMM registers
+        return (xcr0 & 0x6) == 0x6;
 }
 
-int ncs_GraphCreate(const char* name, void** graphHandle) {
-        ncStatus_t s = ncGraphCreate(name, (struct ncGraphHandle_t**) graphHandle);
-        return int(s);
+__attribute__((target("avx,f16c")))
+static size_t fp32ToFp16Vec(const char* src, uint16_t* dst, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+                __m256 v = _mm256_loadu_ps((const float*) (src + i * sizeof(float)));
+                _mm_storeu_si128((__m128i*) (dst + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+        }
+
+        return i;
 }
 
-int ncs_GraphAllocate(void* deviceHandle, void* graphHandle, const void *graphBuffer, unsigned int graphBufferLength) {
-        ncStatus_t s = ncGraphAllocate((struct ncDeviceHandle_t*) deviceHandle, (struct ncGraphHandle_t*) graphHandle,
-                        graphBuffer, graphBufferLength);
-        return int(s);
+__attribute__((target("avx,f16c")))
+static size_t fp16ToFp32Vec(const uint16_t* src, char* dst, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+                __m256 v = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (src + i)));
+                _mm256_storeu_ps((float*) (dst + i * sizeof(float)), v);
+        }
+
+        return i;
 }
+#elif defined(NCS_NEON_FP16)
+static size_t fp32ToFp16Vec(const char* src, uint16_t* dst, size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+                float32x4_t v = vld1q_f32((const float*) (src + i * sizeof(float)));
+                vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+        }
 
-int ncs_GraphAllocateWithFifos(void* deviceHandle, void* graphHandle, const void *graphBuffer, unsigned int graphBufferLength, void** inFifoHandle, void** outFifoHandle) {
-        int s = ncs_GraphAllocateWithFifosEx(deviceHandle,
-                        graphHandle, graphBuffer, graphBufferLength,
-                        inFifoHandle, NC_FIFO_HOST_WO, 2, NC_FIFO_FP32,
-                        outFifoHandle, NC_FIFO_HOST_RO, 2, NC_FIFO_FP32);
+        return i;
+}
 
-        return int(s);
+static size_t fp16ToFp32Vec(const uint16_t* src, char* dst, size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+                float32x4_t v = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i)));
+                vst1q_f32((float*) (dst + i * sizeof(float)), v);
+        }
+
+        return i;
 }
+#endif
 
+#if defined(NCS_F16C)
+static const bool f16c = hasF16C();
+#endif
 
-int ncs_GraphAllocateWithFifosEx(void* deviceHandle, void* graphHandle, const void *graphBuffer, unsigned int graphBufferLength, void** inFifoHandle, ncFifoType_t inFifoType, int inNumElem, ncFifoDataType_t inDataType, void** outFifoHandle,  ncFifoType_t outFifoType, int outNumElem, ncFifoDataType_t outDataType) {
-        ncStatus_t s = ncGraphAllocateWithFifosEx((struct ncDeviceHandle_t*) deviceHandle,
-                        (struct ncGraphHandle_t*) graphHandle, graphBuffer, graphBufferLength,
-                        (struct ncFifoHandle_t**) inFifoHandle, inFifoType, inNumElem, inDataType,
-                        (struct ncFifoHandle_t**) outFifoHandle, outFifoType, outNumElem, outDataType);
-        return int(s);
+// fp32ToFp16 converts count single precision floats stored in src to half precision floats stored in dst.
+// It uses F16C instructions on x86 CPUs which support them and NEON on ARM.
+static void fp32ToFp16(const void* src, uint16_t* dst, size_t count) {
+        const char* s = (const char*) src;
+        size_t i = 0;
+
+#if defined(NCS_F16C)
+        if (f16c) {
+                i = fp32ToFp16Vec(s, dst, count);
+        }
+#elif defined(NCS_NEON_FP16)
+        i = fp32ToFp16Vec(s, dst, count);
+#endif
+
+        for (; i < count; i++) {
+                dst[i] = fp32ToFp16Scalar(s + i * sizeof(float));
+        }
 }
 
-int ncs_GraphQueueInference(void* graphHandle, void** inFifoHandle, unsigned int inFifoCount, void** outFifoHandle, unsigned int outFifoCount) {
-        ncStatus_t s = ncGraphQueueInference((struct ncGraphHandle_t*) graphHandle,
-                        (struct ncFifoHandle_t**) inFifoHandle, inFifoCount,
-                        (struct ncFifoHandle_t**) outFifoHandle, outFifoCount);
-        return int(s);
+// fp16ToFp32 converts count half precision floats stored in src to single precision floats stored in dst.
+// It uses F16C instructions on x86 CPUs which support them and NEON on ARM.
+static void fp16ToFp32(const void* src, void* dst, size_t count) {
+        const uint16_t* s = (const uint16_t*) src;
+        char* d = (char*) dst;
+        size_t i = 0;
+
+#if defined(NCS_F16C)
+        if (f16c) {
+                i = fp16ToFp32Vec(s, d, count);
+        }
+#elif defined(NCS_NEON_FP16)
+        i = fp16ToFp32Vec(s, d, count);
+#endif
+
+        for (; i < count; i++) {
+                uint16_t h;
+                memcpy(&h, s + i, sizeof(h));
+                float f = fp16ToFp32Scalar(h);
+                memcpy(d + i * sizeof(float), &f, sizeof(f));
+        }
+}
+
+// fp16Scratch holds FP16 data converted from FP32 before it's written to FIFO.
+// It is kept per thread and only grows, so fused conversions do not allocate once it's large enough.
+static thread_local std::vector<uint16_t> fp16Scratch;
+
+// fp16FromFp32 converts FP32 tensor of tensorLength bytes into fp16Scratch and returns it
+static uint16_t* fp16FromFp32(const void* tensor, unsigned int tensorLength) {
+        size_t count = tensorLength / sizeof(float);
+        if (fp16Scratch.size() < count) {
+                fp16Scratch.resize(count);
+        }
+        fp32ToFp16(tensor, fp16Scratch.data(), count);
+
+        return fp16Scratch.data();
+}
+
+// tensorDescSize returns the number of bytes spanned by tensor described by td
+static size_t tensorDescSize(const struct ncTensorDescriptor_t* td) {
+        size_t valSize = td->dataType == NC_FIFO_FP16 ? sizeof(uint16_t) : sizeof(float);
+
+        return size_t(td->h - 1) * td->hStride + size_t(td->w - 1) * td->wStride + size_t(td->c - 1) * td->cStride + valSize;
+}
+
+// preprocessScratch holds per thread buffers used by image preprocessing
+struct preprocessScratch {
+        std::vector<int> xofs;
+        std::vector<float> xweight;
+        std::vector<float> row;
+        std::vector<char> tensor;
+};
+
+static thread_local preprocessScratch preprocessBufs;
+
+// bilinearTap returns the first of the two source values output value i is interpolated from when n source values are resized by scale
+// and stores the weight of the second one in weight
+static inline int bilinearTap(unsigned int i, float scale, unsigned int n, float* weight) {
+        float f = (i + 0.5f) * scale - 0.5f;
+        int i0 = f < 0 ? 0 : int(f);
+        float w = f < 0 ? 0 : f - i0;
+        if (i0 >= int(n) - 1) {
+                i0 = n - 1;
+                w = 0;
+        }
+        *weight = w;
+
+        return i0;
+}
+
+// preprocessBGR resizes BGR8 image to the size of tensor described by td using bilinear interpolation,
+// applies per channel mean and scale and stores the result in the layout and data type given by td.
+// Every output row is computed in a single pass over the two source rows it's interpolated from.
+static int preprocessBGR(const uint8_t* src, unsigned int width, unsigned int height, unsigned int stride,
+                const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* td, char* dst, size_t dstLen) {
+        if (width == 0 || height == 0 || stride < width * 3 || td->c != 3 || td->w == 0 || td->h == 0) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        if (dstLen < tensorDescSize(td)) {
+                return int(NC_INVALID_DATA_LENGTH);
+        }
+
+        preprocessScratch& b = preprocessBufs;
+        unsigned int dw = td->w, dh = td->h;
+        b.xofs.resize(dw * 2);
+        b.xweight.resize(dw);
+        b.row.resize(dw * 3);
+
+        // source columns and weights are the same for every output row
+        float sx = float(width) / dw, sy = float(height) / dh;
+        for (unsigned int x = 0; x < dw; x++) {
+                float a;
+                int x0 = bilinearTap(x, sx, width, &a);
+                b.xofs[2 * x] = x0 * 3;
+                b.xofs[2 * x + 1] = (x0 + (a > 0 ? 1 : 0)) * 3;
+                b.xweight[x] = a;
+        }
+
+        // output channel oc is computed from input channel order[oc]
+        int order[3] = {0, 1, 2};
+        if (opts->swapRB) {
+                order[0] = 2;
+                order[2] = 0;
+        }
+
+        bool fp16 = td->dataType == NC_FIFO_FP16;
+        size_t valSize = fp16 ? sizeof(uint16_t) : sizeof(float);
+        bool dense = td->cStride == valSize && td->wStride == 3 * valSize;
+
+        for (unsigned int y = 0; y < dh; y++) {
+                float wy;
+                int y0 = bilinearTap(y, sy, height, &wy);
+                const uint8_t* r0 = src + size_t(y0) * stride;
+                const uint8_t* r1 = wy > 0 ? r0 + stride : r0;
+
+                float* row = b.row.data();
+                for (unsigned int x = 0; x < dw; x++) {
+                        const int o0 = b.xofs[2 * x], o1 = b.xofs[2 * x + 1];
+                        const float wx = b.xweight[x];
+                        for (int oc = 0; oc < 3; oc++) {
+                                int c = order[oc];
+                                float top = r0[o0 + c] + wx * (r0[o1 + c] - r0[o0 + c]);
+                                float bottom = r1[o0 + c] + wx * (r1[o1 + c] - r1[o0 + c]);
+                                float v = top + wy * (bottom - top);
+                                row[3 * x + oc] = (v - opts->mean[c]) * opts->scale[c];
+                        }
+                }
+
+                char* out = dst + size_t(y) * td->hStride;
+                if (dense) {
+                        if (fp16) {
+                                fp32ToFp16(row, (uint16_t*) out, dw * 3);
+                        } else {
+                                memcpy(out, row, dw * 3 * sizeof(float));
+                        }
+                        continue;
+                }
+
+                for (unsigned int x = 0; x < dw; x++) {
+                        for (int oc = 0; oc < 3; oc++) {
+                                char* val = out + size_t(x) * td->wStride + size_t(oc) * td->cStride;
+                                if (fp16) {
+                                        uint16_t h = fp32ToFp16Scalar((const char*) &row[3 * x + oc]);
+                                        memcpy(val, &h, sizeof(h));
+                                } else {
+                                        memcpy(val, &row[3 * x + oc], sizeof(float));
+                                }
+                        }
+                }
+        }
+
+        return int(NC_OK);
+}
+
+// preprocessTensorBGR preprocesses image into per thread tensor buffer and returns it
+static int preprocessTensorBGR(const void* image, unsigned int width, unsigned int height, unsigned int stride,
+                const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* td, char** tensor) {
+        std::vector<char>& buf = preprocessBufs.tensor;
+        if (buf.size() < td->totalSize) {
+                buf.resize(td->totalSize);
+        }
+
+        *tensor = buf.data();
+
+        return preprocessBGR((const uint8_t*) image, width, height, stride, opts, td, buf.data(), td->totalSize);
+}
+
+// SSD output contains the number of detections followed by detections of 7 values each:
+// image id, class id, confidence and left, top, right and bottom box coordinates.
+// The first detection starts at the offset of a single detection.
+#define SSD_DETECTION_SIZE 7
+
+// loadTensorVals loads count tensor values starting at offset off as single precision floats
+static void loadTensorVals(const char* data, bool fp16, size_t off, size_t count, float* vals) {
+        if (fp16) {
+                fp16ToFp32(data + off * sizeof(uint16_t), vals, count);
+                return;
+        }
+        memcpy(vals, data + off * sizeof(float), count * sizeof(float));
+}
+
+// ssdLoadDetectionScalar loads SSD detection values and returns true if all of them are finite
+static bool ssdLoadDetectionScalar(const char* data, bool fp16, size_t off, float* vals) {
+        loadTensorVals(data, fp16, off, SSD_DETECTION_SIZE, vals);
+
+        for (int i = 0; i < SSD_DETECTION_SIZE; i++) {
+                uint32_t x;
+                memcpy(&x, &vals[i], sizeof(x));
+                if ((x & 0x7f800000) == 0x7f800000) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+#if defined(NCS_F16C)
+// ssdLoadDetectionVec loads SSD detection values and returns true if all of them are finite.
+// It loads 8 values, so there must be at least one more value after the detection.
+__attribute__((target("avx,f16c")))
+static bool ssdLoadDetectionVec(const char* data, bool fp16, size_t off, float* vals) {
+        __m256 v;
+        if (fp16) {
+                v = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (data + off * sizeof(uint16_t))));
+        } else {
+                v = _mm256_loadu_ps((const float*) (data + off * sizeof(float)));
+        }
+        _mm256_storeu_ps(vals, v);
+
+        // x - x is 0 for finite x and NaN otherwise
+        __m256 finite = _mm256_cmp_ps(_mm256_sub_ps(v, v), _mm256_setzero_ps(), _CMP_EQ_OQ);
+
+        return (_mm256_movemask_ps(finite) & 0x7f) == 0x7f;
+}
+#endif
+
+static inline float clampUnit(float v) {
+        return v < 0 ? 0 : (v > 1 ? 1 : v);
+}
+
+// decodeSSD decodes detections with confidence of at least minConfidence from SSD output tensor.
+// It returns the number of decoded detections or negative status code.
+static int decodeSSD(const void* data, size_t dataLen, ncFifoDataType_t dataType, float minConfidence,
+                ncs_Detection* detections, unsigned int maxDetections) {
+        const char* d = (const char*) data;
+        bool fp16 = dataType == NC_FIFO_FP16;
+        size_t count = dataLen / (fp16 ? sizeof(uint16_t) : sizeof(float));
+        if (count < SSD_DETECTION_SIZE) {
+                return int(NC_INVALID_DATA_LENGTH);
+        }
+
+        float header;
+        loadTensorVals(d, fp16, 0, 1, &header);
+        if (!(header > 0)) {
+                return 0;
+        }
+
+        size_t boxes = count / SSD_DETECTION_SIZE - 1;
+        if (header < boxes) {
+                boxes = size_t(header);
+        }
+
+        unsigned int n = 0;
+        float vals[SSD_DETECTION_SIZE + 1];
+        for (size_t i = 0; i < boxes && n < maxDetections; i++) {
+                size_t off = (i + 1) * SSD_DETECTION_SIZE;
+
+                bool finite;
+#if defined(NCS_F16C)
+                if (f16c && off + SSD_DETECTION_SIZE < count) {
+                        finite = ssdLoadDetectionVec(d, fp16, off, vals);
+                } else {
+                        finite = ssdLoadDetectionScalar(d, fp16, off, vals);
+                }
+#else
+                finite = ssdLoadDetectionScalar(d, fp16, off, vals);
+#endif
+                if (!finite || vals[2] < minConfidence || vals[1] < 0) {
+                        continue;
+                }
+
+                ncs_Detection* det = &detections[n++];
+                det->classID = int(vals[1]);
+                det->confidence = vals[2];
+                det->left = clampUnit(vals[3]);
+                det->top = clampUnit(vals[4]);
+                det->right = clampUnit(vals[5]);
+                det->bottom = clampUnit(vals[6]);
+        }
+
+        return int(n);
+}
+
+// TOPK_CHUNK is the number of tensor values loaded at once during top-K selection
+#define TOPK_CHUNK 256
+
+// topKInsert inserts value v at index i into predictions sorted by probability in descending order
+static inline void topKInsert(ncs_Prediction* preds, unsigned int* n, unsigned int k, int i, float v) {
+        unsigned int j = *n < k ? (*n)++ : k - 1;
+        while (j > 0 && preds[j-1].probability < v) {
+                preds[j] = preds[j-1];
+                j--;
+        }
+        preds[j].classID = i;
+        preds[j].probability = v;
+}
+
+// topKScan scans count values and updates top-K predictions; base is the class id of the first value
+static inline void topKScan(const float* vals, size_t count, int base, ncs_Prediction* preds, unsigned int* n, unsigned int k) {
+        for (size_t i = 0; i < count; i++) {
+                float v = vals[i];
+                // NaN never passes either comparison
+                if (*n == k && !(v > preds[k-1].probability)) {
+                        continue;
+                }
+                if (v != v) {
+                        continue;
+                }
+                topKInsert(preds, n, k, base + int(i), v);
+        }
+}
+
+// topK selects k predictions with the highest probability using partial selection.
+// It returns the number of selected predictions or negative status code.
+static int topK(const void* data, size_t dataLen, ncFifoDataType_t dataType, unsigned int k, ncs_Prediction* preds) {
+        bool fp16 = dataType == NC_FIFO_FP16;
+        size_t count = dataLen / (fp16 ? sizeof(uint16_t) : sizeof(float));
+        if (count == 0) {
+                return int(NC_INVALID_DATA_LENGTH);
+        }
+
+        unsigned int n = 0;
+        if (k == 0) {
+                return 0;
+        }
+
+        float vals[TOPK_CHUNK];
+        for (size_t off = 0; off < count; off += TOPK_CHUNK) {
+                size_t c = count - off < TOPK_CHUNK ? count - off : TOPK_CHUNK;
+                loadTensorVals((const char*) data, fp16, off, c, vals);
+                topKScan(vals, c, int(off), preds, &n, k);
+        }
+
+        return int(n);
+}
+
+// Latency histograms are HDR style log-linear histograms of nanosecond values.
+// Every power of two range is split into HIST_SUB sub-buckets, so the relative bucket error is at most 1/HIST_SUB.
+#define HIST_SUB_BITS 4
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+// histogram is a lock-free latency histogram
+struct histogram {
+        std::atomic<uint64_t> counts[HIST_BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> min;
+        std::atomic<uint64_t> max;
+};
+
+static inline int histBucket(uint64_t v) {
+        if (v < HIST_SUB) {
+                return int(v);
+        }
+        int e = 63 - __builtin_clzll(v);
+
+        return (e - HIST_SUB_BITS + 1) * HIST_SUB + int((v >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+// histBucketValue returns the value in the middle of histogram bucket
+static inline uint64_t histBucketValue(int b) {
+        if (b < HIST_SUB) {
+                return uint64_t(b);
+        }
+        int e = b / HIST_SUB + HIST_SUB_BITS - 1;
+        uint64_t width = uint64_t(1) << (e - HIST_SUB_BITS);
+
+        return (uint64_t(HIST_SUB + b % HIST_SUB) << (e - HIST_SUB_BITS)) + width / 2;
+}
+
+static void histInit(histogram* h) {
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+                h->counts[i].store(0, std::memory_order_relaxed);
+        }
+        h->count.store(0, std::memory_order_relaxed);
+        h->sum.store(0, std::memory_order_relaxed);
+        h->min.store(UINT64_MAX, std::memory_order_relaxed);
+        h->max.store(0, std::memory_order_relaxed);
+}
+
+static void histRecord(histogram* h, uint64_t v) {
+        h->counts[histBucket(v)].fetch_add(1, std::memory_order_relaxed);
+        h->count.fetch_add(1, std::memory_order_relaxed);
+        h->sum.fetch_add(v, std::memory_order_relaxed);
+
+        uint64_t min = h->min.load(std::memory_order_relaxed);
+        while (v < min && !h->min.compare_exchange_weak(min, v, std::memory_order_relaxed)) {
+        }
+        uint64_t max = h->max.load(std::memory_order_relaxed);
+        while (v > max && !h->max.compare_exchange_weak(max, v, std::memory_order_relaxed)) {
+        }
+}
+
+// histSnapshot summarizes histogram h into s; it reads the counters without stopping the writers
+static void histSnapshot(histogram* h, ncs_LatencyStats* s) {
+        static const double quantiles[4] = {0.5, 0.9, 0.99, 0.999};
+        unsigned long long* values[4] = {&s->p50, &s->p90, &s->p99, &s->p999};
+
+        memset(s, 0, sizeof(*s));
+
+        uint64_t counts[HIST_BUCKETS];
+        uint64_t total = 0;
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+                counts[i] = h->counts[i].load(std::memory_order_relaxed);
+                total += counts[i];
+        }
+        if (total == 0) {
+                return;
+        }
+
+        s->count = total;
+        s->sum = h->sum.load(std::memory_order_relaxed);
+        s->min = h->min.load(std::memory_order_relaxed);
+        s->max = h->max.load(std::memory_order_relaxed);
+
+        int q = 0;
+        uint64_t seen = 0;
+        for (int i = 0; i < HIST_BUCKETS && q < 4; i++) {
+                seen += counts[i];
+                while (q < 4 && seen > 0 && double(seen) >= quantiles[q] * double(total)) {
+                        uint64_t v = histBucketValue(i);
+                        *values[q++] = v < s->min ? s->min : (v > s->max ? s->max : v);
+                }
+        }
+}
+
+// histBuckets fills count cumulative bucket counts of values up to bounds into buckets along with the totals of histogram h.
+// Buckets straddling a bound are counted in full, so the counts are accurate to within the bucket error.
+// It reads the counters without stopping the writers; the totals are summed from the same reads, so the counts never exceed them.
+static void histBuckets(histogram* h, const unsigned long long* bounds, unsigned int count,
+                unsigned long long* buckets, ncs_HistogramTotals* totals) {
+        uint64_t total = 0;
+        unsigned int i = 0;
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+                for (; i < count && histBucket(bounds[i]) < b; i++) {
+                        buckets[i] = total;
+                }
+                total += h->counts[b].load(std::memory_order_relaxed);
+        }
+        for (; i < count; i++) {
+                buckets[i] = total;
+        }
+
+        totals->count = total;
+        totals->sum = total > 0 ? h->sum.load(std::memory_order_relaxed) : 0;
+}
+
+static inline uint64_t monotonicNow() {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// stats stages; see ncs_Stats
+enum {
+        STATS_QUEUE,
+        STATS_DEVICE,
+        STATS_READ,
+        STATS_TOTAL,
+        STATS_STAGES,
+};
+
+// resourceStats collects latency histograms of a graph or a device.
+// Graph stats also record into the stats of the device the graph is allocated on.
+// Device stats also pace the inferences queued on the device when its monitor throttles them.
+struct resourceStats {
+        std::atomic<int> refs;
+        uint64_t created;
+        histogram hists[STATS_STAGES];
+        resourceStats* device;
+        // paceInterval is the minimum interval between inferences queued on the device in nanoseconds; 0 means no pacing
+        std::atomic<uint64_t> paceInterval;
+        // paceNext is the earliest time the next inference can be queued at
+        std::atomic<uint64_t> paceNext;
+};
+
+static void resourceStatsUnref(resourceStats* rs) {
+        if (rs != NULL && rs->refs.fetch_sub(1) == 1) {
+                resourceStatsUnref(rs->device);
+                delete rs;
+        }
+}
+
+static void resourceStatsRecord(resourceStats* rs, int stage, uint64_t v) {
+        for (; rs != NULL; rs = rs->device) {
+                histRecord(&rs->hists[stage], v);
+        }
+}
+
+// STATS_RING_SIZE is the maximum number of timed inferences in flight per output FIFO.
+// Inferences in flight are bounded by device FIFO capacities which are far smaller.
+#define STATS_RING_SIZE 1024
+
+// fifoStats times the inferences flowing through a FIFO.
+// Input FIFOs remember when the pending element write started; output FIFOs keep queue timestamps
+// of the inferences in flight in queue order which is the order their results are read in.
+// Inferences are queued and read from many threads, so the ring is guarded by ringMu; head and tail are atomic so the inflight count is read without it.
+struct fifoStats {
+        // graphHandle is the handle of the graph which queued the last inference into the output FIFO; the graph stats are looked up by it
+        std::atomic<void*> graphHandle;
+        std::atomic<uint64_t> writeStart;
+        std::mutex ringMu;
+        uint64_t queueStart[STATS_RING_SIZE];
+        uint64_t queueEnd[STATS_RING_SIZE];
+        std::atomic<unsigned long> head;
+        std::atomic<unsigned long> tail;
+};
+
+// STATS_TABLE_SIZE is the maximum number of resources instrumented at the same time
+#define STATS_TABLE_SIZE 1024
+#define STATS_TOMBSTONE ((void*) 1)
+
+// statsTable maps NCS handles to their stats.
+// Lookups are lock-free; registrations are rare and serialized by statsTableMu.
+// Every lookup holds the slot it found the stats in through statsRef, so unregistration waits for the lookups in progress before freeing the stats.
+struct statsTable {
+        std::atomic<void*> keys[STATS_TABLE_SIZE];
+        std::atomic<void*> vals[STATS_TABLE_SIZE];
+        // refs is the number of lookups holding the slot
+        std::atomic<unsigned int> refs[STATS_TABLE_SIZE];
+};
+
+static statsTable resourceStatsTable;
+static statsTable fifoStatsTable;
+static std::mutex statsTableMu;
+
+static inline size_t statsHash(void* key) {
+        uint64_t x = uint64_t(uintptr_t(key));
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+
+        return size_t(x & (STATS_TABLE_SIZE - 1));
+}
+
+// statsFind returns the slot of key in t or -1 if t does not contain key
+static long statsFind(statsTable* t, void* key) {
+        if (key == NULL) {
+                return -1;
+        }
+
+        size_t i = statsHash(key);
+        for (int n = 0; n < STATS_TABLE_SIZE; n++, i = (i + 1) & (STATS_TABLE_SIZE - 1)) {
+                void* k = t->keys[i].load(std::memory_order_acquire);
+                if (k == key) {
+                        return long(i);
+                }
+                if (k == NULL) {
+                        return -1;
+                }
+        }
+
+        return -1;
+}
+
+// statsLookup returns the value of key in t; statsTableMu must be held so the value is not freed while it's used
+static void* statsLookup(statsTable* t, void* key) {
+        long i = statsFind(t, key);
+        return i < 0 ? NULL : t->vals[i].load(std::memory_order_acquire);
+}
+
+// statsRef looks up the value of key in t without locking and keeps it from being freed until the reference goes out of scope.
+// The slot is referenced before its key is checked again, so statsRemove either sees the reference or the lookup sees the key gone.
+struct statsRef {
+        statsTable* t;
+        long slot;
+        void* val;
+
+        statsRef(statsTable* table, void* key) : t(table), slot(statsFind(table, key)), val(NULL) {
+                if (slot < 0) {
+                        return;
+                }
+
+                t->refs[slot].fetch_add(1, std::memory_order_seq_cst);
+                if (t->keys[slot].load(std::memory_order_seq_cst) != key) {
+                        t->refs[slot].fetch_sub(1, std::memory_order_release);
+                        slot = -1;
+                        return;
+                }
+                val = t->vals[slot].load(std::memory_order_acquire);
+        }
+
+        ~statsRef() {
+                if (slot >= 0) {
+                        t->refs[slot].fetch_sub(1, std::memory_order_release);
+                }
+        }
+
+        statsRef(const statsRef&) = delete;
+        statsRef& operator=(const statsRef&) = delete;
+};
+
+// statsInsert inserts val into t reusing the first tombstone on the probe path; statsTableMu must be held
+static bool statsInsert(statsTable* t, void* key, void* val) {
+        size_t i = statsHash(key);
+        for (int n = 0; n < STATS_TABLE_SIZE; n++, i = (i + 1) & (STATS_TABLE_SIZE - 1)) {
+                void* k = t->keys[i].load(std::memory_order_relaxed);
+                if (k == NULL || k == STATS_TOMBSTONE) {
+                        t->vals[i].store(val, std::memory_order_release);
+                        t->keys[i].store(key, std::memory_order_release);
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+// statsReclaim turns the run of tombstones ending at slot i back into empty slots if the slot after it is empty,
+// as no probe path goes through them anymore; statsTableMu must be held
+static void statsReclaim(statsTable* t, size_t i) {
+        if (t->keys[(i + 1) & (STATS_TABLE_SIZE - 1)].load(std::memory_order_relaxed) != NULL) {
+                return;
+        }
+
+        for (int n = 0; n < STATS_TABLE_SIZE && t->keys[i].load(std::memory_order_relaxed) == STATS_TOMBSTONE; n++) {
+                t->keys[i].store(NULL, std::memory_order_release);
+                i = (i - 1) & (STATS_TABLE_SIZE - 1);
+        }
+}
+
+// statsRemove removes key from t and returns its value once no lookup holds it anymore; statsTableMu must be held
+static void* statsRemove(statsTable* t, void* key) {
+        long i = statsFind(t, key);
+        if (i < 0) {
+                return NULL;
+        }
+
+        t->keys[i].store(STATS_TOMBSTONE, std::memory_order_seq_cst);
+        // lookups hold their slots only while they record a single call
+        while (t->refs[i].load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+        }
+        void* val = t->vals[i].exchange(NULL, std::memory_order_acq_rel);
+        statsReclaim(t, size_t(i));
+
+        return val;
+}
+
+// statsWrite marks the start of an element write into FIFO
+static inline void statsWrite(void* fifoHandle, uint64_t start) {
+        statsRef ref(&fifoStatsTable, fifoHandle);
+        fifoStats* fs = (fifoStats*) ref.val;
+        if (fs == NULL) {
+                return;
+        }
+
+        // the earliest pending write is timed
+        uint64_t pending = 0;
+        fs->writeStart.compare_exchange_strong(pending, start, std::memory_order_relaxed);
+}
+
+// statsRemoveElem forgets the start of the pending element write into FIFO once the element has been removed, so it doesn't inflate the queue time of the next inference
+static inline void statsRemoveElem(void* fifoHandle) {
+        statsRef ref(&fifoStatsTable, fifoHandle);
+        fifoStats* fs = (fifoStats*) ref.val;
+        if (fs == NULL) {
+                return;
+        }
+
+        fs->writeStart.store(0, std::memory_order_relaxed);
+}
+
+// statsQueued records an inference queued by graph from input to output FIFO which started at start.
+// If the input FIFO element was written separately, the queue time is measured from the start of the write.
+static void statsQueued(void* graphHandle, void* inFifoHandle, void* outFifoHandle, uint64_t start) {
+        uint64_t end = monotonicNow();
+
+        {
+                statsRef inRef(&fifoStatsTable, inFifoHandle);
+                fifoStats* in = (fifoStats*) inRef.val;
+                if (in != NULL) {
+                        uint64_t written = in->writeStart.exchange(0, std::memory_order_relaxed);
+                        if (written != 0 && written < start) {
+                                start = written;
+                        }
+                }
+        }
+
+        statsRef rsRef(&resourceStatsTable, graphHandle);
+        resourceStats* rs = (resourceStats*) rsRef.val;
+        if (rs == NULL) {
+                return;
+        }
+        resourceStatsRecord(rs, STATS_QUEUE, end - start);
+
+        statsRef outRef(&fifoStatsTable, outFifoHandle);
+        fifoStats* out = (fifoStats*) outRef.val;
+        if (out == NULL) {
+                return;
+        }
+        out->graphHandle.store(graphHandle, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(out->ringMu);
+        unsigned long tail = out->tail.load(std::memory_order_relaxed);
+        if (tail - out->head.load(std::memory_order_relaxed) >= STATS_RING_SIZE) {
+                return;
+        }
+        out->queueStart[tail % STATS_RING_SIZE] = start;
+        out->queueEnd[tail % STATS_RING_SIZE] = end;
+        out->tail.store(tail + 1, std::memory_order_release);
+}
+
+// statsRead records reading an inference result from output FIFO which started at start
+static void statsRead(void* fifoHandle, uint64_t start) {
+        uint64_t end = monotonicNow();
+
+        statsRef fsRef(&fifoStatsTable, fifoHandle);
+        fifoStats* fs = (fifoStats*) fsRef.val;
+        if (fs == NULL) {
+                return;
+        }
+
+        statsRef rsRef(&resourceStatsTable, fs->graphHandle.load(std::memory_order_acquire));
+        resourceStats* rs = (resourceStats*) rsRef.val;
+        if (rs == NULL) {
+                return;
+        }
+        resourceStatsRecord(rs, STATS_READ, end - start);
+
+        uint64_t queueStart, queueEnd;
+        {
+                std::lock_guard<std::mutex> lock(fs->ringMu);
+                unsigned long head = fs->head.load(std::memory_order_relaxed);
+                if (head == fs->tail.load(std::memory_order_relaxed)) {
+                        return;
+                }
+                queueStart = fs->queueStart[head % STATS_RING_SIZE];
+                queueEnd = fs->queueEnd[head % STATS_RING_SIZE];
+                fs->head.store(head + 1, std::memory_order_release);
+        }
+
+        resourceStatsRecord(rs, STATS_DEVICE, end - queueEnd);
+        resourceStatsRecord(rs, STATS_TOTAL, end - queueStart);
+}
+
+// callCount is a shim call counter padded to a cache line, so counting calls of different classes does not contend
+struct alignas(64) callCount {
+        std::atomic<uint64_t> n;
+};
+
+static callCount callCounts[NCS_CALL_CLASSES];
+
+static inline void countCall(int call) {
+        callCounts[call].n.fetch_add(1, std::memory_order_relaxed);
+}
+
+// writeElem writes FIFO element which started to be prepared at start and times it
+static ncStatus_t writeElem(uint64_t start, void* fifoHandle, const void* tensor, unsigned int* tensorLength, void* userParam) {
+        ncStatus_t s = ncFifoWriteElem((struct ncFifoHandle_t*) fifoHandle, tensor, tensorLength, userParam);
+        if (s == NC_OK) {
+                statsWrite(fifoHandle, start);
+        }
+
+        return s;
+}
+
+// pace delays queueing inference by graph until the device the graph is allocated on can take the next inference.
+// Every inference reserves its slot up front, so concurrent submissions are spread paceInterval apart.
+static void pace(void* graphHandle) {
+        uint64_t now = monotonicNow(), slot;
+        {
+                statsRef ref(&resourceStatsTable, graphHandle);
+                resourceStats* rs = (resourceStats*) ref.val;
+                if (rs == NULL || rs->device == NULL) {
+                        return;
+                }
+
+                resourceStats* d = rs->device;
+                uint64_t interval = d->paceInterval.load(std::memory_order_relaxed);
+                if (interval == 0) {
+                        return;
+                }
+
+                // the stats are released before sleeping, so unregistering them never waits for the pacing
+                uint64_t next = d->paceNext.load(std::memory_order_relaxed);
+                do {
+                        slot = next > now ? next : now;
+                } while (!d->paceNext.compare_exchange_weak(next, slot + interval, std::memory_order_relaxed));
+        }
+
+        if (slot > now) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(slot - now));
+        }
 }
 
-int ncs_GraphQueueInferenceWithFifoElem(void* graphHandle, void* inFifoHandle, void* outFifoHandle, const void* inputTensor, unsigned int* inputTensorLength, void* userParam) {
+// queueInference queues inference which started to be prepared at start and times it
+static void readerQueued(void* fifoHandle);
+
+static ncStatus_t queueInference(uint64_t start, void* graphHandle, void* inFifoHandle, void* outFifoHandle,
+                const void* tensor, unsigned int* tensorLength, void* userParam) {
+        pace(graphHandle);
+
         ncStatus_t s = ncGraphQueueInferenceWithFifoElem((struct ncGraphHandle_t*) graphHandle,
                         (struct ncFifoHandle_t*) inFifoHandle,
                         (struct ncFifoHandle_t*) outFifoHandle,
-                        inputTensor, inputTensorLength, userParam);
-        return int(s);
+                        tensor, tensorLength, userParam);
+        if (s == NC_OK) {
+                statsQueued(graphHandle, inFifoHandle, outFifoHandle, start);
+                readerQueued(outFifoHandle);
+        }
+
+        return s;
 }
 
-int ncs_GraphGetOption(void* graphHandle, int option, void *data, unsigned int *dataLength) {
-        ncStatus_t s = ncGraphGetOption((struct ncGraphHandle_t*) graphHandle, option, data, dataLength);
-        return int(s);
+// readElem reads FIFO element and times it
+static ncStatus_t readElem(void* fifoHandle, void* data, unsigned int* dataLength, void** userParam) {
+        uint64_t start = monotonicNow();
+
+        ncStatus_t s = ncFifoReadElem((struct ncFifoHandle_t*) fifoHandle, data, dataLength, userParam);
+        if (s == NC_OK) {
+                statsRead(fifoHandle, start);
+        }
+
+        return s;
 }
 
-int ncs_GraphDestroy(void** graphHandle) {
-        ncStatus_t s = ncGraphDestroy((struct ncGraphHandle_t**) graphHandle);
-        return int(s);
+// fifoIntOption queries integer FIFO option
+static ncStatus_t fifoIntOption(void* fifoHandle, int option, int* val) {
+        unsigned int len = sizeof(int);
+        return ncFifoGetOption((struct ncFifoHandle_t*) fifoHandle, option, val, &len);
 }
 
-int ncs_FifoCreate(const char* name, ncFifoType_t type, void** fifoHandle) {
-        ncStatus_t s = ncFifoCreate(name, type, (struct ncFifoHandle_t**) fifoHandle);
-        return int(s);
+// fifoReader reads FIFO elements on a native thread into a single producer single consumer ring.
+// A blocked FIFO read can't be interrupted, so the thread only reads while inferences queued to the FIFO have results outstanding
+// and destroying the reader joins the thread once its pending read returns.
+struct fifoReader {
+        struct ncFifoHandle_t* fifo;
+        unsigned int elemSize;
+        size_t stride;
+        unsigned long ringMask;
+        char* data;
+        ncs_FifoElemInfo* infos;
+        // head is the next ring slot written by the reader thread
+        std::atomic<unsigned long> head;
+        // tail is the next ring slot consumed by the ring consumer
+        std::atomic<unsigned long> tail;
+        std::atomic<bool> stop;
+        std::atomic<bool> done;
+        std::atomic<bool> queued;
+        std::atomic<bool> waiting;
+        // outstanding is the number of inferences queued to the FIFO whose results have not been read; it's guarded by mu
+        unsigned long outstanding;
+        int status;
+        std::mutex mu;
+        // space is notified when the ring has room, when inferences are queued and when the reader is stopped
+        std::condition_variable space;
+        std::thread thread;
+};
+
+// fifoReaders maps FIFOs to the readers reading them, so queueing inferences can count the results the readers wait for
+static std::mutex fifoReadersMu;
+static std::unordered_map<void*, fifoReader*> fifoReaders;
+// fifoReaderCount is the number of registered readers; queueing skips the lookup while it's 0
+static std::atomic<unsigned int> fifoReaderCount(0);
+
+// completionQueue is a queue of FIFO readers which have new elements in their rings.
+// It lets a single caller wait for elements read by any FIFO reader.
+struct completionQueue {
+        std::mutex mu;
+        std::condition_variable cv;
+        std::deque<fifoReader*> ready;
+};
+
+// completion is never destroyed: the caller waiting on it is blocked for the lifetime of the process
+// and destroying the condition variable at exit would block the exiting thread.
+static completionQueue& completion = *new completionQueue;
+
+static void fifoReaderFree(fifoReader* r) {
+        free(r->data);
+        free(r->infos);
+        delete r;
 }
 
-int ncs_FifoAllocate(void* fifoHandle, void* deviceHandle, struct ncTensorDescriptor_t* tensorDesc, unsigned int numElem) {
-        ncStatus_t s = ncFifoAllocate((struct ncFifoHandle_t*) fifoHandle, (struct ncDeviceHandle_t*) deviceHandle,
-                        (struct ncTensorDescriptor_t*) tensorDesc, numElem);
-        return int(s);
+// readerQueued records an inference queued to FIFO, waking up the reader reading it
+static void readerQueued(void* fifoHandle) {
+        if (fifoReaderCount.load() == 0) {
+                return;
+        }
+
+        std::lock_guard<std::mutex> lock(fifoReadersMu);
+        std::unordered_map<void*, fifoReader*>::iterator it = fifoReaders.find(fifoHandle);
+        if (it == fifoReaders.end()) {
+                return;
+        }
+
+        fifoReader* r = it->second;
+        std::lock_guard<std::mutex> readerLock(r->mu);
+        r->outstanding++;
+        r->space.notify_one();
 }
-int ncs_FifoGetOption(void* fifoHandle, int option, void *data, unsigned int *dataLength) {
-        ncStatus_t s = ncFifoGetOption((struct ncFifoHandle_t*) fifoHandle, option, data, dataLength);
-        return int(s);
+
+static void completionNotify(fifoReader* r) {
+        if (r->queued.exchange(true)) {
+                return;
+        }
+
+        std::lock_guard<std::mutex> lock(completion.mu);
+        if (r->stop.load()) {
+                return;
+        }
+        completion.ready.push_back(r);
+        completion.cv.notify_one();
 }
 
-int ncs_FifoWriteElem(void* fifoHandle, const void *inputTensor, unsigned int* inputTensorLength, void* userParam) {
-        ncStatus_t s = ncFifoWriteElem((struct ncFifoHandle_t*) fifoHandle, inputTensor, inputTensorLength, userParam);
-        return int(s);
+static void fifoReaderRun(fifoReader* r) {
+        ncStatus_t s = NC_OK;
+
+        for (;;) {
+                unsigned long head = r->head.load(std::memory_order_relaxed);
+                {
+                        std::unique_lock<std::mutex> lock(r->mu);
+                        r->waiting.store(true);
+                        r->space.wait(lock, [r, head] {
+                                return r->stop.load() || (r->outstanding > 0 && head - r->tail.load() <= r->ringMask);
+                        });
+                        r->waiting.store(false);
+                        if (r->stop.load()) {
+                                break;
+                        }
+                        r->outstanding--;
+                }
+
+                unsigned long slot = head & r->ringMask;
+                ncs_FifoElemInfo* info = &r->infos[slot];
+                info->dataLength = r->elemSize;
+                s = readElem(r->fifo, r->data + slot * r->stride, &info->dataLength, &info->userParam);
+                if (s != NC_OK) {
+                        break;
+                }
+
+                r->head.store(head + 1, std::memory_order_release);
+                completionNotify(r);
+        }
+
+        r->status = int(s);
+        r->done.store(true, std::memory_order_release);
+        completionNotify(r);
 }
 
-int ncs_FifoReadElem(void* fifoHandle, void *outputData, unsigned int* outputDataLen, void **userParam) {
-        ncStatus_t s = ncFifoReadElem((struct ncFifoHandle_t*) fifoHandle, outputData, outputDataLen, userParam);
-        return int(s);
+// deviceOpener brings up devices on native threads, one per device, and queues their results in the order they become ready.
+// It is referenced by its handle and by each of its threads and it is freed when all of them release it.
+struct deviceOpener {
+        std::mutex mu;
+        std::condition_variable cv;
+        std::atomic<int> refs;
+        // graphName is empty if devices are only opened
+        std::string graphName;
+        std::vector<char> graph;
+        ncFifoType_t inFifoType;
+        int inNumElem;
+        ncFifoDataType_t inDataType;
+        ncFifoType_t outFifoType;
+        int outNumElem;
+        ncFifoDataType_t outDataType;
+        std::deque<ncs_DeviceOpenResult> ready;
+        // pending is the number of devices still being brought up
+        unsigned int pending;
+        bool cancelled;
+};
+
+static void deviceOpenerUnref(deviceOpener* o) {
+        if (o->refs.fetch_sub(1) == 1) {
+                delete o;
+        }
 }
 
-int ncs_FifoDestroy(void** fifoHandle) {
-        ncStatus_t s = ncFifoDestroy((struct ncFifoHandle_t**) fifoHandle);
-        return int(s);
+// deviceTeardown destroys all the resources brought up for a device
+static void deviceTeardown(ncs_DeviceOpenResult* r, bool opened) {
+        if (r->inFifoHandle != NULL) {
+                ncFifoDestroy((struct ncFifoHandle_t**) &r->inFifoHandle);
+        }
+        if (r->outFifoHandle != NULL) {
+                ncFifoDestroy((struct ncFifoHandle_t**) &r->outFifoHandle);
+        }
+        if (r->graphHandle != NULL) {
+                ncGraphDestroy((struct ncGraphHandle_t**) &r->graphHandle);
+        }
+        if (r->deviceHandle != NULL) {
+                if (opened) {
+                        ncDeviceClose((struct ncDeviceHandle_t*) r->deviceHandle);
+                }
+                ncDeviceDestroy((struct ncDeviceHandle_t**) &r->deviceHandle);
+        }
+}
+
+static void deviceOpenerRun(deviceOpener* o, ncs_DeviceOpenResult r) {
+        struct ncDeviceHandle_t* device = (struct ncDeviceHandle_t*) r.deviceHandle;
+
+        ncStatus_t s = ncDeviceOpen(device);
+        bool opened = s == NC_OK;
+        if (s == NC_OK && !o->graphName.empty()) {
+                s = ncGraphCreate(o->graphName.c_str(), (struct ncGraphHandle_t**) &r.graphHandle);
+        }
+        if (s == NC_OK && r.graphHandle != NULL) {
+                s = ncGraphAllocateWithFifosEx(device, (struct ncGraphHandle_t*) r.graphHandle,
+                                o->graph.data(), (unsigned int) o->graph.size(),
+                                (struct ncFifoHandle_t**) &r.inFifoHandle, o->inFifoType, o->inNumElem, o->inDataType,
+                                (struct ncFifoHandle_t**) &r.outFifoHandle, o->outFifoType, o->outNumElem, o->outDataType);
+        }
+
+        r.status = int(s);
+        if (s != NC_OK) {
+                deviceTeardown(&r, opened);
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(o->mu);
+                o->pending--;
+                if (o->cancelled) {
+                        deviceTeardown(&r, opened);
+                } else {
+                        o->ready.push_back(r);
+                }
+                o->cv.notify_all();
+        }
+
+        deviceOpenerUnref(o);
+}
+
+// cascadeFrame is an image queued on a cascade along with the objects detected in it and their classifier outputs
+struct cascadeFrame {
+        std::vector<uint8_t> pixels;
+        unsigned int width;
+        unsigned int height;
+        std::vector<ncs_Detection> detections;
+        std::vector<char> outputs;
+};
+
+// cascade feeds the detections read from detector outbound FIFO into classifier on a native thread.
+// Every detection is cropped from the image it was detected in and preprocessed straight into classifier input, so the intermediate data never leaves native buffers.
+// Its thread is joined when the cascade is destroyed.
+struct cascade {
+        ncs_CascadeStage detector;
+        ncs_CascadeStage classifier;
+        float minConfidence;
+        unsigned int maxDetections;
+        // detections is detector output buffer
+        std::vector<char> detections;
+        // queueMu keeps pending frames in the order their inferences are queued
+        std::mutex queueMu;
+        std::mutex mu;
+        std::condition_variable cv;
+        // pending frames have their detector inferences queued and wait for their results, ready frames wait to be handed out
+        std::deque<cascadeFrame*> pending;
+        std::deque<cascadeFrame*> ready;
+        // spare frames are reused so the steady state does not allocate
+        std::vector<cascadeFrame*> spare;
+        // current is the frame handed out last
+        cascadeFrame* current;
+        std::thread thread;
+        bool stopped;
+        bool done;
+        int status;
+};
+
+static void cascadeFree(cascade* c) {
+        for (size_t i = 0; i < c->pending.size(); i++) {
+                delete c->pending[i];
+        }
+        for (size_t i = 0; i < c->ready.size(); i++) {
+                delete c->ready[i];
+        }
+        for (size_t i = 0; i < c->spare.size(); i++) {
+                delete c->spare[i];
+        }
+        delete c->current;
+        delete c;
+}
+
+// cascadeFrameGet returns a spare frame or a new one if there is none; c->mu must be held
+static cascadeFrame* cascadeFrameGet(cascade* c) {
+        if (c->spare.empty()) {
+                return new cascadeFrame;
+        }
+
+        cascadeFrame* f = c->spare.back();
+        c->spare.pop_back();
+
+        return f;
+}
+
+// cascadeFramePut returns frame f to spare frames; c->mu must be held
+static void cascadeFramePut(cascade* c, cascadeFrame* f) {
+        c->spare.push_back(f);
+}
+
+// cascadeCrop computes the pixel rectangle of detection box in frame f; the rectangle is at least a pixel large
+static void cascadeCrop(const cascadeFrame* f, const ncs_Detection* det,
+                unsigned int* x, unsigned int* y, unsigned int* w, unsigned int* h) {
+        unsigned int x0 = (unsigned int) (det->left * f->width), x1 = (unsigned int) ceilf(det->right * f->width);
+        unsigned int y0 = (unsigned int) (det->top * f->height), y1 = (unsigned int) ceilf(det->bottom * f->height);
+
+        if (x0 >= f->width) {
+                x0 = f->width - 1;
+        }
+        if (x1 > f->width) {
+                x1 = f->width;
+        }
+        if (x1 <= x0) {
+                x1 = x0 + 1;
+        }
+        if (y0 >= f->height) {
+                y0 = f->height - 1;
+        }
+        if (y1 > f->height) {
+                y1 = f->height;
+        }
+        if (y1 <= y0) {
+                y1 = y0 + 1;
+        }
+
+        *x = x0;
+        *y = y0;
+        *w = x1 - x0;
+        *h = y1 - y0;
+}
+
+// cascadeReadOutput reads classifier output of detection i of frame f
+static ncStatus_t cascadeReadOutput(cascade* c, cascadeFrame* f, unsigned int i) {
+        unsigned int len = c->classifier.outElemSize;
+        void* userParam = NULL;
+
+        return readElem(c->classifier.outFifoHandle, f->outputs.data() + size_t(i) * len, &len, &userParam);
+}
+
+// cascadeStopped returns true if cascade c has been stopped
+static bool cascadeStopped(cascade* c) {
+        std::lock_guard<std::mutex> lock(c->mu);
+        return c->stopped;
+}
+
+// cascadeClassify queues classifier inferences of all the detections of frame f and reads their outputs.
+// At most as many inferences as classifier outbound FIFO can hold are in flight, so their outputs never stall the classifier.
+// If the cascade is stopped no more detections are queued, but outputs of the queued ones are still read so they are not left in classifier outbound FIFO.
+static int cascadeClassify(cascade* c, cascadeFrame* f) {
+        ncs_CascadeStage* cls = &c->classifier;
+        unsigned int count = (unsigned int) f->detections.size(), read = 0, queued = 0;
+        f->outputs.resize(size_t(count) * cls->outElemSize);
+
+        for (unsigned int i = 0; i < count; i++) {
+                if (cascadeStopped(c)) {
+                        break;
+                }
+
+                if (i - read == cls->outNumElem) {
+                        ncStatus_t s = cascadeReadOutput(c, f, read++);
+                        if (s != NC_OK) {
+                                return int(s);
+                        }
+                }
+
+                uint64_t start = monotonicNow();
+                unsigned int x, y, w, h;
+                cascadeCrop(f, &f->detections[i], &x, &y, &w, &h);
+
+                // the crop is preprocessed in place, it's just a window into the frame
+                const uint8_t* crop = f->pixels.data() + (size_t(y) * f->width + x) * 3;
+                char* tensor = NULL;
+                int ps = preprocessTensorBGR(crop, w, h, f->width * 3, &cls->opts, &cls->inDesc, &tensor);
+                if (ps != NC_OK) {
+                        return ps;
+                }
+                unsigned int tensorLength = cls->inDesc.totalSize;
+
+                ncStatus_t s = queueInference(start, cls->graphHandle, cls->inFifoHandle, cls->outFifoHandle, tensor, &tensorLength, NULL);
+                if (s != NC_OK) {
+                        return int(s);
+                }
+                queued++;
+        }
+
+        for (; read < queued; read++) {
+                ncStatus_t s = cascadeReadOutput(c, f, read);
+                if (s != NC_OK) {
+                        return int(s);
+                }
+        }
+
+        return int(NC_OK);
+}
+
+static void cascadeRun(cascade* c) {
+        ncs_CascadeStage* det = &c->detector;
+        int s = NC_OK;
+
+        while (s == NC_OK) {
+                // detector results are read only while their inferences are in flight, so the read never outlives the cascade
+                {
+                        std::unique_lock<std::mutex> lock(c->mu);
+                        c->cv.wait(lock, [c] { return c->stopped || !c->pending.empty(); });
+                        if (c->stopped) {
+                                break;
+                        }
+                }
+
+                unsigned int len = det->outElemSize;
+                void* userParam = NULL;
+                s = int(readElem(det->outFifoHandle, c->detections.data(), &len, &userParam));
+                if (s != NC_OK) {
+                        break;
+                }
+
+                cascadeFrame* f = NULL;
+                {
+                        std::lock_guard<std::mutex> lock(c->mu);
+                        f = c->pending.front();
+                        c->pending.pop_front();
+                }
+
+                f->detections.resize(c->maxDetections);
+                int n = decodeSSD(c->detections.data(), len, det->outDataType, c->minConfidence, f->detections.data(), c->maxDetections);
+                if (n >= 0) {
+                        f->detections.resize(n);
+                        s = cascadeClassify(c, f);
+                } else {
+                        s = n;
+                }
+
+                std::unique_lock<std::mutex> lock(c->mu);
+                if (s == NC_OK) {
+                        // ready frames are bounded so a slow consumer stalls the detector instead of piling up frames
+                        c->cv.wait(lock, [c] { return c->stopped || c->ready.size() < c->detector.outNumElem; });
+                }
+                if (s != NC_OK || c->stopped) {
+                        cascadeFramePut(c, f);
+                        break;
+                }
+                c->ready.push_back(f);
+                c->cv.notify_all();
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(c->mu);
+                c->status = s;
+                c->done = true;
+                c->cv.notify_all();
+        }
+}
+
+// deadlineRequest is a single inference request served by deadline queue
+struct deadlineRequest {
+        // data holds the input tensor until the request is queued and its result once it's done
+        std::vector<char> data;
+        // deadline is the monotonic time in nanoseconds the request expires at; it's 0 if the request never expires
+        uint64_t deadline;
+        int state;
+        int status;
+        bool canceled;
+        // abandoned is set once the waiter gave up on the request in flight; the queue threads free abandoned requests
+        bool abandoned;
+};
+
+enum {
+        deadlinePending,
+        deadlineInFlight,
+        deadlineDone,
+};
+
+// deadlineQueue queues inferences with deadlines on a native thread and reads their results on another one.
+// Requests which expire or are canceled before they are queued are dropped without ever reaching the device.
+// Both of its threads are joined when the queue is destroyed.
+struct deadlineQueue {
+        void* graphHandle;
+        void* inFifoHandle;
+        void* outFifoHandle;
+        unsigned int inElemSize;
+        unsigned int outElemSize;
+        // depth is the maximum number of inferences in flight
+        unsigned int depth;
+        std::mutex mu;
+        std::condition_variable cv;
+        // pending requests wait to be queued, inflight requests wait for their results
+        std::deque<deadlineRequest*> pending;
+        std::deque<deadlineRequest*> inflight;
+        // queued is the number of inferences queued on the device whose results have not been read yet
+        unsigned int queued;
+        // requests maps IDs of the requests to their waiters
+        std::unordered_map<unsigned long long, deadlineRequest*> requests;
+        unsigned long long nextID;
+        // submitting is the request being queued outside of mu
+        deadlineRequest* submitting;
+        // output is the buffer inference results are read into
+        std::vector<char> output;
+        unsigned long long expired;
+        std::thread submitThread;
+        std::thread readThread;
+        bool stopped;
+        bool done;
+        int status;
+};
+
+static void deadlineQueueFree(deadlineQueue* q) {
+        for (std::unordered_map<unsigned long long, deadlineRequest*>::iterator it = q->requests.begin(); it != q->requests.end(); ++it) {
+                delete it->second;
+        }
+        delete q;
+}
+
+// deadlineFinish finishes request r with status s and frees it if its waiter has given up on it; q->mu must be held
+static void deadlineFinish(deadlineQueue* q, deadlineRequest* r, int s) {
+        // finishing a request in flight makes room for the next one, so the submit thread is woken up either way
+        q->cv.notify_all();
+
+        if (r->abandoned) {
+                delete r;
+                return;
+        }
+
+        r->state = deadlineDone;
+        r->status = s;
+}
+
+// deadlineFail finishes all pending requests and all requests in flight except the one being queued with status s; q->mu must be held
+static void deadlineFail(deadlineQueue* q, int s) {
+        for (size_t i = 0; i < q->pending.size(); i++) {
+                deadlineFinish(q, q->pending[i], s);
+        }
+        q->pending.clear();
+
+        for (size_t i = 0; i < q->inflight.size(); i++) {
+                if (q->inflight[i] != q->submitting) {
+                        deadlineFinish(q, q->inflight[i], s);
+                }
+        }
+        q->inflight.clear();
+}
+
+static void deadlineSubmitRun(deadlineQueue* q) {
+        std::unique_lock<std::mutex> lock(q->mu);
+
+        while (true) {
+                q->cv.wait(lock, [q] { return q->stopped || q->done || (!q->pending.empty() && q->inflight.size() < q->depth); });
+                if (q->stopped || q->done) {
+                        break;
+                }
+
+                deadlineRequest* r = q->pending.front();
+                q->pending.pop_front();
+
+                // the deadline is checked as late as possible, so expired requests never take device time
+                uint64_t start = monotonicNow();
+                if (r->canceled || (r->deadline != 0 && start >= r->deadline)) {
+                        q->expired++;
+                        deadlineFinish(q, r, int(NCS_DEADLINE_EXPIRED));
+                        continue;
+                }
+
+                r->state = deadlineInFlight;
+                q->inflight.push_back(r);
+                q->submitting = r;
+                q->cv.notify_all();
+                lock.unlock();
+
+                unsigned int len = (unsigned int) r->data.size();
+                ncStatus_t s = queueInference(start, q->graphHandle, q->inFifoHandle, q->outFifoHandle, r->data.data(), &len, NULL);
+
+                lock.lock();
+                q->submitting = NULL;
+                if (s == NC_OK) {
+                        q->queued++;
+                        q->cv.notify_all();
+                }
+                if (q->stopped || q->done) {
+                        // the queue was failed while the request was being queued and the request was skipped
+                        deadlineFinish(q, r, q->stopped ? int(NC_INVALID_HANDLE) : q->status);
+                        break;
+                }
+                if (s != NC_OK) {
+                        // queueing is serialized, so the request which failed to be queued is the last one in flight
+                        q->inflight.pop_back();
+                        deadlineFinish(q, r, int(s));
+                }
+        }
+}
+
+static void deadlineReadRun(deadlineQueue* q) {
+        int s = NC_OK;
+
+        while (true) {
+                // results are read only once their inferences have been queued, so the read never outlives the queue
+                {
+                        std::unique_lock<std::mutex> lock(q->mu);
+                        q->cv.wait(lock, [q] { return q->stopped || q->queued > 0; });
+                        if (q->stopped) {
+                                break;
+                        }
+                }
+
+                unsigned int len = q->outElemSize;
+                void* userParam = NULL;
+                s = int(readElem(q->outFifoHandle, q->output.data(), &len, &userParam));
+
+                std::lock_guard<std::mutex> lock(q->mu);
+                if (s == NC_OK) {
+                        q->queued--;
+                }
+                if (q->stopped) {
+                        break;
+                }
+                if (s == NC_OK && q->inflight.empty()) {
+                        s = int(NC_ERROR);
+                }
+                if (s != NC_OK) {
+                        q->status = s;
+                        q->done = true;
+                        deadlineFail(q, s);
+                        break;
+                }
+
+                deadlineRequest* r = q->inflight.front();
+                q->inflight.pop_front();
+                if (!r->abandoned) {
+                        r->data.assign(q->output.data(), q->output.data() + len);
+                }
+                deadlineFinish(q, r, int(NC_OK));
+        }
+}
+
+// deviceMonitor samples device health on a native thread and sets the pacing of the inferences queued on the device.
+// Its thread is joined when the monitor is stopped, so the device is never queried once the monitor is gone.
+struct deviceMonitor {
+        struct ncDeviceHandle_t* device;
+        ncs_MonitorOpts opts;
+        // stats are the device stats the pacing is set in; they are NULL if the device is not instrumented
+        resourceStats* stats;
+        std::mutex mu;
+        std::condition_variable cv;
+        ncs_DeviceHealth health;
+        // sampled is the time health was sampled at
+        uint64_t sampled;
+        std::thread thread;
+        bool stopped;
+};
+
+// monitorInterval returns the minimum interval between inferences queued on a device at temperature t and firmware throttling level throttle.
+// The interval grows linearly from throttleTemp to maxTemp, so the submission rate is eased off before the firmware throttling kicks in.
+static uint64_t monitorInterval(const ncs_MonitorOpts* opts, float t, int throttle) {
+        if (opts->maxInterval == 0 || (throttle == 0 && t <= opts->throttleTemp)) {
+                return 0;
+        }
+        if (throttle > 0 || t >= opts->maxTemp) {
+                return opts->maxInterval;
+        }
+
+        return uint64_t(double(opts->maxInterval) * (t - opts->throttleTemp) / (opts->maxTemp - opts->throttleTemp));
+}
+
+// monitorSample samples the device health and updates the pacing of the device; failed samples keep the last health and pacing
+static ncStatus_t monitorSample(deviceMonitor* m) {
+        ncs_DeviceHealth h;
+        memset(&h, 0, sizeof(h));
+
+        unsigned int len = sizeof(h.thermalStats);
+        ncStatus_t s = ncDeviceGetOption(m->device, NC_RO_DEVICE_THERMAL_STATS, h.thermalStats, &len);
+        if (s == NC_OK) {
+                len = sizeof(int);
+                s = ncDeviceGetOption(m->device, NC_RO_DEVICE_THERMAL_THROTTLING_LEVEL, &h.throttle, &len);
+        }
+        int memoryUsed = 0, memorySize = 0;
+        if (s == NC_OK) {
+                len = sizeof(int);
+                s = ncDeviceGetOption(m->device, NC_RO_DEVICE_CURRENT_MEMORY_USED, &memoryUsed, &len);
+        }
+        if (s == NC_OK) {
+                len = sizeof(int);
+                s = ncDeviceGetOption(m->device, NC_RO_DEVICE_MEMORY_SIZE, &memorySize, &len);
+        }
+
+        std::lock_guard<std::mutex> lock(m->mu);
+        m->health.samples++;
+        m->health.status = int(s);
+        if (s != NC_OK || m->stopped) {
+                return s;
+        }
+
+        memcpy(m->health.thermalStats, h.thermalStats, sizeof(h.thermalStats));
+        m->health.throttle = h.throttle;
+        m->health.memoryUsed = (unsigned int) memoryUsed;
+        m->health.memorySize = (unsigned int) memorySize;
+        // the most recent temperature is the first one in the thermal stats
+        m->health.interval = monitorInterval(&m->opts, h.thermalStats[0], h.throttle);
+        m->sampled = monotonicNow();
+
+        if (m->stats != NULL) {
+                m->stats->paceInterval.store(m->health.interval, std::memory_order_relaxed);
+        }
+
+        return s;
+}
+
+static void monitorRun(deviceMonitor* m) {
+        std::unique_lock<std::mutex> lock(m->mu);
+
+        while (!m->cv.wait_for(lock, std::chrono::nanoseconds(m->opts.period), [m] { return m->stopped; })) {
+                lock.unlock();
+                monitorSample(m);
+                lock.lock();
+        }
+}
+
+#ifdef __linux__
+// time video ingest thread waits for a captured frame before checking if it's been stopped
+#define INGEST_POLL_MS 100
+// time video ingest thread reuses the fill levels of target inbound FIFOs before querying them again
+#define INGEST_LEVELS_MS 10
+
+// videoIngest captures V4L2 frames into mmap'd buffers on a native thread, preprocesses them and queues their inferences on the least loaded target.
+// Frames are preprocessed straight from the capture buffers, so they never leave native memory.
+struct videoIngest {
+        int fd;
+        bool streaming;
+        std::vector<void*> bufs;
+        std::vector<size_t> bufLens;
+        unsigned int width;
+        unsigned int height;
+        unsigned int stride;
+        unsigned int pixelFormat;
+        // frameSize is the minimum number of bytes a complete frame takes
+        size_t frameSize;
+        std::vector<ncs_IngestTarget> targets;
+        // capacities contains the number of elements the target inbound FIFOs can hold
+        std::vector<int> capacities;
+        // levels caches the fill levels of the target inbound FIFOs queried at levelsAt, counting the elements queued since.
+        // Every query is a round trip to the device, so the levels are only queried every INGEST_LEVELS_MS.
+        std::vector<int> levels;
+        uint64_t levelsAt;
+        ncs_PreprocessOpts opts;
+        unsigned int tag;
+        unsigned int seqMask;
+        // bgr holds rows of YUYV frames converted to BGR
+        std::vector<uint8_t> bgr;
+        std::atomic<bool> stop;
+        std::atomic<int> status;
+        std::atomic<unsigned long long> frames;
+        std::atomic<unsigned long long> queued;
+        std::atomic<unsigned long long> dropped;
+        std::thread thread;
+};
+
+static int xioctl(int fd, unsigned long request, void* arg) {
+        int r;
+        do {
+                r = ioctl(fd, request, arg);
+        } while (r < 0 && errno == EINTR);
+
+        return r;
+}
+
+static inline uint8_t clampByte(int v) {
+        return v < 0 ? 0 : (v > 255 ? 255 : uint8_t(v));
+}
+
+// yuyvRowToBGR converts row of width YUYV pixels to BGR8 using BT.601 limited range coefficients
+static void yuyvRowToBGR(const uint8_t* src, uint8_t* dst, unsigned int width) {
+        for (unsigned int x = 0; x < width; x += 2, src += 4) {
+                int d = src[1] - 128, e = src[3] - 128;
+                int bd = 516 * d + 128, gd = -100 * d - 208 * e + 128, rd = 409 * e + 128;
+                for (unsigned int i = 0; i < 2 && x + i < width; i++) {
+                        int c = 298 * (src[2 * i] - 16);
+                        *dst++ = clampByte((c + bd) >> 8);
+                        *dst++ = clampByte((c + gd) >> 8);
+                        *dst++ = clampByte((c + rd) >> 8);
+                }
+        }
+}
+
+// ingestBGR converts YUYV frame to BGR8 image the frame is preprocessed from.
+// Only the rows preprocessing into tensor of dh rows interpolates from are converted, the others are left stale.
+static const uint8_t* ingestBGR(videoIngest* v, const uint8_t* frame, unsigned int dh) {
+        float sy = float(v->height) / dh;
+        int last = -1;
+        for (unsigned int y = 0; y < dh; y++) {
+                float wy;
+                int y0 = bilinearTap(y, sy, v->height, &wy);
+                int y1 = wy > 0 ? y0 + 1 : y0;
+                for (int r = y0 > last ? y0 : last + 1; r <= y1; r++) {
+                        yuyvRowToBGR(frame + size_t(r) * v->stride, v->bgr.data() + size_t(r) * v->width * 3, v->width);
+                }
+                if (y1 > last) {
+                        last = y1;
+                }
+        }
+
+        return v->bgr.data();
+}
+
+// ingestLevels refreshes the cached fill levels of the target inbound FIFOs once they're INGEST_LEVELS_MS old.
+// Targets whose fill level can't be queried are treated as full until the next refresh.
+static void ingestLevels(videoIngest* v, uint64_t now) {
+        if (now - v->levelsAt < uint64_t(INGEST_LEVELS_MS) * 1000000) {
+                return;
+        }
+
+        for (size_t i = 0; i < v->targets.size(); i++) {
+                int level = 0;
+                if (fifoIntOption(v->targets[i].inFifoHandle, NC_RO_FIFO_WRITE_FILL_LEVEL, &level) != NC_OK) {
+                        level = v->capacities[i];
+                }
+                v->levels[i] = level;
+        }
+        v->levelsAt = now;
+}
+
+// ingestTarget returns the index of the target whose inbound FIFO holds the fewest elements or -1 if all of them are full.
+// The cached levels only miss the elements read since they were queried, so a target is never picked while its FIFO is full.
+static int ingestTarget(videoIngest* v, uint64_t now) {
+        ingestLevels(v, now);
+
+        int best = -1, bestLevel = 0;
+        for (size_t i = 0; i < v->targets.size(); i++) {
+                int level = v->levels[i];
+                if (level >= v->capacities[i]) {
+                        continue;
+                }
+                if (best < 0 || level < bestLevel) {
+                        best = int(i);
+                        bestLevel = level;
+                }
+        }
+
+        return best;
+}
+
+// ingestQueue preprocesses frame captured into buf into the least loaded target and queues its inference.
+// The frame is dropped if all the targets are full.
+static ncStatus_t ingestQueue(videoIngest* v, const struct v4l2_buffer* buf, unsigned long long seq, uint64_t start) {
+        int t = ingestTarget(v, start);
+        if (t < 0) {
+                v->dropped++;
+                return NC_OK;
+        }
+        const ncs_IngestTarget& target = v->targets[t];
+
+        const uint8_t* img = (const uint8_t*) v->bufs[buf->index];
+        unsigned int stride = v->stride;
+        if (v->pixelFormat == V4L2_PIX_FMT_YUYV) {
+                img = ingestBGR(v, img, target.inDesc.h);
+                stride = v->width * 3;
+        }
+
+        char* tensor = NULL;
+        int ps = preprocessTensorBGR(img, v->width, v->height, stride, &v->opts, &target.inDesc, &tensor);
+        if (ps != NC_OK) {
+                return ncStatus_t(ps);
+        }
+        unsigned int tensorLength = target.inDesc.totalSize;
+
+        void* userParam = v->tag == 0 ? NULL : ncs_MetaParam(v->tag | (unsigned int) (seq & v->seqMask));
+        ncStatus_t s = queueInference(start, target.graphHandle, target.inFifoHandle, target.outFifoHandle,
+                        tensor, &tensorLength, userParam);
+        if (s == NC_OK) {
+                v->levels[t]++;
+                v->queued++;
+        }
+
+        return s;
+}
+
+// ingestFrames dequeues all the captured frames and queues the inference of the newest one.
+// Older frames are stale by the time the newest one is dequeued, so they are dropped to keep the latency bounded.
+static ncStatus_t ingestFrames(videoIngest* v) {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(v->fd, VIDIOC_DQBUF, &buf) < 0) {
+                return errno == EAGAIN ? NC_OK : NC_ERROR;
+        }
+        uint64_t start = monotonicNow();
+        unsigned long long seq = v->frames++;
+
+        for (;;) {
+                struct v4l2_buffer next;
+                memset(&next, 0, sizeof(next));
+                next.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                next.memory = V4L2_MEMORY_MMAP;
+                if (xioctl(v->fd, VIDIOC_DQBUF, &next) < 0) {
+                        if (errno == EAGAIN) {
+                                break;
+                        }
+                        xioctl(v->fd, VIDIOC_QBUF, &buf);
+                        return NC_ERROR;
+                }
+                seq = v->frames++;
+                v->dropped++;
+
+                if (xioctl(v->fd, VIDIOC_QBUF, &buf) < 0) {
+                        xioctl(v->fd, VIDIOC_QBUF, &next);
+                        return NC_ERROR;
+                }
+                buf = next;
+        }
+
+        ncStatus_t s = NC_OK;
+        if ((buf.flags & V4L2_BUF_FLAG_ERROR) != 0 || buf.bytesused < v->frameSize) {
+                // corrupted frames are dropped
+                v->dropped++;
+        } else {
+                s = ingestQueue(v, &buf, seq, start);
+        }
+
+        if (xioctl(v->fd, VIDIOC_QBUF, &buf) < 0 && s == NC_OK) {
+                s = NC_ERROR;
+        }
+
+        return s;
+}
+
+static void ingestRun(videoIngest* v) {
+        ncStatus_t s = NC_OK;
+
+        while (!v->stop.load()) {
+                struct pollfd pfd;
+                pfd.fd = v->fd;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+
+                int n = poll(&pfd, 1, INGEST_POLL_MS);
+                if (n < 0 && errno != EINTR) {
+                        s = NC_ERROR;
+                        break;
+                }
+                if (n <= 0) {
+                        continue;
+                }
+                if ((pfd.revents & (POLLERR | POLLHUP)) != 0) {
+                        // the camera has been unplugged
+                        s = NC_DEVICE_NOT_FOUND;
+                        break;
+                }
+
+                if ((s = ingestFrames(v)) != NC_OK) {
+                        break;
+                }
+        }
+
+        v->status.store(int(s));
+}
+
+// ingestOpen opens V4L2 capture device, negotiates capture format and starts streaming frames into mmap'd buffers
+static ncStatus_t ingestOpen(videoIngest* v, const ncs_IngestOpts* opts) {
+        v->fd = open(opts->device, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (v->fd < 0) {
+                return NC_DEVICE_NOT_FOUND;
+        }
+
+        struct v4l2_capability cap;
+        memset(&cap, 0, sizeof(cap));
+        if (xioctl(v->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+                return NC_UNSUPPORTED_FEATURE;
+        }
+        unsigned int caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) != 0 ? cap.device_caps : cap.capabilities;
+        if ((caps & V4L2_CAP_VIDEO_CAPTURE) == 0 || (caps & V4L2_CAP_STREAMING) == 0) {
+                return NC_UNSUPPORTED_FEATURE;
+        }
+
+        struct v4l2_format fmt;
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = opts->width;
+        fmt.fmt.pix.height = opts->height;
+        fmt.fmt.pix.pixelformat = opts->pixelFormat;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(v->fd, VIDIOC_S_FMT, &fmt) < 0) {
+                return NC_INVALID_PARAMETERS;
+        }
+        // drivers adjust the size to the closest one they support, but the pixel format must match
+        if (fmt.fmt.pix.pixelformat != opts->pixelFormat || fmt.fmt.pix.width == 0 || fmt.fmt.pix.height == 0) {
+                return NC_UNSUPPORTED_FEATURE;
+        }
+
+        unsigned int bpp = opts->pixelFormat == V4L2_PIX_FMT_YUYV ? 2 : 3;
+        v->width = fmt.fmt.pix.width;
+        v->height = fmt.fmt.pix.height;
+        v->stride = fmt.fmt.pix.bytesperline >= v->width * bpp ? fmt.fmt.pix.bytesperline : v->width * bpp;
+        v->pixelFormat = opts->pixelFormat;
+        v->frameSize = size_t(v->stride) * (v->height - 1) + v->width * bpp;
+
+        struct v4l2_requestbuffers req;
+        memset(&req, 0, sizeof(req));
+        req.count = opts->buffers;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(v->fd, VIDIOC_REQBUFS, &req) < 0) {
+                return NC_UNSUPPORTED_FEATURE;
+        }
+        if (req.count < 2) {
+                return NC_OUT_OF_MEMORY;
+        }
+
+        for (unsigned int i = 0; i < req.count; i++) {
+                struct v4l2_buffer buf;
+                memset(&buf, 0, sizeof(buf));
+                buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                buf.memory = V4L2_MEMORY_MMAP;
+                buf.index = i;
+                if (xioctl(v->fd, VIDIOC_QUERYBUF, &buf) < 0) {
+                        return NC_ERROR;
+                }
+
+                void* p = mmap(NULL, buf.length, PROT_READ, MAP_SHARED, v->fd, buf.m.offset);
+                if (p == MAP_FAILED) {
+                        return NC_OUT_OF_MEMORY;
+                }
+                v->bufs.push_back(p);
+                v->bufLens.push_back(buf.length);
+
+                if (xioctl(v->fd, VIDIOC_QBUF, &buf) < 0) {
+                        return NC_ERROR;
+                }
+        }
+
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(v->fd, VIDIOC_STREAMON, &type) < 0) {
+                return NC_ERROR;
+        }
+        v->streaming = true;
+
+        return NC_OK;
+}
+
+// ingestClose stops streaming and releases the capture device along with its buffers
+static void ingestClose(videoIngest* v) {
+        if (v->streaming) {
+                int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                xioctl(v->fd, VIDIOC_STREAMOFF, &type);
+        }
+
+        for (size_t i = 0; i < v->bufs.size(); i++) {
+                munmap(v->bufs[i], v->bufLens[i]);
+        }
+
+        if (v->fd >= 0) {
+                close(v->fd);
+        }
+
+        delete v;
+}
+#endif
+
+// getOptions reads all options in batch using get and stops at the first failure
+template <typename H>
+static int getOptions(H* handle, ncStatus_t (*get)(H*, int, void*, unsigned int*), ncs_OptionsBatch* batch) {
+        for (unsigned int i = 0; i < batch->count; i++) {
+                unsigned int dataLength = batch->lengths[i];
+                ncStatus_t s = get(handle, batch->options[i], batch->data + batch->offsets[i], &dataLength);
+                if (s != NC_OK) {
+                        return int(s);
+                }
+        }
+
+        return int(NC_OK);
+}
+
+// fifoBatchReserve makes sure FIFO batch info can hold info about count elements
+static int fifoBatchReserve(ncs_FifoBatchInfo* batch, unsigned int count) {
+        if (batch->cap >= count) {
+                return int(NC_OK);
+        }
+
+        void* elems = realloc(batch->elems, count * sizeof(ncs_FifoElemInfo));
+        if (elems == NULL) {
+                return int(NC_OUT_OF_MEMORY);
+        }
+
+        batch->elems = (ncs_FifoElemInfo*) elems;
+        batch->cap = count;
+
+        return int(NC_OK);
+}
+
+int ncs_DeviceCreate(int idx, void** deviceHandle) {
+    ncStatus_t s = ncDeviceCreate(idx, (struct ncDeviceHandle_t**) deviceHandle);
+    return int(s);
+}
+
+int ncs_DeviceOpen(void* deviceHandle) {
+    ncStatus_t s = ncDeviceOpen((struct ncDeviceHandle_t*) deviceHandle);
+    return int(s);
+}
+
+int ncs_DeviceGetOption(void* deviceHandle, int option, void *data, unsigned int *dataLength) {
+        countCall(NCS_CALL_OPTION);
+
+        ncStatus_t s = ncDeviceGetOption((struct ncDeviceHandle_t*) deviceHandle, option, data, dataLength);
+        return int(s);
+}
+
+int ncs_DeviceGetOptions(void* deviceHandle, ncs_OptionsBatch* batch) {
+        countCall(NCS_CALL_OPTION);
+
+        return getOptions((struct ncDeviceHandle_t*) deviceHandle, ncDeviceGetOption, batch);
+}
+
+int ncs_DeviceClose(void* deviceHandle) {
+    ncStatus_t s = ncDeviceClose((struct ncDeviceHandle_t*) deviceHandle);
+    return int(s);
+}
+
+int ncs_DeviceDestroy(void** deviceHandle) {
+    ncStatus_t s = ncDeviceDestroy((struct ncDeviceHandle_t**) deviceHandle);
+    return int(s);
+}
+
+int ncs_GraphCreate(const char* name, void** graphHandle) {
+        ncStatus_t s = ncGraphCreate(name, (struct ncGraphHandle_t**) graphHandle);
+        return int(s);
+}
+
+int ncs_GraphAllocate(void* deviceHandle, void* graphHandle, const void *graphBuffer, unsigned int graphBufferLength) {
+        ncStatus_t s = ncGraphAllocate((struct ncDeviceHandle_t*) deviceHandle, (struct ncGraphHandle_t*) graphHandle,
+                        graphBuffer, graphBufferLength);
+        return int(s);
+}
+
+int ncs_GraphAllocateWithFifos(void* deviceHandle, void* graphHandle, const void *graphBuffer, unsigned int graphBufferLength, void** inFifoHandle, void** outFifoHandle) {
+        int s = ncs_GraphAllocateWithFifosEx(deviceHandle,
+                        graphHandle, graphBuffer, graphBufferLength,
+                        inFifoHandle, NC_FIFO_HOST_WO, 2, NC_FIFO_FP32,
+                        outFifoHandle, NC_FIFO_HOST_RO, 2, NC_FIFO_FP32);
+
+        return int(s);
+}
+
+
+int ncs_GraphAllocateWithFifosEx(void* deviceHandle, void* graphHandle, const void *graphBuffer, unsigned int graphBufferLength, void** inFifoHandle, ncFifoType_t inFifoType, int inNumElem, ncFifoDataType_t inDataType, void** outFifoHandle,  ncFifoType_t outFifoType, int outNumElem, ncFifoDataType_t outDataType) {
+        ncStatus_t s = ncGraphAllocateWithFifosEx((struct ncDeviceHandle_t*) deviceHandle,
+                        (struct ncGraphHandle_t*) graphHandle, graphBuffer, graphBufferLength,
+                        (struct ncFifoHandle_t**) inFifoHandle, inFifoType, inNumElem, inDataType,
+                        (struct ncFifoHandle_t**) outFifoHandle, outFifoType, outNumElem, outDataType);
+        return int(s);
+}
+
+int ncs_GraphQueueInference(void* graphHandle, void** inFifoHandle, unsigned int inFifoCount, void** outFifoHandle, unsigned int outFifoCount) {
+        countCall(NCS_CALL_QUEUE);
+
+        uint64_t start = monotonicNow();
+        pace(graphHandle);
+
+        ncStatus_t s = ncGraphQueueInference((struct ncGraphHandle_t*) graphHandle,
+                        (struct ncFifoHandle_t**) inFifoHandle, inFifoCount,
+                        (struct ncFifoHandle_t**) outFifoHandle, outFifoCount);
+        if (s == NC_OK && inFifoCount > 0 && outFifoCount > 0) {
+                statsQueued(graphHandle, inFifoHandle[0], outFifoHandle[0], start);
+        }
+        return int(s);
+}
+
+int ncs_GraphQueueInferenceWithFifoElem(void* graphHandle, void* inFifoHandle, void* outFifoHandle, const void* inputTensor, unsigned int* inputTensorLength, unsigned int metaID) {
+        countCall(NCS_CALL_QUEUE);
+
+        ncStatus_t s = queueInference(monotonicNow(), graphHandle, inFifoHandle, outFifoHandle, inputTensor, inputTensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_GraphQueueInferenceBatch(void* graphHandle, void* inFifoHandle, void* outFifoHandle, const void* inputTensors, unsigned int inputTensorLength, unsigned int count, ncs_FifoBatchInfo* batch) {
+        countCall(NCS_CALL_QUEUE);
+
+        const char* tensor = (const char*) inputTensors;
+        ncStatus_t s = NC_OK;
+
+        for (batch->count = 0; batch->count < count; batch->count++) {
+                unsigned int tensorLength = inputTensorLength;
+                s = queueInference(monotonicNow(), graphHandle, inFifoHandle, outFifoHandle, tensor, &tensorLength, NULL);
+                if (s != NC_OK) {
+                        break;
+                }
+                tensor += inputTensorLength;
+        }
+
+        return int(s);
+}
+
+int ncs_GraphQueueInferenceWithFifoElemFp32(void* graphHandle, void* inFifoHandle, void* outFifoHandle, const void* inputTensor, unsigned int inputTensorLength, unsigned int metaID) {
+        countCall(NCS_CALL_QUEUE);
+
+        uint64_t start = monotonicNow();
+        uint16_t* tensor = fp16FromFp32(inputTensor, inputTensorLength);
+        unsigned int tensorLength = inputTensorLength / 2;
+
+        ncStatus_t s = queueInference(start, graphHandle, inFifoHandle, outFifoHandle, tensor, &tensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_GraphQueueInferenceWithFifoElemBGR(void* graphHandle, void* inFifoHandle, void* outFifoHandle, const void* image, unsigned int width, unsigned int height, unsigned int stride, const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* tensorDesc, unsigned int metaID) {
+        countCall(NCS_CALL_QUEUE);
+
+        uint64_t start = monotonicNow();
+        char* tensor = NULL;
+        int ps = preprocessTensorBGR(image, width, height, stride, opts, tensorDesc, &tensor);
+        if (ps != NC_OK) {
+                return ps;
+        }
+        unsigned int tensorLength = tensorDesc->totalSize;
+
+        ncStatus_t s = queueInference(start, graphHandle, inFifoHandle, outFifoHandle, tensor, &tensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_GraphGetOption(void* graphHandle, int option, void *data, unsigned int *dataLength) {
+        countCall(NCS_CALL_OPTION);
+
+        ncStatus_t s = ncGraphGetOption((struct ncGraphHandle_t*) graphHandle, option, data, dataLength);
+        return int(s);
+}
+
+int ncs_GraphGetOptions(void* graphHandle, ncs_OptionsBatch* batch) {
+        countCall(NCS_CALL_OPTION);
+
+        return getOptions((struct ncGraphHandle_t*) graphHandle, ncGraphGetOption, batch);
+}
+
+int ncs_GraphSetOption(void* graphHandle, int option, const void *data, unsigned int dataLength) {
+        countCall(NCS_CALL_OPTION);
+
+        ncStatus_t s = ncGraphSetOption((struct ncGraphHandle_t*) graphHandle, option, data, dataLength);
+        return int(s);
+}
+
+int ncs_GraphDestroy(void** graphHandle) {
+        ncStatus_t s = ncGraphDestroy((struct ncGraphHandle_t**) graphHandle);
+        return int(s);
+}
+
+int ncs_FifoCreate(const char* name, ncFifoType_t type, void** fifoHandle) {
+        ncStatus_t s = ncFifoCreate(name, type, (struct ncFifoHandle_t**) fifoHandle);
+        return int(s);
+}
+
+int ncs_FifoAllocate(void* fifoHandle, void* deviceHandle, struct ncTensorDescriptor_t* tensorDesc, unsigned int numElem) {
+        ncStatus_t s = ncFifoAllocate((struct ncFifoHandle_t*) fifoHandle, (struct ncDeviceHandle_t*) deviceHandle,
+                        (struct ncTensorDescriptor_t*) tensorDesc, numElem);
+        return int(s);
+}
+int ncs_FifoGetOption(void* fifoHandle, int option, void *data, unsigned int *dataLength) {
+        countCall(NCS_CALL_OPTION);
+
+        ncStatus_t s = ncFifoGetOption((struct ncFifoHandle_t*) fifoHandle, option, data, dataLength);
+        return int(s);
+}
+
+int ncs_FifoGetOptions(void* fifoHandle, ncs_OptionsBatch* batch) {
+        countCall(NCS_CALL_OPTION);
+
+        return getOptions((struct ncFifoHandle_t*) fifoHandle, ncFifoGetOption, batch);
+}
+
+int ncs_FifoSetOption(void* fifoHandle, int option, const void *data, unsigned int dataLength) {
+        countCall(NCS_CALL_OPTION);
+
+        ncStatus_t s = ncFifoSetOption((struct ncFifoHandle_t*) fifoHandle, option, data, dataLength);
+        return int(s);
+}
+
+int ncs_FifoWriteElem(void* fifoHandle, const void *inputTensor, unsigned int* inputTensorLength, unsigned int metaID) {
+        countCall(NCS_CALL_WRITE);
+
+        ncStatus_t s = writeElem(monotonicNow(), fifoHandle, inputTensor, inputTensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_FifoWriteElemFp32(void* fifoHandle, const void *inputTensor, unsigned int inputTensorLength, unsigned int metaID) {
+        countCall(NCS_CALL_WRITE);
+
+        uint64_t start = monotonicNow();
+        uint16_t* tensor = fp16FromFp32(inputTensor, inputTensorLength);
+        unsigned int tensorLength = inputTensorLength / 2;
+
+        ncStatus_t s = writeElem(start, fifoHandle, tensor, &tensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_FifoWriteElemBGR(void* fifoHandle, const void* image, unsigned int width, unsigned int height, unsigned int stride, const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* tensorDesc, unsigned int metaID) {
+        countCall(NCS_CALL_WRITE);
+
+        uint64_t start = monotonicNow();
+        char* tensor = NULL;
+        int ps = preprocessTensorBGR(image, width, height, stride, opts, tensorDesc, &tensor);
+        if (ps != NC_OK) {
+                return ps;
+        }
+        unsigned int tensorLength = tensorDesc->totalSize;
+
+        ncStatus_t s = writeElem(start, fifoHandle, tensor, &tensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_FifoReadElem(void* fifoHandle, void *outputData, unsigned int* outputDataLen, void **userParam) {
+        countCall(NCS_CALL_READ);
+
+        ncStatus_t s = readElem(fifoHandle, outputData, outputDataLen, userParam);
+        return int(s);
+}
+
+int ncs_FifoReadElemInto(void* fifoHandle, void *outputData, unsigned int outputDataLen, ncs_FifoElemInfo* info) {
+        countCall(NCS_CALL_READ);
+
+        info->dataLength = outputDataLen;
+        ncStatus_t s = readElem(fifoHandle, outputData, &info->dataLength, &info->userParam);
+        return int(s);
+}
+
+int ncs_FifoTryWriteElem(void* fifoHandle, const void *inputTensor, unsigned int* inputTensorLength, unsigned int metaID, int capacity) {
+        countCall(NCS_CALL_WRITE);
+
+        uint64_t start = monotonicNow();
+
+        int level;
+        ncStatus_t s = fifoIntOption(fifoHandle, NC_RO_FIFO_WRITE_FILL_LEVEL, &level);
+        if (s != NC_OK) {
+                return int(s);
+        }
+
+        // the FIFO is only drained concurrently, so the write can't block once there's room for it
+        if (level >= capacity) {
+                return int(NC_BUSY);
+        }
+
+        s = writeElem(start, fifoHandle, inputTensor, inputTensorLength, ncs_MetaParam(metaID));
+        return int(s);
+}
+
+int ncs_FifoTryReadElemInto(void* fifoHandle, void *outputData, unsigned int outputDataLen, ncs_FifoElemInfo* info) {
+        countCall(NCS_CALL_READ);
+
+        int level;
+        ncStatus_t s = fifoIntOption(fifoHandle, NC_RO_FIFO_READ_FILL_LEVEL, &level);
+        if (s != NC_OK) {
+                return int(s);
+        }
+
+        // the FIFO is only filled concurrently, so the read can't block once there's an element to read
+        if (level <= 0) {
+                return int(NC_BUSY);
+        }
+
+        return ncs_FifoReadElemInto(fifoHandle, outputData, outputDataLen, info);
+}
+
+int ncs_FifoWriteElemBatch(void* fifoHandle, const void* inputTensors, unsigned int inputTensorLength, unsigned int count, ncs_FifoBatchInfo* batch) {
+        countCall(NCS_CALL_WRITE);
+
+        const char* tensor = (const char*) inputTensors;
+        ncStatus_t s = NC_OK;
+
+        for (batch->count = 0; batch->count < count; batch->count++) {
+                unsigned int tensorLength = inputTensorLength;
+                s = writeElem(monotonicNow(), fifoHandle, tensor, &tensorLength, NULL);
+                if (s != NC_OK) {
+                        break;
+                }
+                tensor += inputTensorLength;
+        }
+
+        return int(s);
+}
+
+int ncs_FifoReadElemBatch(void* fifoHandle, void *outputData, unsigned int outputDataLen, unsigned int count, ncs_FifoBatchInfo* batch) {
+        countCall(NCS_CALL_READ);
+
+        batch->count = 0;
+
+        int rs = fifoBatchReserve(batch, count);
+        if (rs != NC_OK) {
+                return rs;
+        }
+
+        char* data = (char*) outputData;
+        ncStatus_t s = NC_OK;
+
+        for (; batch->count < count; batch->count++) {
+                ncs_FifoElemInfo* info = &batch->elems[batch->count];
+                info->dataLength = outputDataLen;
+                s = readElem(fifoHandle, data, &info->dataLength, &info->userParam);
+                if (s != NC_OK) {
+                        break;
+                }
+                data += outputDataLen;
+        }
+
+        return int(s);
+}
+
+int ncs_FifoRemoveElem(void* fifoHandle) {
+        ncStatus_t s = ncFifoRemoveElem((struct ncFifoHandle_t*) fifoHandle);
+        if (s == NC_OK) {
+                statsRemoveElem(fifoHandle);
+        }
+        return int(s);
+}
+
+int ncs_FifoDestroy(void** fifoHandle) {
+        ncStatus_t s = ncFifoDestroy((struct ncFifoHandle_t**) fifoHandle);
+        return int(s);
+}
+
+int ncs_Fp32ToFp16(const void* src, void* dst, unsigned int count) {
+        fp32ToFp16(src, (uint16_t*) dst, count);
+        return int(NC_OK);
+}
+
+int ncs_Fp16ToFp32(const void* src, void* dst, unsigned int count) {
+        fp16ToFp32(src, dst, count);
+        return int(NC_OK);
+}
+
+int ncs_DecodeSSD(const void* data, unsigned int dataLen, ncFifoDataType_t dataType, float minConfidence, ncs_Detection* detections, unsigned int maxDetections) {
+        return decodeSSD(data, dataLen, dataType, minConfidence, detections, maxDetections);
+}
+
+int ncs_TopK(const void* data, unsigned int dataLen, ncFifoDataType_t dataType, unsigned int k, ncs_Prediction* predictions) {
+        return topK(data, dataLen, dataType, k, predictions);
+}
+
+int ncs_PreprocessBGR(const void* image, unsigned int width, unsigned int height, unsigned int stride, const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* tensorDesc, void* outputData, unsigned int outputDataLen) {
+        return preprocessBGR((const uint8_t*) image, width, height, stride, opts, tensorDesc, (char*) outputData, outputDataLen);
+}
+
+int ncs_StatsRegister(void* handle, void* deviceHandle) {
+        if (handle == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        std::lock_guard<std::mutex> lock(statsTableMu);
+
+        if (statsLookup(&resourceStatsTable, handle) != NULL) {
+                return int(NC_OK);
+        }
+
+        resourceStats* rs = new resourceStats;
+        rs->refs.store(1);
+        rs->created = monotonicNow();
+        for (int i = 0; i < STATS_STAGES; i++) {
+                histInit(&rs->hists[i]);
+        }
+        rs->paceInterval.store(0);
+        rs->paceNext.store(0);
+        rs->device = (resourceStats*) statsLookup(&resourceStatsTable, deviceHandle);
+        if (rs->device != NULL) {
+                rs->device->refs.fetch_add(1);
+        }
+
+        if (!statsInsert(&resourceStatsTable, handle, rs)) {
+                resourceStatsUnref(rs);
+                return int(NC_OUT_OF_MEMORY);
+        }
+
+        return int(NC_OK);
+}
+
+int ncs_StatsUnregister(void* handle) {
+        std::lock_guard<std::mutex> lock(statsTableMu);
+
+        resourceStatsUnref((resourceStats*) statsRemove(&resourceStatsTable, handle));
+
+        return int(NC_OK);
+}
+
+int ncs_StatsRegisterFifo(void* fifoHandle) {
+        if (fifoHandle == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        std::lock_guard<std::mutex> lock(statsTableMu);
+
+        if (statsLookup(&fifoStatsTable, fifoHandle) != NULL) {
+                return int(NC_OK);
+        }
+
+        fifoStats* fs = new fifoStats;
+        fs->graphHandle.store(NULL);
+        fs->writeStart.store(0);
+        fs->head.store(0);
+        fs->tail.store(0);
+
+        if (!statsInsert(&fifoStatsTable, fifoHandle, fs)) {
+                delete fs;
+                return int(NC_OUT_OF_MEMORY);
+        }
+
+        return int(NC_OK);
+}
+
+int ncs_StatsUnregisterFifo(void* fifoHandle) {
+        std::lock_guard<std::mutex> lock(statsTableMu);
+
+        delete (fifoStats*) statsRemove(&fifoStatsTable, fifoHandle);
+
+        return int(NC_OK);
+}
+
+int ncs_StatsSnapshot(void* handle, ncs_Stats* stats) {
+        resourceStats* rs = NULL;
+        {
+                std::lock_guard<std::mutex> lock(statsTableMu);
+                rs = (resourceStats*) statsLookup(&resourceStatsTable, handle);
+                if (rs == NULL) {
+                        return int(NC_INVALID_HANDLE);
+                }
+                rs->refs.fetch_add(1);
+        }
+
+        stats->uptime = monotonicNow() - rs->created;
+        histSnapshot(&rs->hists[STATS_QUEUE], &stats->queue);
+        histSnapshot(&rs->hists[STATS_DEVICE], &stats->device);
+        histSnapshot(&rs->hists[STATS_READ], &stats->read);
+        histSnapshot(&rs->hists[STATS_TOTAL], &stats->total);
+
+        resourceStatsUnref(rs);
+
+        return int(NC_OK);
+}
+
+int ncs_StatsHistogram(void* handle, const unsigned long long* bounds, unsigned int boundCount,
+                unsigned long long* buckets, ncs_HistogramTotals* totals) {
+        for (unsigned int i = 1; i < boundCount; i++) {
+                if (bounds[i] < bounds[i-1]) {
+                        return int(NC_INVALID_PARAMETERS);
+                }
+        }
+
+        resourceStats* rs = NULL;
+        {
+                std::lock_guard<std::mutex> lock(statsTableMu);
+                rs = (resourceStats*) statsLookup(&resourceStatsTable, handle);
+                if (rs == NULL) {
+                        return int(NC_INVALID_HANDLE);
+                }
+                rs->refs.fetch_add(1);
+        }
+
+        for (int i = 0; i < STATS_STAGES; i++) {
+                histBuckets(&rs->hists[i], bounds, boundCount, buckets + i * boundCount, &totals[i]);
+        }
+
+        resourceStatsUnref(rs);
+
+        return int(NC_OK);
+}
+
+int ncs_StatsInflight(void* fifoHandle, unsigned int* inflight) {
+        // the table lock keeps the FIFO stats from being freed while they are read
+        std::lock_guard<std::mutex> lock(statsTableMu);
+
+        fifoStats* fs = (fifoStats*) statsLookup(&fifoStatsTable, fifoHandle);
+        if (fs == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        unsigned long head = fs->head.load(std::memory_order_acquire);
+        unsigned long tail = fs->tail.load(std::memory_order_acquire);
+        *inflight = tail > head ? (unsigned int) (tail - head) : 0;
+
+        return int(NC_OK);
+}
+
+int ncs_StatsCalls(unsigned long long* counts, unsigned int count) {
+        if (count > NCS_CALL_CLASSES) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        for (unsigned int i = 0; i < count; i++) {
+                counts[i] = callCounts[i].n.load(std::memory_order_relaxed);
+        }
+
+        return int(NC_OK);
+}
+
+int ncs_TensorPoolCreate(unsigned int bufSize, unsigned int slabCount, void** poolHandle) {
+        if (bufSize == 0 || slabCount == 0) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        tensorPool* p = new tensorPool();
+        p->bufSize = bufSize;
+        p->stride = (bufSize + TENSOR_POOL_ALIGN - 1) / TENSOR_POOL_ALIGN * TENSOR_POOL_ALIGN;
+        p->slabCount = slabCount;
+
+        int s = tensorPoolGrow(p);
+        if (s != NC_OK) {
+                delete p;
+                return s;
+        }
+
+        *poolHandle = p;
+
+        return int(NC_OK);
+}
+
+int ncs_TensorPoolGet(void* poolHandle, void** buf) {
+        tensorPool* p = (tensorPool*) poolHandle;
+        std::lock_guard<std::mutex> lock(p->mu);
+
+        if (p->freeSlots.empty()) {
+                int s = tensorPoolGrow(p);
+                if (s != NC_OK) {
+                        return s;
+                }
+        }
+
+        size_t slot = p->freeSlots.back();
+        p->freeSlots.pop_back();
+        p->taken[slot] = true;
+        *buf = p->slabs[slot / p->slabCount] + (slot % p->slabCount) * p->stride;
+        p->inUse.fetch_add(1, std::memory_order_relaxed);
+
+        return int(NC_OK);
+}
+
+int ncs_TensorPoolPut(void* poolHandle, void* buf) {
+        tensorPool* p = (tensorPool*) poolHandle;
+        std::lock_guard<std::mutex> lock(p->mu);
+
+        // buffers which are already free are rejected, so a buffer returned twice is never handed out twice
+        long slot = tensorPoolSlot(p, buf);
+        if (slot < 0 || !p->taken[slot]) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        p->taken[slot] = false;
+        p->freeSlots.push_back(size_t(slot));
+        p->inUse.fetch_sub(1, std::memory_order_relaxed);
+
+        return int(NC_OK);
+}
+
+int ncs_TensorPoolUsage(void* poolHandle, unsigned int* bufs, unsigned int* inUse) {
+        tensorPool* p = (tensorPool*) poolHandle;
+        if (p == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        *bufs = p->bufs.load(std::memory_order_relaxed);
+        *inUse = p->inUse.load(std::memory_order_relaxed);
+
+        return int(NC_OK);
+}
+
+int ncs_TensorPoolDestroy(void** poolHandle) {
+        tensorPool* p = (tensorPool*) *poolHandle;
+        if (p == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        for (size_t i = 0; i < p->slabs.size(); i++) {
+                free(p->slabs[i]);
+        }
+        delete p;
+        *poolHandle = NULL;
+
+        return int(NC_OK);
+}
+
+int ncs_FifoReaderCreate(void* fifoHandle, unsigned int elemSize, unsigned int ringSize, void** readerHandle) {
+        if (elemSize == 0 || ringSize == 0) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        unsigned long size = 1;
+        while (size < ringSize) {
+                size <<= 1;
+        }
+
+        fifoReader* r = new fifoReader();
+        r->fifo = (struct ncFifoHandle_t*) fifoHandle;
+        r->elemSize = elemSize;
+        r->stride = (elemSize + TENSOR_POOL_ALIGN - 1) / TENSOR_POOL_ALIGN * TENSOR_POOL_ALIGN;
+        r->ringMask = size - 1;
+        r->infos = (ncs_FifoElemInfo*) calloc(size, sizeof(ncs_FifoElemInfo));
+        void* data = NULL;
+        if (r->infos == NULL || posix_memalign(&data, TENSOR_POOL_ALIGN, r->stride * size) != 0) {
+                free(r->infos);
+                delete r;
+                return int(NC_OUT_OF_MEMORY);
+        }
+        r->data = (char*) data;
+
+        {
+                std::lock_guard<std::mutex> lock(fifoReadersMu);
+                if (fifoReaders.count(fifoHandle) != 0) {
+                        fifoReaderFree(r);
+                        return int(NC_INVALID_PARAMETERS);
+                }
+                fifoReaders[fifoHandle] = r;
+                fifoReaderCount++;
+        }
+
+        r->thread = std::thread(fifoReaderRun, r);
+        *readerHandle = r;
+
+        return int(NC_OK);
+}
+
+int ncs_FifoReaderPeek(void* readerHandle, ncs_FifoReaderElem* elem) {
+        countCall(NCS_CALL_READ);
+
+        fifoReader* r = (fifoReader*) readerHandle;
+
+        bool done = r->done.load(std::memory_order_acquire);
+        unsigned long tail = r->tail.load(std::memory_order_relaxed);
+        if (tail == r->head.load(std::memory_order_acquire)) {
+                if (!done) {
+                        return int(NC_BUSY);
+                }
+                return r->status != NC_OK ? r->status : int(NC_INVALID_HANDLE);
+        }
+
+        unsigned long slot = tail & r->ringMask;
+        elem->data = r->data + slot * r->stride;
+        elem->info = r->infos[slot];
+
+        return int(NC_OK);
+}
+
+int ncs_FifoReaderRelease(void* readerHandle) {
+        fifoReader* r = (fifoReader*) readerHandle;
+
+        unsigned long tail = r->tail.load(std::memory_order_relaxed);
+        if (tail == r->head.load(std::memory_order_acquire)) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+        r->tail.store(tail + 1);
+
+        if (r->waiting.load()) {
+                std::lock_guard<std::mutex> lock(r->mu);
+                r->space.notify_one();
+        }
+
+        return int(NC_OK);
+}
+
+int ncs_FifoReaderDestroy(void** readerHandle) {
+        fifoReader* r = (fifoReader*) *readerHandle;
+        if (r == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(fifoReadersMu);
+                fifoReaders.erase(r->fifo);
+                fifoReaderCount--;
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(completion.mu);
+                r->stop.store(true);
+                for (std::deque<fifoReader*>::iterator it = completion.ready.begin(); it != completion.ready.end(); ++it) {
+                        if (*it == r) {
+                                completion.ready.erase(it);
+                                break;
+                        }
+                }
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(r->mu);
+                r->space.notify_one();
+        }
+
+        // the reader thread returns once its pending FIFO read returns
+        r->thread.join();
+        fifoReaderFree(r);
+        *readerHandle = NULL;
+
+        return int(NC_OK);
+}
+
+int ncs_CompletionWait(void** readerHandle) {
+        countCall(NCS_CALL_READ);
+
+        std::unique_lock<std::mutex> lock(completion.mu);
+        completion.cv.wait(lock, [] { return !completion.ready.empty(); });
+
+        fifoReader* r = completion.ready.front();
+        completion.ready.pop_front();
+        r->queued.store(false);
+        *readerHandle = r;
+
+        return int(NC_OK);
+}
+
+int ncs_DevicesOpen(int maxDevices, const char* graphName, const void *graphBuffer, unsigned int graphBufferLength,
+                ncFifoType_t inFifoType, int inNumElem, ncFifoDataType_t inDataType,
+                ncFifoType_t outFifoType, int outNumElem, ncFifoDataType_t outDataType, void** openHandle) {
+        if (graphName != NULL && (graphBuffer == NULL || graphBufferLength == 0)) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        // devices are enumerated from index 0 until creating a device fails; creating devices does not boot them, so it's quick
+        std::vector<void*> devices;
+        for (int idx = 0; maxDevices <= 0 || idx < maxDevices; idx++) {
+                void* deviceHandle = NULL;
+                if (ncDeviceCreate(idx, (struct ncDeviceHandle_t**) &deviceHandle) != NC_OK) {
+                        break;
+                }
+                devices.push_back(deviceHandle);
+        }
+
+        deviceOpener* o = new deviceOpener;
+        o->refs.store(1 + int(devices.size()));
+        if (graphName != NULL) {
+                o->graphName = graphName;
+                // the graph is copied once and shared by all the bring-up threads as the caller's buffer may not outlive the call
+                o->graph.assign((const char*) graphBuffer, (const char*) graphBuffer + graphBufferLength);
+        }
+        o->inFifoType = inFifoType;
+        o->inNumElem = inNumElem;
+        o->inDataType = inDataType;
+        o->outFifoType = outFifoType;
+        o->outNumElem = outNumElem;
+        o->outDataType = outDataType;
+        o->pending = (unsigned int) devices.size();
+        o->cancelled = false;
+
+        for (size_t i = 0; i < devices.size(); i++) {
+                ncs_DeviceOpenResult r;
+                memset(&r, 0, sizeof(r));
+                r.index = int(i);
+                r.deviceHandle = devices[i];
+                std::thread(deviceOpenerRun, o, r).detach();
+        }
+
+        *openHandle = o;
+
+        return int(devices.size());
+}
+
+int ncs_DevicesOpenNext(void* openHandle, ncs_DeviceOpenResult* result) {
+        deviceOpener* o = (deviceOpener*) openHandle;
+
+        std::unique_lock<std::mutex> lock(o->mu);
+        o->cv.wait(lock, [o] { return o->cancelled || !o->ready.empty() || o->pending == 0; });
+        if (o->cancelled) {
+                return int(NC_INVALID_HANDLE);
+        }
+        if (o->ready.empty()) {
+                return int(NC_DEVICE_NOT_FOUND);
+        }
+
+        *result = o->ready.front();
+        o->ready.pop_front();
+
+        return int(NC_OK);
+}
+
+int ncs_DevicesOpenCancel(void* openHandle) {
+        deviceOpener* o = (deviceOpener*) openHandle;
+
+        std::lock_guard<std::mutex> lock(o->mu);
+        o->cancelled = true;
+        // devices which are ready but have not been handed out are torn down; the rest are torn down by their threads
+        for (size_t i = 0; i < o->ready.size(); i++) {
+                deviceTeardown(&o->ready[i], true);
+        }
+        o->ready.clear();
+        o->cv.notify_all();
+
+        return int(NC_OK);
+}
+
+int ncs_DevicesOpenDestroy(void** openHandle) {
+        deviceOpener* o = (deviceOpener*) *openHandle;
+        if (o == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        ncs_DevicesOpenCancel(o);
+        deviceOpenerUnref(o);
+        *openHandle = NULL;
+
+        return int(NC_OK);
+}
+
+int ncs_CascadeCreate(const ncs_CascadeStage* detector, const ncs_CascadeStage* classifier,
+                float minConfidence, unsigned int maxDetections, void** cascadeHandle) {
+        if (maxDetections == 0 || detector->outElemSize == 0 || detector->outNumElem == 0 ||
+                        classifier->outElemSize == 0 || classifier->outNumElem == 0) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        cascade* c = new cascade;
+        c->detector = *detector;
+        c->classifier = *classifier;
+        c->minConfidence = minConfidence;
+        c->maxDetections = maxDetections;
+        c->detections.resize(detector->outElemSize);
+        c->current = NULL;
+        c->stopped = false;
+        c->done = false;
+        c->status = int(NC_OK);
+        c->thread = std::thread(cascadeRun, c);
+        *cascadeHandle = c;
+
+        return int(NC_OK);
+}
+
+int ncs_CascadeQueue(void* cascadeHandle, const void* image, unsigned int width, unsigned int height, unsigned int stride) {
+        countCall(NCS_CALL_QUEUE);
+
+        cascade* c = (cascade*) cascadeHandle;
+        if (c == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        ncs_CascadeStage* det = &c->detector;
+        uint64_t start = monotonicNow();
+
+        char* tensor = NULL;
+        int ps = preprocessTensorBGR(image, width, height, stride, &det->opts, &det->inDesc, &tensor);
+        if (ps != NC_OK) {
+                return ps;
+        }
+
+        std::lock_guard<std::mutex> queueLock(c->queueMu);
+
+        cascadeFrame* f;
+        {
+                std::lock_guard<std::mutex> lock(c->mu);
+                if (c->done && c->status != NC_OK) {
+                        return c->status;
+                }
+                if (c->stopped || c->done) {
+                        return int(NC_INVALID_HANDLE);
+                }
+                f = cascadeFrameGet(c);
+        }
+
+        // the image is copied as its detections are cropped from it after the caller's buffer may be gone
+        f->width = width;
+        f->height = height;
+        f->pixels.resize(size_t(width) * height * 3);
+        for (unsigned int y = 0; y < height; y++) {
+                memcpy(f->pixels.data() + size_t(y) * width * 3, (const char*) image + size_t(y) * stride, size_t(width) * 3);
+        }
+
+        unsigned int tensorLength = det->inDesc.totalSize;
+        ncStatus_t s = queueInference(start, det->graphHandle, det->inFifoHandle, det->outFifoHandle, tensor, &tensorLength, NULL);
+
+        // queueing is serialized, so frames are pending in the order their inferences are queued
+        std::lock_guard<std::mutex> lock(c->mu);
+        if (s != NC_OK) {
+                cascadeFramePut(c, f);
+                return int(s);
+        }
+        c->pending.push_back(f);
+        c->cv.notify_all();
+
+        return int(NC_OK);
+}
+
+int ncs_CascadeNext(void* cascadeHandle, ncs_CascadeResult* result) {
+        countCall(NCS_CALL_READ);
+
+        cascade* c = (cascade*) cascadeHandle;
+        if (c == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        std::unique_lock<std::mutex> lock(c->mu);
+        if (c->current != NULL) {
+                cascadeFramePut(c, c->current);
+                c->current = NULL;
+        }
+
+        c->cv.wait(lock, [c] { return c->stopped || c->done || !c->ready.empty(); });
+        if (c->stopped) {
+                return int(NC_INVALID_HANDLE);
+        }
+        if (c->ready.empty()) {
+                return c->status != NC_OK ? c->status : int(NC_INVALID_HANDLE);
+        }
+
+        c->current = c->ready.front();
+        c->ready.pop_front();
+        c->cv.notify_all();
+
+        result->count = (unsigned int) c->current->detections.size();
+        result->detections = c->current->detections.data();
+        result->outputs = c->current->outputs.data();
+        result->outputLength = c->classifier.outElemSize;
+
+        return int(NC_OK);
+}
+
+int ncs_CascadeStop(void* cascadeHandle) {
+        cascade* c = (cascade*) cascadeHandle;
+        if (c == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        std::lock_guard<std::mutex> lock(c->mu);
+        c->stopped = true;
+        c->cv.notify_all();
+
+        return int(NC_OK);
+}
+
+int ncs_CascadeDestroy(void** cascadeHandle) {
+        cascade* c = (cascade*) *cascadeHandle;
+        if (c == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        // the cascade thread returns once results of the inferences in flight have been read
+        ncs_CascadeStop(c);
+        c->thread.join();
+        cascadeFree(c);
+        *cascadeHandle = NULL;
+
+        return int(NC_OK);
+}
+
+int ncs_DeadlineQueueCreate(void* graphHandle, void* inFifoHandle, void* outFifoHandle,
+                unsigned int inElemSize, unsigned int outElemSize, unsigned int depth, void** queueHandle) {
+        if (inElemSize == 0 || outElemSize == 0 || depth == 0) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        deadlineQueue* q = new deadlineQueue;
+        q->graphHandle = graphHandle;
+        q->inFifoHandle = inFifoHandle;
+        q->outFifoHandle = outFifoHandle;
+        q->inElemSize = inElemSize;
+        q->outElemSize = outElemSize;
+        q->depth = depth;
+        q->nextID = 1;
+        q->submitting = NULL;
+        q->queued = 0;
+        q->output.resize(outElemSize);
+        q->expired = 0;
+        q->stopped = false;
+        q->done = false;
+        q->status = int(NC_OK);
+        q->submitThread = std::thread(deadlineSubmitRun, q);
+        q->readThread = std::thread(deadlineReadRun, q);
+        *queueHandle = q;
+
+        return int(NC_OK);
+}
+
+int ncs_DeadlineQueueSubmit(void* queueHandle, const void* inputTensor, unsigned int inputTensorLength,
+                unsigned long long timeout, unsigned long long* requestID) {
+        countCall(NCS_CALL_QUEUE);
+
+        deadlineQueue* q = (deadlineQueue*) queueHandle;
+        if (inputTensorLength != q->inElemSize) {
+                return int(NC_INVALID_DATA_LENGTH);
+        }
+
+        deadlineRequest* r = new deadlineRequest;
+        r->data.assign((const char*) inputTensor, (const char*) inputTensor + inputTensorLength);
+        r->deadline = timeout != 0 ? monotonicNow() + timeout : 0;
+        r->state = deadlinePending;
+        r->status = int(NC_OK);
+        r->canceled = false;
+        r->abandoned = false;
+
+        std::lock_guard<std::mutex> lock(q->mu);
+        if (q->stopped || q->done) {
+                delete r;
+                return q->stopped || q->status == NC_OK ? int(NC_INVALID_HANDLE) : q->status;
+        }
+
+        *requestID = q->nextID++;
+        q->requests[*requestID] = r;
+        q->pending.push_back(r);
+        q->cv.notify_all();
+
+        return int(NC_OK);
+}
+
+int ncs_DeadlineQueueWait(void* queueHandle, unsigned long long requestID, void* outputData, unsigned int outputDataLen,
+                unsigned int* outputLength) {
+        countCall(NCS_CALL_READ);
+
+        deadlineQueue* q = (deadlineQueue*) queueHandle;
+
+        std::unique_lock<std::mutex> lock(q->mu);
+        std::unordered_map<unsigned long long, deadlineRequest*>::iterator it = q->requests.find(requestID);
+        if (it == q->requests.end()) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+        deadlineRequest* r = it->second;
+
+        if (r->deadline == 0) {
+                q->cv.wait(lock, [r] { return r->state == deadlineDone || r->canceled; });
+        } else {
+                std::chrono::steady_clock::time_point deadline(
+                                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(r->deadline)));
+                q->cv.wait_until(lock, deadline, [r] { return r->state == deadlineDone || r->canceled; });
+        }
+        q->requests.erase(it);
+
+        if (r->state == deadlineDone) {
+                int s = r->status;
+                if (s == NC_OK) {
+                        if (r->data.size() > outputDataLen) {
+                                s = int(NC_INVALID_DATA_LENGTH);
+                        } else {
+                                memcpy(outputData, r->data.data(), r->data.size());
+                                *outputLength = (unsigned int) r->data.size();
+                        }
+                }
+                delete r;
+                return s;
+        }
+
+        // the request expired or was canceled before it finished: pending requests are dropped straight away,
+        // results of the requests in flight are discarded once they are read
+        if (r->state == deadlinePending) {
+                for (std::deque<deadlineRequest*>::iterator p = q->pending.begin(); p != q->pending.end(); ++p) {
+                        if (*p == r) {
+                                q->pending.erase(p);
+                                break;
+                        }
+                }
+                q->expired++;
+                delete r;
+        } else {
+                r->abandoned = true;
+        }
+
+        return int(NCS_DEADLINE_EXPIRED);
+}
+
+int ncs_DeadlineQueueCancel(void* queueHandle, unsigned long long requestID) {
+        deadlineQueue* q = (deadlineQueue*) queueHandle;
+
+        std::lock_guard<std::mutex> lock(q->mu);
+        std::unordered_map<unsigned long long, deadlineRequest*>::iterator it = q->requests.find(requestID);
+        if (it == q->requests.end()) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+        it->second->canceled = true;
+        q->cv.notify_all();
+
+        return int(NC_OK);
+}
+
+int ncs_DeadlineQueueExpired(void* queueHandle, unsigned long long* expired) {
+        deadlineQueue* q = (deadlineQueue*) queueHandle;
+
+        std::lock_guard<std::mutex> lock(q->mu);
+        *expired = q->expired;
+
+        return int(NC_OK);
+}
+
+int ncs_DeadlineQueueStop(void* queueHandle) {
+        deadlineQueue* q = (deadlineQueue*) queueHandle;
+
+        std::lock_guard<std::mutex> lock(q->mu);
+        if (!q->stopped) {
+                q->stopped = true;
+                deadlineFail(q, int(NC_INVALID_HANDLE));
+        }
+        q->cv.notify_all();
+
+        return int(NC_OK);
+}
+
+int ncs_DeadlineQueueDestroy(void** queueHandle) {
+        deadlineQueue* q = (deadlineQueue*) *queueHandle;
+        if (q == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        // the threads return once the inference being queued is queued and the result being read is read
+        ncs_DeadlineQueueStop(q);
+        q->submitThread.join();
+        q->readThread.join();
+        deadlineQueueFree(q);
+        *queueHandle = NULL;
+
+        return int(NC_OK);
+}
+
+int ncs_MonitorStart(void* deviceHandle, const ncs_MonitorOpts* opts, void** monitorHandle) {
+        if (opts->period == 0 || (opts->maxInterval != 0 && opts->maxTemp <= opts->throttleTemp)) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        deviceMonitor* m = new deviceMonitor;
+        m->device = (struct ncDeviceHandle_t*) deviceHandle;
+        m->opts = *opts;
+        memset(&m->health, 0, sizeof(m->health));
+        m->sampled = 0;
+        m->stopped = false;
+        {
+                std::lock_guard<std::mutex> lock(statsTableMu);
+                m->stats = (resourceStats*) statsLookup(&resourceStatsTable, deviceHandle);
+                if (m->stats != NULL) {
+                        m->stats->refs.fetch_add(1);
+                }
+        }
+
+        // the first sample is taken straight away, so the health is available as soon as the monitor is started
+        ncStatus_t s = monitorSample(m);
+        if (s != NC_OK) {
+                resourceStatsUnref(m->stats);
+                delete m;
+                return int(s);
+        }
+
+        m->thread = std::thread(monitorRun, m);
+        *monitorHandle = m;
+
+        return int(NC_OK);
+}
+
+int ncs_MonitorHealth(void* monitorHandle, ncs_DeviceHealth* health) {
+        deviceMonitor* m = (deviceMonitor*) monitorHandle;
+
+        std::lock_guard<std::mutex> lock(m->mu);
+        *health = m->health;
+        health->age = monotonicNow() - m->sampled;
+
+        return int(NC_OK);
+}
+
+int ncs_MonitorStop(void** monitorHandle) {
+        deviceMonitor* m = (deviceMonitor*) *monitorHandle;
+        if (m == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(m->mu);
+                m->stopped = true;
+                if (m->stats != NULL) {
+                        m->stats->paceInterval.store(0, std::memory_order_relaxed);
+                }
+                m->cv.notify_all();
+        }
+
+        // the monitor thread returns once the sample it may be taking finishes
+        m->thread.join();
+        resourceStatsUnref(m->stats);
+        delete m;
+        *monitorHandle = NULL;
+
+        return int(NC_OK);
+}
+
+#ifdef __linux__
+int ncs_IngestStart(ncs_IngestOpts* opts, const ncs_IngestTarget* targets, unsigned int targetCount, void** ingestHandle) {
+        if (opts == NULL || opts->device == NULL || opts->buffers == 0 || targets == NULL || targetCount == 0) {
+                return int(NC_INVALID_PARAMETERS);
+        }
+
+        if (opts->pixelFormat != V4L2_PIX_FMT_YUYV && opts->pixelFormat != V4L2_PIX_FMT_BGR24) {
+                return int(NC_UNSUPPORTED_FEATURE);
+        }
+
+        videoIngest* v = new videoIngest;
+        v->fd = -1;
+        v->streaming = false;
+        v->targets.assign(targets, targets + targetCount);
+        v->opts = opts->preprocess;
+        v->tag = opts->tag;
+        v->seqMask = opts->seqMask;
+        v->stop.store(false);
+        v->status.store(int(NC_OK));
+        v->frames.store(0);
+        v->queued.store(0);
+        v->dropped.store(0);
+
+        for (unsigned int i = 0; i < targetCount; i++) {
+                int capacity = 0;
+                ncStatus_t s = fifoIntOption(targets[i].inFifoHandle, NC_RO_FIFO_CAPACITY, &capacity);
+                if (s != NC_OK) {
+                        ingestClose(v);
+                        return int(s);
+                }
+                v->capacities.push_back(capacity);
+        }
+        v->levels.assign(targetCount, 0);
+        v->levelsAt = 0;
+
+        ncStatus_t s = ingestOpen(v, opts);
+        if (s != NC_OK) {
+                ingestClose(v);
+                return int(s);
+        }
+
+        opts->width = v->width;
+        opts->height = v->height;
+        if (v->pixelFormat == V4L2_PIX_FMT_YUYV) {
+                v->bgr.resize(size_t(v->width) * v->height * 3);
+        }
+
+        v->thread = std::thread(ingestRun, v);
+        *ingestHandle = v;
+
+        return int(NC_OK);
+}
+
+int ncs_IngestSnapshot(void* ingestHandle, ncs_IngestStats* stats) {
+        videoIngest* v = (videoIngest*) ingestHandle;
+
+        stats->status = v->status.load();
+        stats->frames = v->frames.load();
+        stats->queued = v->queued.load();
+        stats->dropped = v->dropped.load();
+
+        return int(NC_OK);
+}
+
+int ncs_IngestStop(void** ingestHandle) {
+        videoIngest* v = (videoIngest*) *ingestHandle;
+        if (v == NULL) {
+                return int(NC_INVALID_HANDLE);
+        }
+
+        v->stop.store(true);
+        if (v->thread.joinable()) {
+                v->thread.join();
+        }
+
+        ingestClose(v);
+        *ingestHandle = NULL;
+
+        return int(NC_OK);
 }
+#endif
@@ -1,6 +1,7 @@
 #ifndef _NCS_H_
 #define _NCS_H_
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <mvnc.h>
 
@@ -11,13 +12,214 @@ extern "C" {
 typedef ncFifoType_t ncFifoType;
 typedef ncFifoDataType_t ncFifoDataType;
 
+// FIFO element info filled in on every FIFO element read.
+// It is allocated once per FIFO so the read path does not allocate.
+typedef struct ncs_FifoElemInfo {
+    unsigned int dataLength;
+    void* userParam;
+} ncs_FifoElemInfo;
+
+// FIFO batch info filled in on every batched FIFO element read or write.
+// It is allocated once per FIFO and its elems grow as needed so the batched paths do not allocate.
+typedef struct ncs_FifoBatchInfo {
+    unsigned int count;
+    unsigned int cap;
+    ncs_FifoElemInfo* elems;
+} ncs_FifoBatchInfo;
+
+// Image preprocessing options.
+// Pixel values are computed as (value - mean[c]) * scale[c], c being BGR channel.
+typedef struct ncs_PreprocessOpts {
+    float mean[3];
+    float scale[3];
+    int swapRB;
+} ncs_PreprocessOpts;
+
+// Batch of resource options read in a single call
+typedef struct ncs_OptionsBatch {
+    unsigned int count;
+    int* options;
+    // option data lengths and offsets in data in bytes
+    unsigned int* lengths;
+    unsigned int* offsets;
+    char* data;
+} ncs_OptionsBatch;
+
+// Latency statistics in nanoseconds
+typedef struct ncs_LatencyStats {
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long p50;
+    unsigned long long p90;
+    unsigned long long p99;
+    unsigned long long p999;
+} ncs_LatencyStats;
+
+// Inference statistics of a graph or a device
+typedef struct ncs_Stats {
+    // time since the statistics started to be collected in nanoseconds
+    unsigned long long uptime;
+    ncs_LatencyStats queue;
+    ncs_LatencyStats device;
+    ncs_LatencyStats read;
+    ncs_LatencyStats total;
+} ncs_Stats;
+
+// Totals of cumulative latency histogram in nanoseconds
+typedef struct ncs_HistogramTotals {
+    unsigned long long count;
+    unsigned long long sum;
+} ncs_HistogramTotals;
+
+// Shim call classes counted by the instrumentation; batched calls are counted once
+enum {
+    NCS_CALL_WRITE,
+    NCS_CALL_QUEUE,
+    NCS_CALL_READ,
+    NCS_CALL_OPTION,
+    NCS_CALL_CLASSES,
+};
+
+// Object detected by SSD network, box coordinates are normalized to [0, 1]
+typedef struct ncs_Detection {
+    int classID;
+    float confidence;
+    float left;
+    float top;
+    float right;
+    float bottom;
+} ncs_Detection;
+
+// Class predicted by classification network
+typedef struct ncs_Prediction {
+    int classID;
+    float probability;
+} ncs_Prediction;
+
+// FIFO reader element points to the oldest FIFO element read by FIFO reader thread
+typedef struct ncs_FifoReaderElem {
+    void* data;
+    ncs_FifoElemInfo info;
+} ncs_FifoReaderElem;
+
+// Result of bringing up a single device by ncs_DevicesOpen.
+// Handles of resources which have not been brought up are NULL; all of them are NULL if status is not NC_OK.
+typedef struct ncs_DeviceOpenResult {
+    int index;
+    int status;
+    void* deviceHandle;
+    void* graphHandle;
+    void* inFifoHandle;
+    void* outFifoHandle;
+} ncs_DeviceOpenResult;
+
+// Graph stage of a cascade
+typedef struct ncs_CascadeStage {
+    void* graphHandle;
+    void* inFifoHandle;
+    void* outFifoHandle;
+    // host tensor descriptor of the inbound FIFO images are preprocessed into
+    struct ncTensorDescriptor_t inDesc;
+    ncs_PreprocessOpts opts;
+    unsigned int outElemSize;
+    ncFifoDataType_t outDataType;
+    // maximum number of elements the outbound FIFO can hold
+    unsigned int outNumElem;
+} ncs_CascadeStage;
+
+// Result of a single image run through a cascade.
+// Detections and outputs are owned by the cascade and are valid until the next result is requested.
+typedef struct ncs_CascadeResult {
+    unsigned int count;
+    ncs_Detection* detections;
+    // classifier outputs of all the detections, outputLength bytes each
+    char* outputs;
+    unsigned int outputLength;
+} ncs_CascadeResult;
+
+// Device health sampled by device monitor
+typedef struct ncs_DeviceHealth {
+    // status of the last sample; the other fields hold the last successful sample
+    int status;
+    // age of the last successful sample in nanoseconds
+    unsigned long long age;
+    unsigned long long samples;
+    float thermalStats[NC_THERMAL_BUFFER_SIZE];
+    int throttle;
+    unsigned int memoryUsed;
+    unsigned int memorySize;
+    // minimum interval between inferences queued on the device in nanoseconds; 0 if they are not throttled
+    unsigned long long interval;
+} ncs_DeviceHealth;
+
+// Device monitor options; times are in nanoseconds and temperatures in degrees Celsius.
+// Inference submissions are not throttled if maxInterval is 0.
+typedef struct ncs_MonitorOpts {
+    unsigned long long period;
+    float throttleTemp;
+    float maxTemp;
+    unsigned long long maxInterval;
+} ncs_MonitorOpts;
+
+// Graph FIFO queue video ingest queues inferences of captured frames on
+typedef struct ncs_IngestTarget {
+    void* graphHandle;
+    void* inFifoHandle;
+    void* outFifoHandle;
+    // host tensor descriptor of the inbound FIFO frames are preprocessed into
+    struct ncTensorDescriptor_t inDesc;
+} ncs_IngestTarget;
+
+// Video ingest options.
+// Width and height are updated to the capture size negotiated with the driver.
+// Frames are written with metadata ID tag | (frame sequence number & seqMask) unless tag is 0.
+typedef struct ncs_IngestOpts {
+    const char* device;
+    unsigned int width;
+    unsigned int height;
+    // V4L2 fourcc of the capture pixel format; V4L2_PIX_FMT_YUYV and V4L2_PIX_FMT_BGR24 are supported
+    unsigned int pixelFormat;
+    unsigned int buffers;
+    ncs_PreprocessOpts preprocess;
+    unsigned int tag;
+    unsigned int seqMask;
+} ncs_IngestOpts;
+
+// Video ingest statistics
+typedef struct ncs_IngestStats {
+    // status which stopped the capture; NC_OK while capturing
+    int status;
+    unsigned long long frames;
+    unsigned long long queued;
+    unsigned long long dropped;
+} ncs_IngestStats;
+
+// ncs_MetaParam converts metadata IDs to FIFO element user parameters,
+// so the metadata passed along with FIFO elements never hands Go pointers over to NCSDK.
+// Elements are written with metadata IDs rather than user parameters, so the IDs never pass through cgo as pointers which may look like Go pointers.
+static inline void* ncs_MetaParam(unsigned int id) {
+    return (void*) (uintptr_t) id;
+}
+
 // Device Functions
 int ncs_DeviceCreate(int idx, void **deviceHandle);
 int ncs_DeviceOpen(void* deviceHandle);
 int ncs_DeviceGetOption(void* deviceHandle, int option, void *data, unsigned int *dataLength);
+int ncs_DeviceGetOptions(void* deviceHandle, ncs_OptionsBatch* batch);
 int ncs_DeviceClose(void* deviceHandle);
 int ncs_DeviceDestroy(void **deviceHandle);
 
+// Device bring-up functions
+// ncs_DevicesOpen returns the number of devices being brought up or negative status code if it fails.
+int ncs_DevicesOpen(int maxDevices, const char* graphName, const void *graphBuffer, unsigned int graphBufferLength,
+                ncFifoType_t inFifoType, int inNumElem, ncFifoDataType_t inDataType,
+                ncFifoType_t outFifoType, int outNumElem, ncFifoDataType_t outDataType, void** openHandle);
+int ncs_DevicesOpenNext(void* openHandle, ncs_DeviceOpenResult* result);
+int ncs_DevicesOpenCancel(void* openHandle);
+int ncs_DevicesOpenDestroy(void** openHandle);
+
 // Graph Functions
 int ncs_GraphCreate(const char* name, void **graphHandle);
 int ncs_GraphAllocate(void* deviceHandle, void* graphHandle,
@@ -33,8 +235,17 @@ int ncs_GraphQueueInference(void* graphHandle,
                 void** inFifoHandle, unsigned int inFifoCount,
                 void** outFifoHandle, unsigned int outFifoCount);
 int ncs_GraphQueueInferenceWithFifoElem(void* graphHandle, void* inFifoHandle, void* outFifoHandle,
-                const void* inputTensor, unsigned int* inputTensorLength, void* userParam);
+                const void* inputTensor, unsigned int* inputTensorLength, unsigned int metaID);
+int ncs_GraphQueueInferenceBatch(void* graphHandle, void* inFifoHandle, void* outFifoHandle,
+                const void* inputTensors, unsigned int inputTensorLength, unsigned int count, ncs_FifoBatchInfo* batch);
+int ncs_GraphQueueInferenceWithFifoElemFp32(void* graphHandle, void* inFifoHandle, void* outFifoHandle,
+                const void* inputTensor, unsigned int inputTensorLength, unsigned int metaID);
+int ncs_GraphQueueInferenceWithFifoElemBGR(void* graphHandle, void* inFifoHandle, void* outFifoHandle,
+                const void* image, unsigned int width, unsigned int height, unsigned int stride,
+                const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* tensorDesc, unsigned int metaID);
 int ncs_GraphGetOption(void* graphHandle, int option, void *data, unsigned int *dataLength);
+int ncs_GraphGetOptions(void* graphHandle, ncs_OptionsBatch* batch);
+int ncs_GraphSetOption(void* graphHandle, int option, const void *data, unsigned int dataLength);
 int ncs_GraphDestroy(void **graphHandle);
 
 // FIFO functions
@@ -42,10 +253,106 @@ int ncs_FifoCreate(const char* name, ncFifoType_t type, void** fifoHandle);
 int ncs_FifoAllocate(void* fifoHandle, void* deviceHandle, struct ncTensorDescriptor_t* tensorDesc, unsigned int numElem);
 
 int ncs_FifoGetOption(void* fifoHandle, int option, void *data, unsigned int *dataLength);
-int ncs_FifoWriteElem(void* fifoHandle, const void* inputTensor, unsigned int* inputTensorLength, void* userParam);
+int ncs_FifoGetOptions(void* fifoHandle, ncs_OptionsBatch* batch);
+int ncs_FifoSetOption(void* fifoHandle, int option, const void *data, unsigned int dataLength);
+int ncs_FifoWriteElem(void* fifoHandle, const void* inputTensor, unsigned int* inputTensorLength, unsigned int metaID);
+int ncs_FifoWriteElemFp32(void* fifoHandle, const void* inputTensor, unsigned int inputTensorLength, unsigned int metaID);
+int ncs_FifoWriteElemBGR(void* fifoHandle, const void* image, unsigned int width, unsigned int height, unsigned int stride,
+                const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* tensorDesc, unsigned int metaID);
 int ncs_FifoReadElem(void* fifoHandle, void *outputData, unsigned int* outputDataLen, void **userParam);
+int ncs_FifoReadElemInto(void* fifoHandle, void *outputData, unsigned int outputDataLen, ncs_FifoElemInfo* info);
+// ncs_FifoTryWriteElem and ncs_FifoTryReadElemInto return NC_BUSY instead of blocking when the FIFO is full or empty.
+// capacity is the number of elements the FIFO holds; it's immutable, so the caller passes the cached value in.
+int ncs_FifoTryWriteElem(void* fifoHandle, const void* inputTensor, unsigned int* inputTensorLength, unsigned int metaID, int capacity);
+int ncs_FifoTryReadElemInto(void* fifoHandle, void *outputData, unsigned int outputDataLen, ncs_FifoElemInfo* info);
+int ncs_FifoWriteElemBatch(void* fifoHandle, const void* inputTensors, unsigned int inputTensorLength,
+                unsigned int count, ncs_FifoBatchInfo* batch);
+int ncs_FifoReadElemBatch(void* fifoHandle, void *outputData, unsigned int outputDataLen,
+                unsigned int count, ncs_FifoBatchInfo* batch);
+int ncs_FifoRemoveElem(void* fifoHandle);
 int ncs_FifoDestroy(void** fifoHandle);
 
+// FIFO reader functions
+int ncs_FifoReaderCreate(void* fifoHandle, unsigned int elemSize, unsigned int ringSize, void** readerHandle);
+int ncs_FifoReaderPeek(void* readerHandle, ncs_FifoReaderElem* elem);
+int ncs_FifoReaderRelease(void* readerHandle);
+int ncs_FifoReaderDestroy(void** readerHandle);
+int ncs_CompletionWait(void** readerHandle);
+
+// Cascade functions
+int ncs_CascadeCreate(const ncs_CascadeStage* detector, const ncs_CascadeStage* classifier,
+                float minConfidence, unsigned int maxDetections, void** cascadeHandle);
+int ncs_CascadeQueue(void* cascadeHandle, const void* image, unsigned int width, unsigned int height, unsigned int stride);
+int ncs_CascadeNext(void* cascadeHandle, ncs_CascadeResult* result);
+int ncs_CascadeStop(void* cascadeHandle);
+int ncs_CascadeDestroy(void** cascadeHandle);
+
+// Deadline queue functions
+// Timeouts are in nanoseconds; requests submitted with 0 timeout never expire.
+// NCS_DEADLINE_EXPIRED is returned for requests which expire or are canceled; it's outside of ncStatus_t range so it's never confused with NC_TIMEOUT returned by the device.
+enum {
+    NCS_DEADLINE_EXPIRED = -100,
+};
+int ncs_DeadlineQueueCreate(void* graphHandle, void* inFifoHandle, void* outFifoHandle,
+                unsigned int inElemSize, unsigned int outElemSize, unsigned int depth, void** queueHandle);
+int ncs_DeadlineQueueSubmit(void* queueHandle, const void* inputTensor, unsigned int inputTensorLength,
+                unsigned long long timeout, unsigned long long* requestID);
+// ncs_DeadlineQueueWait returns NCS_DEADLINE_EXPIRED if the request expires or is canceled before it finishes.
+int ncs_DeadlineQueueWait(void* queueHandle, unsigned long long requestID, void* outputData, unsigned int outputDataLen,
+                unsigned int* outputLength);
+int ncs_DeadlineQueueCancel(void* queueHandle, unsigned long long requestID);
+int ncs_DeadlineQueueExpired(void* queueHandle, unsigned long long* expired);
+int ncs_DeadlineQueueStop(void* queueHandle);
+int ncs_DeadlineQueueDestroy(void** queueHandle);
+
+// Device monitor functions
+int ncs_MonitorStart(void* deviceHandle, const ncs_MonitorOpts* opts, void** monitorHandle);
+int ncs_MonitorHealth(void* monitorHandle, ncs_DeviceHealth* health);
+int ncs_MonitorStop(void** monitorHandle);
+
+#ifdef __linux__
+// Video ingest functions
+int ncs_IngestStart(ncs_IngestOpts* opts, const ncs_IngestTarget* targets, unsigned int targetCount, void** ingestHandle);
+int ncs_IngestSnapshot(void* ingestHandle, ncs_IngestStats* stats);
+int ncs_IngestStop(void** ingestHandle);
+#endif
+
+// Data conversion functions
+int ncs_Fp32ToFp16(const void* src, void* dst, unsigned int count);
+int ncs_Fp16ToFp32(const void* src, void* dst, unsigned int count);
+int ncs_PreprocessBGR(const void* image, unsigned int width, unsigned int height, unsigned int stride,
+                const ncs_PreprocessOpts* opts, const struct ncTensorDescriptor_t* tensorDesc, void* outputData, unsigned int outputDataLen);
+
+// Output decoding functions
+// ncs_DecodeSSD returns the number of decoded detections or negative status code if the decoding fails.
+int ncs_DecodeSSD(const void* data, unsigned int dataLen, ncFifoDataType_t dataType, float minConfidence,
+                ncs_Detection* detections, unsigned int maxDetections);
+// ncs_TopK returns the number of selected predictions or negative status code if the selection fails.
+int ncs_TopK(const void* data, unsigned int dataLen, ncFifoDataType_t dataType, unsigned int k,
+                ncs_Prediction* predictions);
+
+// Instrumentation functions
+int ncs_StatsRegister(void* handle, void* deviceHandle);
+int ncs_StatsUnregister(void* handle);
+int ncs_StatsRegisterFifo(void* fifoHandle);
+int ncs_StatsUnregisterFifo(void* fifoHandle);
+int ncs_StatsSnapshot(void* handle, ncs_Stats* stats);
+// ncs_StatsHistogram fills boundCount cumulative bucket counts of latencies up to bounds nanoseconds for every stage
+// in ncs_Stats order into buckets and the stage totals into totals.
+int ncs_StatsHistogram(void* handle, const unsigned long long* bounds, unsigned int boundCount,
+                unsigned long long* buckets, ncs_HistogramTotals* totals);
+// ncs_StatsInflight returns the number of inferences queued to output FIFO whose results have not been read yet
+int ncs_StatsInflight(void* fifoHandle, unsigned int* inflight);
+// ncs_StatsCalls fills counts of shim calls of the first count call classes
+int ncs_StatsCalls(unsigned long long* counts, unsigned int count);
+
+// Tensor pool functions
+int ncs_TensorPoolCreate(unsigned int bufSize, unsigned int slabCount, void** poolHandle);
+int ncs_TensorPoolGet(void* poolHandle, void** buf);
+int ncs_TensorPoolPut(void* poolHandle, void* buf);
+int ncs_TensorPoolUsage(void* poolHandle, unsigned int* bufs, unsigned int* inUse);
+int ncs_TensorPoolDestroy(void** poolHandle);
+
 #ifdef __cplusplus
 }
 #endif
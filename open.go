@@ -0,0 +1,164 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <stdlib.h>
+#include <ncs.h>
+*/
+import "C"
+import (
+	"context"
+	"fmt"
+	"sync"
+	"unsafe"
+)
+
+// OpenOpts configures devices brought up by OpenAll
+type OpenOpts struct {
+	// MaxDevices limits the number of devices brought up; all attached devices are brought up if it's 0
+	MaxDevices int
+	// GraphName is the name of the graph allocated on every device
+	GraphName string
+	// GraphData is compiled graph allocated on every device; devices are only opened if it's empty
+	GraphData []byte
+	// InOpts configures inbound FIFO of the graph; FifoHostWO FIFO of DefaultFifoNumElem FifoFP32 elements is allocated if nil
+	InOpts *FifoOpts
+	// OutOpts configures outbound FIFO of the graph; FifoHostRO FIFO of DefaultFifoNumElem FifoFP32 elements is allocated if nil
+	OutOpts *FifoOpts
+}
+
+// OpenResult is the result of bringing up a single device by OpenAll
+type OpenResult struct {
+	// Index is the index the device was created with
+	Index int
+	// Device is the opened device
+	Device *Device
+	// Graph is the graph allocated on the device; it's nil if no graph was requested
+	Graph *Graph
+	// Queue is FIFO queue allocated along with the graph; it's nil if no graph was requested
+	Queue *FifoQueue
+	// Err is the error which stopped the device from being brought up; all the other fields except Index are nil if it's set
+	Err error
+}
+
+// Destroy destroys all the resources brought up for the device
+func (r *OpenResult) Destroy() {
+	if r.Queue != nil {
+		r.Queue.In.Destroy()
+		r.Queue.Out.Destroy()
+	}
+
+	if r.Graph != nil {
+		r.Graph.Destroy()
+	}
+
+	if r.Device != nil {
+		r.Device.Close()
+		r.Device.Destroy()
+	}
+}
+
+// OpenAll creates and opens all NCS devices attached to the host and allocates the graph configured by opts on each of them.
+// Booting device firmware takes seconds, so all the devices are brought up concurrently on native threads.
+// The result of every device is delivered on the returned channel as soon as the device is ready, so it can start serving without waiting for the others.
+// The channel is closed when all the devices have been brought up or when ctx is done; devices which become ready after ctx is done are torn down.
+// Devices received on the channel are owned by the caller, including those still buffered in the channel when ctx is done.
+// It returns error if no device is found.
+func OpenAll(ctx context.Context, opts *OpenOpts) (<-chan OpenResult, error) {
+	if opts == nil {
+		opts = &OpenOpts{}
+	}
+
+	inOpts, outOpts := opts.InOpts, opts.OutOpts
+	if inOpts == nil {
+		inOpts = &FifoOpts{FifoHostWO, FifoFP32, DefaultFifoNumElem}
+	}
+	if outOpts == nil {
+		outOpts = &FifoOpts{FifoHostRO, FifoFP32, DefaultFifoNumElem}
+	}
+
+	var name *C.char
+	var graphPtr unsafe.Pointer
+	if len(opts.GraphData) > 0 {
+		name = C.CString(opts.GraphName)
+		defer C.free(unsafe.Pointer(name))
+		graphPtr = unsafe.Pointer(&opts.GraphData[0])
+	}
+
+	var handle unsafe.Pointer
+
+	n := C.ncs_DevicesOpen(C.int(opts.MaxDevices), name, graphPtr, C.uint(len(opts.GraphData)),
+		C.ncFifoType(inOpts.Type), C.int(inOpts.NumElem), C.ncFifoDataType(inOpts.DataType),
+		C.ncFifoType(outOpts.Type), C.int(outOpts.NumElem), C.ncFifoDataType(outOpts.DataType), &handle)
+
+	if n < 0 {
+		return nil, fmt.Errorf("Failed to open devices: %s", Status(n))
+	}
+
+	if n == 0 {
+		C.ncs_DevicesOpenDestroy(&handle)
+		return nil, fmt.Errorf("Failed to open devices: %s", StatusDeviceNotFound)
+	}
+
+	// results are buffered so the devices never wait for the caller to receive them
+	results := make(chan OpenResult, int(n))
+
+	go func() {
+		defer close(results)
+
+		stop := make(chan struct{})
+		var wg sync.WaitGroup
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			select {
+			case <-ctx.Done():
+				C.ncs_DevicesOpenCancel(handle)
+			case <-stop:
+			}
+		}()
+
+		for i := 0; i < int(n); i++ {
+			var r C.ncs_DeviceOpenResult
+			if s := C.ncs_DevicesOpenNext(handle, &r); Status(s) != StatusOK {
+				break
+			}
+			results <- newOpenResult(&r, opts.GraphName)
+		}
+
+		close(stop)
+		wg.Wait()
+		C.ncs_DevicesOpenDestroy(&handle)
+	}()
+
+	return results, nil
+}
+
+// newOpenResult wraps native device bring-up result into OpenResult
+func newOpenResult(r *C.ncs_DeviceOpenResult, graphName string) OpenResult {
+	res := OpenResult{Index: int(r.index)}
+
+	if Status(r.status) != StatusOK {
+		res.Err = fmt.Errorf("Failed to open device %d: %s", res.Index, Status(r.status))
+		return res
+	}
+
+	res.Device = &Device{handle: r.deviceHandle}
+	res.Device.opened()
+
+	if r.graphHandle == nil {
+		return res
+	}
+
+	res.Graph = &Graph{name: graphName, handle: r.graphHandle}
+	res.Graph.allocated(res.Device)
+
+	queue, err := newFifoQueue(res.Device, r.inFifoHandle, r.outFifoHandle)
+	res.Queue = queue
+	if err != nil {
+		res.Destroy()
+		return OpenResult{Index: res.Index, Err: fmt.Errorf("Failed to open device %d: %s", res.Index, err)}
+	}
+
+	return res
+}
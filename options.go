@@ -0,0 +1,189 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <stdlib.h>
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+const (
+	// maxBatchOptions is the maximum number of options a single OptionsBatch reads; it bounds the native option arrays addressed from Go
+	maxBatchOptions = 1 << 10
+	// maxBatchOptionsSize is the maximum size in bytes of the data of all the options a single OptionsBatch reads
+	maxBatchOptionsSize = 1 << 24
+)
+
+// OptionsBatch reads several options of a single NCS resource in one native call into reusable buffers.
+// It's meant for polling volatile options such as thermal stats or FIFO fill levels at a high rate.
+// OptionsBatch must be destroyed before the resource it reads the options of is destroyed.
+type OptionsBatch struct {
+	resource string
+	handle   unsafe.Pointer
+	opts     []Option
+	batch    *C.ncs_OptionsBatch
+	// data is the view of native options data buffer
+	data []byte
+}
+
+// NewOptionsBatch creates new OptionsBatch which reads device options opts.
+// It returns error if any of the options is not supported or its data size can't be queried.
+func (d *Device) NewOptionsBatch(opts ...DeviceOption) (*OptionsBatch, error) {
+	options := make([]Option, len(opts))
+	for i, opt := range opts {
+		if opt == RODeviceMaxExecutors || opt == RODeviceDebugInfo {
+			return nil, fmt.Errorf("Option %s not implemented", opt)
+		}
+		options[i] = opt
+	}
+
+	return newOptionsBatch("device", d.handle, &d.opts, options, deviceOptSize)
+}
+
+// NewOptionsBatch creates new OptionsBatch which reads graph options opts.
+// It returns error if any of the options is not supported or its data size can't be queried.
+func (g *Graph) NewOptionsBatch(opts ...GraphOption) (*OptionsBatch, error) {
+	options := make([]Option, len(opts))
+	for i, opt := range opts {
+		if opt == RWGraphExecutorsCount {
+			return nil, fmt.Errorf("Option %s not implemented", opt)
+		}
+		options[i] = opt
+	}
+
+	return newOptionsBatch("graph", g.handle, &g.opts, options, graphOptSize)
+}
+
+// NewOptionsBatch creates new OptionsBatch which reads FIFO options opts.
+// It returns error if any of the options is not supported or its data size can't be queried.
+func (f *Fifo) NewOptionsBatch(opts ...FifoOption) (*OptionsBatch, error) {
+	options := make([]Option, len(opts))
+	for i, opt := range opts {
+		options[i] = opt
+	}
+
+	return newOptionsBatch("fifo", f.handle, &f.opts, options, fifoOptSize)
+}
+
+// newOptionsBatch allocates native options batch for resource options opts.
+// Option data sizes are queried only if they are not cached yet.
+func newOptionsBatch(resource string, handle unsafe.Pointer, cache *optCache, opts []Option, sizes map[Option]uint) (*OptionsBatch, error) {
+	if len(opts) == 0 {
+		return nil, fmt.Errorf("Failed to create %s options batch: no options", resource)
+	}
+
+	if len(opts) > maxBatchOptions {
+		return nil, fmt.Errorf("Failed to create %s options batch: %d options exceed %d", resource, len(opts), maxBatchOptions)
+	}
+
+	lengths := make([]uint, len(opts))
+	total := uint(0)
+	for i, opt := range opts {
+		size, err := optionSize(resource, handle, cache, opt, sizes[opt])
+		if err != nil {
+			return nil, fmt.Errorf("Failed to create %s options batch: %s", resource, err)
+		}
+		if size == 0 {
+			return nil, fmt.Errorf("Failed to create %s options batch: %s", resource, StatusInvalidDataLength)
+		}
+		lengths[i] = size
+		total += size
+	}
+
+	if total > maxBatchOptionsSize {
+		return nil, fmt.Errorf("Failed to create %s options batch: options size %d exceeds %d", resource, total, maxBatchOptionsSize)
+	}
+
+	count := C.size_t(len(opts))
+	batch := (*C.ncs_OptionsBatch)(C.calloc(1, C.sizeof_ncs_OptionsBatch))
+	batch.count = C.uint(len(opts))
+	batch.options = (*C.int)(C.calloc(count, C.sizeof_int))
+	batch.lengths = (*C.uint)(C.calloc(count, C.sizeof_uint))
+	batch.offsets = (*C.uint)(C.calloc(count, C.sizeof_uint))
+	batch.data = (*C.char)(C.calloc(C.size_t(total), 1))
+
+	options := (*[maxBatchOptions]C.int)(unsafe.Pointer(batch.options))[:len(opts):len(opts)]
+	lens := (*[maxBatchOptions]C.uint)(unsafe.Pointer(batch.lengths))[:len(opts):len(opts)]
+	offsets := (*[maxBatchOptions]C.uint)(unsafe.Pointer(batch.offsets))[:len(opts):len(opts)]
+
+	offset := uint(0)
+	for i, opt := range opts {
+		options[i] = C.int(opt.Value())
+		lens[i] = C.uint(lengths[i])
+		offsets[i] = C.uint(offset)
+		offset += lengths[i]
+	}
+
+	return &OptionsBatch{
+		resource: resource,
+		handle:   handle,
+		opts:     opts,
+		batch:    batch,
+		data:     (*[maxBatchOptionsSize]byte)(unsafe.Pointer(batch.data))[:total:total],
+	}, nil
+}
+
+// Len returns the number of options read by the batch
+func (b *OptionsBatch) Len() int {
+	return len(b.opts)
+}
+
+// Read reads all batch options in a single native call.
+// It returns error if it fails to read any of the options.
+func (b *OptionsBatch) Read() error {
+	var s C.int
+
+	switch b.resource {
+	case "device":
+		s = C.ncs_DeviceGetOptions(b.handle, b.batch)
+	case "graph":
+		s = C.ncs_GraphGetOptions(b.handle, b.batch)
+	case "fifo":
+		s = C.ncs_FifoGetOptions(b.handle, b.batch)
+	default:
+		return fmt.Errorf("Unknown resource: %s", b.resource)
+	}
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to get %s options: %s", b.resource, Status(s))
+	}
+
+	return nil
+}
+
+// Bytes returns raw data of i-th batch option as read by the last Read.
+// The returned slice is only valid until the next Read or Destroy call.
+func (b *OptionsBatch) Bytes(i int) []byte {
+	offsets := (*[maxBatchOptions]C.uint)(unsafe.Pointer(b.batch.offsets))[:len(b.opts):len(b.opts)]
+	lens := (*[maxBatchOptions]C.uint)(unsafe.Pointer(b.batch.lengths))[:len(b.opts):len(b.opts)]
+
+	start := uint(offsets[i])
+	end := start + uint(lens[i])
+
+	return b.data[start:end:end]
+}
+
+// Decode decodes data of i-th batch option as read by the last Read.
+// It returns error if the option data can't be decoded.
+func (b *OptionsBatch) Decode(i int) (interface{}, error) {
+	return b.opts[i].Decode(b.Bytes(i), 1)
+}
+
+// Destroy frees native options batch buffers
+func (b *OptionsBatch) Destroy() {
+	if b.batch == nil {
+		return
+	}
+
+	C.free(unsafe.Pointer(b.batch.options))
+	C.free(unsafe.Pointer(b.batch.lengths))
+	C.free(unsafe.Pointer(b.batch.offsets))
+	C.free(unsafe.Pointer(b.batch.data))
+	C.free(unsafe.Pointer(b.batch))
+	b.batch = nil
+	b.data = nil
+}
@@ -0,0 +1,89 @@
+package ncs
+
+import "fmt"
+
+// Pipeline keeps up to depth inferences in flight on a graph FIFO queue.
+// While the device executes the queued inferences the caller can prepare the next input, so the host side processing overlaps with the device execution.
+// Pipeline is not safe for concurrent use.
+type Pipeline struct {
+	graph    *Graph
+	queue    *FifoQueue
+	depth    int
+	inflight int
+}
+
+// NewPipeline creates new Pipeline which keeps up to depth inferences in flight on FIFO queue f allocated with graph g.
+// depth must be at least 1 and it must not exceed the capacity of the outbound FIFO, otherwise queueing inferences would block forever.
+// For the best throughput allocate the FIFOs with AllocateWithFifosOpts with NumElem set to depth and set the graph executors count with SetExecutorsCount before allocating the graph.
+// It returns error if the depth is invalid.
+func (g *Graph) NewPipeline(f *FifoQueue, depth int) (*Pipeline, error) {
+	opts, err := f.Out.GetOptionWithByteSize(ROFifoCapacity, fifoOptSize[ROFifoCapacity])
+	if err != nil {
+		return nil, err
+	}
+
+	capacity, err := ROFifoCapacity.Decode(opts, 1)
+	if err != nil {
+		return nil, err
+	}
+
+	if depth < 1 || uint(depth) > capacity.(uint) {
+		return nil, fmt.Errorf("Failed to create pipeline: depth %d outside of [1, %d]", depth, capacity.(uint))
+	}
+
+	return &Pipeline{
+		graph: g,
+		queue: f,
+		depth: depth,
+	}, nil
+}
+
+// Queue queues data for inference. If depth inferences are already in flight it first waits for the oldest one to finish and reads its result into dst.
+// It returns the number of bytes read into dst and true if a result has been read. dst must be at least outbound FIFO ElemSize() bytes long.
+// It returns error if it fails to read the result or to queue the inference.
+func (p *Pipeline) Queue(data, dst []byte) (int, bool, error) {
+	var n int
+	read := false
+
+	if p.inflight == p.depth {
+		var err error
+		if n, err = p.Next(dst); err != nil {
+			return 0, false, err
+		}
+		read = true
+	}
+
+	if err := p.graph.QueueInferenceWithFifoElem(p.queue, data, nil); err != nil {
+		return n, read, err
+	}
+	p.inflight++
+
+	return n, read, nil
+}
+
+// Next waits for the oldest inference in flight to finish and reads its result into dst.
+// It returns the number of bytes read into dst. Call Next until InFlight returns 0 to drain the pipeline.
+// It returns error if there are no inferences in flight or if it fails to read the result.
+func (p *Pipeline) Next(dst []byte) (int, error) {
+	if p.inflight == 0 {
+		return 0, fmt.Errorf("Failed to read inference result: no inference in flight")
+	}
+
+	n, err := p.queue.Out.ReadElemInto(dst)
+	if err != nil {
+		return 0, err
+	}
+	p.inflight--
+
+	return n, nil
+}
+
+// InFlight returns the number of inferences in flight
+func (p *Pipeline) InFlight() int {
+	return p.inflight
+}
+
+// Depth returns the maximum number of inferences the pipeline keeps in flight
+func (p *Pipeline) Depth() int {
+	return p.depth
+}
@@ -0,0 +1,130 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+// maxTensorBufSize is the maximum size of tensor buffer which can be addressed by a byte slice returned by TensorPool
+const maxTensorBufSize = 1 << 30
+
+// TensorPool is a pool of fixed size tensor buffers allocated outside of Go heap.
+// The buffers are recycled, so using them for FIFO reads and writes avoids allocator churn and GC pressure.
+// TensorPool is safe for concurrent use.
+type TensorPool struct {
+	handle  unsafe.Pointer
+	bufSize uint
+}
+
+// NewTensorPool creates new pool of tensor buffers of bufSize bytes and returns it.
+// The pool allocates its buffers in slabs of slabCount buffers and grows by another slab when it runs out of free buffers.
+// It returns error if it fails to create new pool.
+func NewTensorPool(bufSize, slabCount uint) (*TensorPool, error) {
+	if bufSize > maxTensorBufSize {
+		return nil, fmt.Errorf("Failed to create tensor pool: buffer size %d exceeds %d", bufSize, maxTensorBufSize)
+	}
+
+	var handle unsafe.Pointer
+
+	s := C.ncs_TensorPoolCreate(C.uint(bufSize), C.uint(slabCount), &handle)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to create tensor pool: %s", Status(s))
+	}
+
+	return &TensorPool{handle: handle, bufSize: bufSize}, nil
+}
+
+// NewTensorPool creates new pool of tensor buffers sized to hold FIFO elements.
+// FIFO must be allocated before calling this function.
+// It returns error if it fails to create new pool.
+func (f *Fifo) NewTensorPool(slabCount uint) (*TensorPool, error) {
+	if f.elemSize == 0 {
+		return nil, fmt.Errorf("Failed to create tensor pool: %s", StatusNotAllocated)
+	}
+
+	return NewTensorPool(f.elemSize, slabCount)
+}
+
+// NewInputTensorPool creates new pool of tensor buffers sized to hold graph input tensor as described by ROGraphInputTensorDesc.
+// Graph must be allocated before calling this function.
+// It returns error if it fails to create new pool.
+func (g *Graph) NewInputTensorPool(slabCount uint) (*TensorPool, error) {
+	opts, err := g.GetOptionWithByteSize(ROGraphInputTensorDesc, C.sizeof_struct_ncTensorDescriptor_t)
+	if err != nil {
+		return nil, err
+	}
+
+	td, err := ROGraphInputTensorDesc.Decode(opts, 1)
+	if err != nil {
+		return nil, err
+	}
+
+	return NewTensorPool(td.([]TensorDesc)[0].Size, slabCount)
+}
+
+// BufSize returns the size of pool buffers in bytes
+func (p *TensorPool) BufSize() uint {
+	return p.bufSize
+}
+
+// Get returns a free tensor buffer from the pool.
+// The returned buffer must be returned back to the pool with Put once it's no longer used.
+// It returns error if it fails to get the buffer.
+func (p *TensorPool) Get() ([]byte, error) {
+	var buf unsafe.Pointer
+
+	s := C.ncs_TensorPoolGet(p.handle, &buf)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to get tensor buffer: %s", Status(s))
+	}
+
+	return (*[maxTensorBufSize]byte)(buf)[:p.bufSize:p.bufSize], nil
+}
+
+// Put returns tensor buffer back to the pool.
+// buf must have been obtained from the same pool by calling Get and it must not be used after calling Put.
+// It returns error if the buffer does not belong to the pool or if it has already been returned.
+func (p *TensorPool) Put(buf []byte) error {
+	if cap(buf) == 0 {
+		return fmt.Errorf("Failed to put tensor buffer: %s", StatusInvalidParameters)
+	}
+
+	s := C.ncs_TensorPoolPut(p.handle, unsafe.Pointer(&buf[:1][0]))
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to put tensor buffer: %s", Status(s))
+	}
+
+	return nil
+}
+
+// Usage returns the number of buffers allocated by the pool and the number of them which have not been returned with Put.
+// It reads the counts without locking the pool, so it never contends with Get and Put.
+func (p *TensorPool) Usage() (uint, uint) {
+	var bufs, inUse C.uint
+
+	if Status(C.ncs_TensorPoolUsage(p.handle, &bufs, &inUse)) != StatusOK {
+		return 0, 0
+	}
+
+	return uint(bufs), uint(inUse)
+}
+
+// Destroy destroys the pool and frees all its buffers.
+// None of the buffers obtained from the pool must be used after calling Destroy.
+func (p *TensorPool) Destroy() error {
+	s := C.ncs_TensorPoolDestroy(&p.handle)
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to destroy tensor pool: %s", Status(s))
+	}
+
+	return nil
+}
@@ -0,0 +1,169 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+// BGRImage is 8 bit BGR image with interleaved channels, such as a decoded video frame
+type BGRImage struct {
+	// Data contains image pixels
+	Data []byte
+	// Width is image width in pixels
+	Width int
+	// Height is image height in pixels
+	Height int
+	// Stride is the number of bytes between the starts of two consecutive image rows
+	Stride int
+}
+
+// check checks if image data is large enough to hold image pixels
+func (img *BGRImage) check() error {
+	if img.Width <= 0 || img.Height <= 0 || img.Stride < img.Width*3 {
+		return fmt.Errorf("invalid image dimensions: %dx%d, stride %d", img.Width, img.Height, img.Stride)
+	}
+
+	if len(img.Data) < (img.Height-1)*img.Stride+img.Width*3 {
+		return fmt.Errorf("image data size %d too small for %dx%d image", len(img.Data), img.Width, img.Height)
+	}
+
+	return nil
+}
+
+// PreprocessOpts configures image preprocessing
+type PreprocessOpts struct {
+	// Mean is per channel mean subtracted from BGR pixel values
+	Mean [3]float32
+	// Scale is per channel scale BGR pixel values are multiplied by after subtracting Mean
+	Scale [3]float32
+	// SwapRB stores the channels in RGB order instead of BGR
+	SwapRB bool
+}
+
+// Preprocessor prepares BGR images for inference in a single pass over the image: it resizes the image to the size of the tensor using bilinear interpolation,
+// subtracts per channel mean, multiplies the result by per channel scale and stores it in the layout and data type of the tensor.
+// Preprocessor is safe for concurrent use.
+type Preprocessor struct {
+	opts *C.ncs_PreprocessOpts
+}
+
+// NewPreprocessor creates new Preprocessor configured by opts and returns it
+func NewPreprocessor(opts *PreprocessOpts) *Preprocessor {
+	_opts := (*C.ncs_PreprocessOpts)(C.malloc(C.sizeof_ncs_PreprocessOpts))
+
+	for i := 0; i < 3; i++ {
+		_opts.mean[i] = C.float(opts.Mean[i])
+		_opts.scale[i] = C.float(opts.Scale[i])
+	}
+
+	_opts.swapRB = 0
+	if opts.SwapRB {
+		_opts.swapRB = 1
+	}
+
+	return &Preprocessor{opts: _opts}
+}
+
+// Preprocess preprocesses image into dst laid out as described by td.
+// td must describe 3 channel tensor of FifoFP16 or FifoFP32 data type.
+// It returns error if the image or dst size is invalid.
+func (p *Preprocessor) Preprocess(dst []byte, td *TensorDesc, img *BGRImage) error {
+	if err := img.check(); err != nil {
+		return fmt.Errorf("Failed to preprocess image: %s", err)
+	}
+
+	if len(dst) == 0 {
+		return fmt.Errorf("Failed to preprocess image: %s", StatusInvalidDataLength)
+	}
+
+	_td := cTensorDesc(td)
+
+	imgPtr, dstPtr := unsafe.Pointer(&img.Data[0]), unsafe.Pointer(&dst[0])
+	s := C.ncs_PreprocessBGR(imgPtr, C.uint(img.Width), C.uint(img.Height), C.uint(img.Stride),
+		p.opts, &_td, dstPtr, C.uint(len(dst)))
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to preprocess image: %s", Status(s))
+	}
+
+	return nil
+}
+
+// Destroy frees resources associated with the preprocessor.
+func (p *Preprocessor) Destroy() {
+	C.free(unsafe.Pointer(p.opts))
+	p.opts = nil
+}
+
+// WriteElemBGR preprocesses image with p and writes it to a FIFO along with some metadata in a single call.
+// The image is preprocessed directly into the FIFO host tensor layout and data type, so no intermediate images are allocated.
+// If it fails to preprocess the image or to write the element it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncFifoWriteElem.html
+func (f *Fifo) WriteElemBGR(p *Preprocessor, img *BGRImage, metaData interface{}) error {
+	if err := f.checkBGRElem(img); err != nil {
+		return fmt.Errorf("Failed to write FIFO element: %s", err)
+	}
+
+	metaID, err := f.putMeta(metaData)
+	if err != nil {
+		return fmt.Errorf("Failed to write FIFO element: %s", err)
+	}
+
+	imgPtr := unsafe.Pointer(&img.Data[0])
+	s := C.ncs_FifoWriteElemBGR(f.handle, imgPtr, C.uint(img.Width), C.uint(img.Height), C.uint(img.Stride),
+		p.opts, f.desc, metaID)
+
+	if Status(s) != StatusOK {
+		takeMetaID(metaID)
+		return fmt.Errorf("Failed to write FIFO element: %s", Status(s))
+	}
+	f.written(metaID, 1)
+
+	return nil
+}
+
+// checkBGRElem checks if image can be preprocessed into FIFO element
+func (f *Fifo) checkBGRElem(img *BGRImage) error {
+	if f.desc == nil {
+		return fmt.Errorf("tensor descriptor not available")
+	}
+
+	return img.check()
+}
+
+// QueueInferenceWithFifoElemBGR preprocesses image with p, writes it to the inbound FIFO and queues an inference in a single call.
+// The image is preprocessed directly into the inbound FIFO host tensor layout and data type, so no intermediate images are allocated.
+// If it fails to preprocess the image or to queue the inference it returns error
+//
+// For more information:
+// https://movidius.github.io/ncsdk/ncapi/ncapi2/c_api/ncGraphQueueInferenceWithFifoElem.html
+func (g *Graph) QueueInferenceWithFifoElemBGR(f *FifoQueue, p *Preprocessor, img *BGRImage, metaData interface{}) error {
+	if err := f.In.checkBGRElem(img); err != nil {
+		return fmt.Errorf("Failed to queue inference: %s", err)
+	}
+
+	metaID, err := f.In.putMeta(metaData)
+	if err != nil {
+		return fmt.Errorf("Failed to queue inference: %s", err)
+	}
+
+	imgPtr := unsafe.Pointer(&img.Data[0])
+	s := C.ncs_GraphQueueInferenceWithFifoElemBGR(g.handle, f.In.handle, f.Out.handle,
+		imgPtr, C.uint(img.Width), C.uint(img.Height), C.uint(img.Stride),
+		p.opts, f.In.desc, metaID)
+
+	if Status(s) != StatusOK {
+		takeMetaID(metaID)
+		return fmt.Errorf("Failed to queue inference: %s", Status(s))
+	}
+	f.In.writtenQueued(metaID, 1)
+
+	return nil
+}
@@ -0,0 +1,200 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"sync"
+	"unsafe"
+)
+
+var (
+	// readers maps native FIFO reader handles to FifoReaders
+	readers   = make(map[unsafe.Pointer]*FifoReader)
+	readersMu sync.Mutex
+	// completionOnce starts completion dispatcher when the first FifoReader is created
+	completionOnce sync.Once
+)
+
+// dispatchCompletions waits for FIFO elements read by any native FIFO reader and notifies the FifoReader that owns it.
+// It is the only goroutine which blocks in native code waiting for FIFO elements, no matter how many FifoReaders there are.
+func dispatchCompletions() {
+	var handle unsafe.Pointer
+
+	for {
+		C.ncs_CompletionWait(&handle)
+
+		readersMu.Lock()
+		if r, ok := readers[handle]; ok {
+			select {
+			case r.notify <- struct{}{}:
+			default:
+			}
+		}
+		readersMu.Unlock()
+	}
+}
+
+// FifoReader reads elements from a FIFO on a native thread and delivers them as Tensors on a channel.
+// This decouples queueing inferences from reading their results without blocking an OS thread per FIFO.
+type FifoReader struct {
+	handle  unsafe.Pointer
+	elem    *C.ncs_FifoReaderElem
+	results chan *Tensor
+	notify  chan struct{}
+	done    chan struct{}
+	exited  chan struct{}
+	mu      sync.Mutex
+	err     error
+	// status is the status of the FIFO read which failed
+	status Status
+	// destroyed is set once Destroy has been called; it's guarded by mu
+	destroyed bool
+}
+
+// NewReader starts reading FIFO elements on a native thread and returns FifoReader which delivers them.
+// The read elements are buffered in a ring of ringSize elements; when the ring is full the native thread stops reading until the results are received from Results channel.
+// FIFO must be allocated before calling this function and no other reads must be done on the FIFO until the FifoReader is destroyed.
+// The native thread only reads the results of inferences queued to the FIFO after the reader is created, so it never blocks
+// in a FIFO read which no queued inference completes. It returns error if it fails to start the reader or if the FIFO already has a reader.
+func (f *Fifo) NewReader(ringSize uint) (*FifoReader, error) {
+	if f.elemSize == 0 {
+		return nil, fmt.Errorf("Failed to create FIFO reader: %s", StatusNotAllocated)
+	}
+
+	var handle unsafe.Pointer
+
+	s := C.ncs_FifoReaderCreate(f.handle, C.uint(f.elemSize), C.uint(ringSize), &handle)
+
+	if Status(s) != StatusOK {
+		return nil, fmt.Errorf("Failed to create FIFO reader: %s", Status(s))
+	}
+
+	r := &FifoReader{
+		handle:  handle,
+		elem:    (*C.ncs_FifoReaderElem)(C.malloc(C.sizeof_ncs_FifoReaderElem)),
+		results: make(chan *Tensor),
+		notify:  make(chan struct{}, 1),
+		done:    make(chan struct{}),
+		exited:  make(chan struct{}),
+	}
+
+	readersMu.Lock()
+	readers[handle] = r
+	readersMu.Unlock()
+
+	completionOnce.Do(func() { go dispatchCompletions() })
+
+	go r.run()
+
+	return r, nil
+}
+
+// run delivers the elements read by the native reader thread to results channel
+func (r *FifoReader) run() {
+	defer close(r.exited)
+	defer close(r.results)
+
+	for {
+		// the elements read before the reader was registered have no notification, so drain before waiting
+		if !r.drain() {
+			return
+		}
+
+		select {
+		case <-r.notify:
+		case <-r.done:
+			return
+		}
+	}
+}
+
+// drain delivers all elements currently buffered in the native ring.
+// It returns false when the reader has failed or been stopped.
+func (r *FifoReader) drain() bool {
+	for {
+		s := C.ncs_FifoReaderPeek(r.handle, r.elem)
+
+		switch Status(s) {
+		case StatusOK:
+		case StatusBusy:
+			return true
+		default:
+			r.mu.Lock()
+			r.err = fmt.Errorf("Failed to read FIFO element: %s", Status(s))
+			r.status = Status(s)
+			r.mu.Unlock()
+			return false
+		}
+
+		t := &Tensor{
+			Data:     C.GoBytes(r.elem.data, C.int(r.elem.info.dataLength)),
+			MetaData: takeMeta(r.elem.info.userParam),
+		}
+
+		C.ncs_FifoReaderRelease(r.handle)
+
+		select {
+		case r.results <- t:
+		case <-r.done:
+			return false
+		}
+	}
+}
+
+// Results returns a channel which delivers FIFO elements in the order they have been read.
+// The channel is closed when reading a FIFO element fails or the reader is destroyed.
+func (r *FifoReader) Results() <-chan *Tensor {
+	return r.results
+}
+
+// Err returns the error which caused Results channel to be closed.
+// It returns nil if the reader has not failed.
+func (r *FifoReader) Err() error {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	return r.err
+}
+
+// failure returns the status of the FIFO read which caused Results channel to be closed.
+// It returns StatusOK if the reader has not failed.
+func (r *FifoReader) failure() Status {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	return r.status
+}
+
+// Destroy stops the reader and frees associated resources.
+// A FIFO read can't be interrupted, so if the native thread is reading the result of a queued inference, Destroy blocks until the read returns;
+// the element it reads is discarded. FifoReader must be destroyed before the FIFO it reads from is destroyed.
+// Destroying the reader again does nothing.
+func (r *FifoReader) Destroy() error {
+	r.mu.Lock()
+	if r.destroyed {
+		r.mu.Unlock()
+		return nil
+	}
+	r.destroyed = true
+	r.mu.Unlock()
+
+	readersMu.Lock()
+	delete(readers, r.handle)
+	readersMu.Unlock()
+
+	close(r.done)
+	<-r.exited
+
+	s := C.ncs_FifoReaderDestroy(&r.handle)
+	C.free(unsafe.Pointer(r.elem))
+
+	if Status(s) != StatusOK {
+		return fmt.Errorf("Failed to destroy FIFO reader: %s", Status(s))
+	}
+
+	return nil
+}
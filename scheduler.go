@@ -0,0 +1,308 @@
+package ncs
+
+import (
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// schedRequest is an inference request waiting in a scheduler queue
+type schedRequest struct {
+	data  []byte
+	reply chan poolResult
+	// requeues is the number of times the request has been requeued after a device failed
+	requeues int
+}
+
+// schedQueue is a queue of inference requests assigned to a single pool device.
+// The device worker takes requests from the front of its own queue, idle workers steal them from the back.
+type schedQueue struct {
+	pd *PoolDevice
+	mu sync.Mutex
+	// reqs contains requests waiting to be queued on the device
+	reqs []*schedRequest
+	// inflight is the number of requests queued on the device
+	inflight int32
+	// throttle is the last observed thermal throttle level of the device
+	throttle int32
+	// wake wakes up the device worker
+	wake chan struct{}
+}
+
+// push adds request to the back of the queue
+func (q *schedQueue) push(req *schedRequest) {
+	q.mu.Lock()
+	q.reqs = append(q.reqs, req)
+	q.mu.Unlock()
+}
+
+// popFront removes the request from the front of the queue and returns it
+func (q *schedQueue) popFront() *schedRequest {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	if len(q.reqs) == 0 {
+		return nil
+	}
+
+	req := q.reqs[0]
+	q.reqs[0] = nil
+	q.reqs = q.reqs[1:]
+
+	return req
+}
+
+// popBack removes the request from the back of the queue and returns it
+func (q *schedQueue) popBack() *schedRequest {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	if len(q.reqs) == 0 {
+		return nil
+	}
+
+	req := q.reqs[len(q.reqs)-1]
+	q.reqs[len(q.reqs)-1] = nil
+	q.reqs = q.reqs[:len(q.reqs)-1]
+
+	return req
+}
+
+// len returns the number of requests waiting in the queue
+func (q *schedQueue) len() int {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	return len(q.reqs)
+}
+
+// thermalThrottle returns the last observed device thermal throttle level
+func (q *schedQueue) thermalThrottle() DeviceThermalThrottle {
+	return DeviceThermalThrottle(atomic.LoadInt32(&q.throttle))
+}
+
+// limit returns the maximum number of requests that can be queued on the device given its thermal throttle level
+func (q *schedQueue) limit() int32 {
+	switch q.thermalThrottle() {
+	case NoThrottle:
+		return int32(q.pd.depth)
+	case LowerGuard:
+		if q.pd.depth > 1 {
+			return int32(q.pd.depth / 2)
+		}
+	}
+
+	return 1
+}
+
+// cost returns the cost of assigning another request to the queue.
+// Every thermal throttle level doubles the cost, so hot devices are assigned new requests only when the others are busy.
+func (q *schedQueue) cost() int {
+	return (q.len() + int(atomic.LoadInt32(&q.inflight)) + 1) << uint(q.thermalThrottle())
+}
+
+// notify wakes up the queue worker
+func (q *schedQueue) notify() {
+	select {
+	case q.wake <- struct{}{}:
+	default:
+	}
+}
+
+// Scheduler dispatches inference requests to DevicePool devices.
+// Every device has its own request queue served by its own worker; workers of idle devices steal requests from the queues of busy ones.
+// Devices are periodically checked for thermal throttling: throttled devices get fewer requests in flight, are assigned new requests last and don't steal requests from other devices.
+// Scheduler is safe for concurrent use.
+type Scheduler struct {
+	pool   *DevicePool
+	queues []*schedQueue
+	done   chan struct{}
+	wg     sync.WaitGroup
+	// mu guards stopped so no request is queued after the queues have been drained by Stop
+	mu      sync.RWMutex
+	stopped bool
+}
+
+// NewScheduler creates new Scheduler for the devices in the pool and starts its workers.
+// Thermal throttle level of every device is queried every throttleInterval.
+func NewScheduler(p *DevicePool, throttleInterval time.Duration) *Scheduler {
+	s := &Scheduler{
+		pool: p,
+		done: make(chan struct{}),
+	}
+
+	for _, pd := range p.Devices() {
+		s.queues = append(s.queues, &schedQueue{
+			pd:   pd,
+			wake: make(chan struct{}, 1),
+		})
+	}
+
+	for _, q := range s.queues {
+		s.wg.Add(2)
+		go s.work(q)
+		go s.watchThrottle(q, throttleInterval)
+	}
+
+	return s
+}
+
+// work queues requests on the device of the queue as long as the device has room for them
+func (s *Scheduler) work(q *schedQueue) {
+	defer s.wg.Done()
+
+	for {
+		if atomic.LoadInt32(&q.inflight) < q.limit() {
+			if req := s.next(q); req != nil {
+				s.submit(q, req)
+				continue
+			}
+		}
+
+		select {
+		case <-q.wake:
+		case <-s.done:
+			return
+		}
+	}
+}
+
+// next returns the next request to be queued on the device of q.
+// It returns request from the front of q or, if q is empty, it steals request from the back of the longest queue.
+func (s *Scheduler) next(q *schedQueue) *schedRequest {
+	if req := q.popFront(); req != nil {
+		return req
+	}
+
+	if q.thermalThrottle() == UpperGuard {
+		return nil
+	}
+
+	var victim *schedQueue
+	victimLen := 0
+
+	for _, v := range s.queues {
+		if v == q {
+			continue
+		}
+		// requests waiting for throttled devices are stolen first
+		if l := v.len() << uint(v.thermalThrottle()); l > victimLen {
+			victim, victimLen = v, l
+		}
+	}
+
+	if victim == nil {
+		return nil
+	}
+
+	return victim.popBack()
+}
+
+// submit queues request on the device of q and delivers its result once it's available
+func (s *Scheduler) submit(q *schedQueue, req *schedRequest) {
+	atomic.AddInt32(&q.inflight, 1)
+
+	reply, err := q.pd.queue(req.data)
+	if err != nil {
+		atomic.AddInt32(&q.inflight, -1)
+		req.reply <- poolResult{err: err}
+		return
+	}
+
+	go func() {
+		res := <-reply
+		atomic.AddInt32(&q.inflight, -1)
+		q.notify()
+		req.reply <- res
+	}()
+}
+
+// watchThrottle periodically queries thermal throttle level of the device of q
+func (s *Scheduler) watchThrottle(q *schedQueue, interval time.Duration) {
+	defer s.wg.Done()
+
+	ticker := time.NewTicker(interval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-ticker.C:
+		case <-s.done:
+			return
+		}
+
+		throttle, err := q.pd.thermalThrottle()
+		if err != nil {
+			continue
+		}
+
+		if old := atomic.SwapInt32(&q.throttle, int32(throttle)); old != int32(throttle) {
+			// throttling level change changes how many requests the device can take
+			s.notifyAll()
+		}
+	}
+}
+
+// notifyAll wakes up all the workers
+func (s *Scheduler) notifyAll() {
+	for _, q := range s.queues {
+		q.notify()
+	}
+}
+
+// Infer assigns data inference request to the queue with the lowest cost and waits for its result.
+// It returns error if the scheduler has been stopped or if it fails to queue the inference or to read its result.
+func (s *Scheduler) Infer(data []byte) (*Tensor, error) {
+	if len(s.queues) == 0 {
+		return nil, fmt.Errorf("Failed to schedule inference: %s", StatusDeviceNotFound)
+	}
+
+	s.mu.RLock()
+	if s.stopped {
+		s.mu.RUnlock()
+		return nil, fmt.Errorf("Failed to schedule inference: scheduler stopped")
+	}
+
+	best := s.queues[0]
+	bestCost := best.cost()
+	for _, q := range s.queues[1:] {
+		if c := q.cost(); c < bestCost {
+			best, bestCost = q, c
+		}
+	}
+
+	req := &schedRequest{
+		data:  data,
+		reply: make(chan poolResult, 1),
+	}
+	best.push(req)
+	s.mu.RUnlock()
+	// any idle worker can pick up the request
+	s.notifyAll()
+
+	res := <-req.reply
+
+	return res.tensor, res.err
+}
+
+// Stop stops the scheduler workers. Requests which have not been queued on any device yet fail with error.
+// Stop does not destroy the scheduler DevicePool. Stopping already stopped scheduler has no effect.
+func (s *Scheduler) Stop() {
+	s.mu.Lock()
+	if s.stopped {
+		s.mu.Unlock()
+		return
+	}
+	s.stopped = true
+	s.mu.Unlock()
+
+	close(s.done)
+	s.wg.Wait()
+
+	for _, q := range s.queues {
+		for req := q.popFront(); req != nil; req = q.popFront() {
+			req.reply <- poolResult{err: fmt.Errorf("Failed to schedule inference: scheduler stopped")}
+		}
+	}
+}
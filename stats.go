@@ -0,0 +1,154 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"time"
+	"unsafe"
+)
+
+// LatencyStats summarizes latency histogram.
+// Percentiles are accurate to within 1/16 of their value.
+type LatencyStats struct {
+	// Count is the number of recorded latencies
+	Count uint64
+	// Mean is the mean latency
+	Mean time.Duration
+	// Min is the minimum latency
+	Min time.Duration
+	// Max is the maximum latency
+	Max time.Duration
+	// P50 is the median latency
+	P50 time.Duration
+	// P90 is the 90th percentile latency
+	P90 time.Duration
+	// P99 is the 99th percentile latency
+	P99 time.Duration
+	// P999 is the 99.9th percentile latency
+	P999 time.Duration
+}
+
+// Stats is a snapshot of inference latency statistics of a graph or a device.
+// Latencies are measured natively with monotonic clock as inferences are queued and their results read.
+type Stats struct {
+	// Uptime is time since the statistics started to be collected
+	Uptime time.Duration
+	// Queue is the time host spends queueing inferences. It is measured from the start of the input
+	// element write, including any data conversion or preprocessing, to the inference being queued.
+	Queue LatencyStats
+	// Device is the time from inference being queued to its result being read.
+	// It covers device execution and result transfer as observed by the host.
+	Device LatencyStats
+	// Read is the time spent reading inference results from output FIFOs.
+	// It includes the time spent waiting for results when they are read before the inference finishes.
+	Read LatencyStats
+	// Total is the time from the start of queueing inference to its result being read.
+	Total LatencyStats
+}
+
+// Throughput returns the number of inference results read per second since the statistics started to be collected
+func (s *Stats) Throughput() float64 {
+	if s.Uptime <= 0 {
+		return 0
+	}
+
+	return float64(s.Read.Count) / s.Uptime.Seconds()
+}
+
+// Stats returns inference statistics of all graphs allocated on the device.
+// Statistics are collected once the device is opened.
+// It returns error if the statistics are not available.
+func (d *Device) Stats() (*Stats, error) {
+	return statsSnapshot(d.handle)
+}
+
+// Stats returns inference statistics of the graph.
+// Statistics are collected once the graph is allocated.
+// It returns error if the statistics are not available.
+func (g *Graph) Stats() (*Stats, error) {
+	return statsSnapshot(g.handle)
+}
+
+// statsSnapshot reads native statistics snapshot of resource handle
+func statsSnapshot(handle unsafe.Pointer) (*Stats, error) {
+	var s C.ncs_Stats
+
+	st := C.ncs_StatsSnapshot(handle, &s)
+	if Status(st) != StatusOK {
+		return nil, fmt.Errorf("Failed to read stats: %s", Status(st))
+	}
+
+	return &Stats{
+		Uptime: time.Duration(s.uptime),
+		Queue:  latencyStats(&s.queue),
+		Device: latencyStats(&s.device),
+		Read:   latencyStats(&s.read),
+		Total:  latencyStats(&s.total),
+	}, nil
+}
+
+// latencyStats converts native latency stats to LatencyStats
+func latencyStats(s *C.ncs_LatencyStats) LatencyStats {
+	ls := LatencyStats{
+		Count: uint64(s.count),
+		Min:   time.Duration(s.min),
+		Max:   time.Duration(s.max),
+		P50:   time.Duration(s.p50),
+		P90:   time.Duration(s.p90),
+		P99:   time.Duration(s.p99),
+		P999:  time.Duration(s.p999),
+	}
+
+	if ls.Count > 0 {
+		ls.Mean = time.Duration(uint64(s.sum) / ls.Count)
+	}
+
+	return ls
+}
+
+// statsStages are the names of Stats latency stages in native stats order
+var statsStages = [...]string{"queue", "device", "read", "total"}
+
+// latencyHistogram is cumulative latency histogram of a stats stage
+type latencyHistogram struct {
+	// buckets are the numbers of latencies up to the histogram bounds
+	buckets []uint64
+	count   uint64
+	sum     time.Duration
+}
+
+// statsHistograms reads native cumulative latency histograms with bucket bounds of resource handle in statsStages order.
+// It returns error if the statistics are not available.
+func statsHistograms(handle unsafe.Pointer, bounds []C.ulonglong) ([]latencyHistogram, error) {
+	n := len(bounds)
+	buckets := make([]C.ulonglong, n*len(statsStages))
+	var totals [len(statsStages)]C.ncs_HistogramTotals
+
+	var boundsPtr, bucketsPtr unsafe.Pointer
+	if n > 0 {
+		boundsPtr, bucketsPtr = unsafe.Pointer(&bounds[0]), unsafe.Pointer(&buckets[0])
+	}
+
+	st := C.ncs_StatsHistogram(handle, (*C.ulonglong)(boundsPtr), C.uint(n), (*C.ulonglong)(bucketsPtr), &totals[0])
+	if Status(st) != StatusOK {
+		return nil, fmt.Errorf("Failed to read stats histogram: %s", Status(st))
+	}
+
+	hists := make([]latencyHistogram, len(statsStages))
+	for i := range hists {
+		hists[i] = latencyHistogram{
+			buckets: make([]uint64, n),
+			count:   uint64(totals[i].count),
+			sum:     time.Duration(totals[i].sum),
+		}
+		for j := range hists[i].buckets {
+			hists[i].buckets[j] = uint64(buckets[i*n+j])
+		}
+	}
+
+	return hists, nil
+}
@@ -0,0 +1,47 @@
+package ncs
+
+// #cgo !ncsmock LDFLAGS: -lmvnc
+/*
+#include <ncs.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+// Prediction is a class predicted by classification network
+// Prediction memory layout matches ncs_Prediction so predictions can be selected in place
+type Prediction struct {
+	// ClassID is the index of the predicted class in network output
+	ClassID int32
+	// Probability is the predicted class probability
+	Probability float32
+}
+
+// make sure Prediction and ncs_Prediction have the same size
+var _ [C.sizeof_ncs_Prediction - unsafe.Sizeof(Prediction{})]struct{}
+var _ [unsafe.Sizeof(Prediction{}) - C.sizeof_ncs_Prediction]struct{}
+
+// TopK returns k predictions with the highest probability stored in tensor data sorted in descending order.
+// Tensor data stores FP16 or FP32 values as specified by dataType; NaN values are skipped.
+// The selection is done natively without converting or sorting the whole tensor.
+// It returns error if the tensor data can't be read.
+func TopK(t *Tensor, dataType FifoDataType, k int) ([]Prediction, error) {
+	if k <= 0 {
+		return nil, fmt.Errorf("Failed to select top predictions: invalid k %d", k)
+	}
+
+	if t == nil || len(t.Data) == 0 {
+		return nil, fmt.Errorf("Failed to select top predictions: empty tensor")
+	}
+
+	preds := make([]Prediction, k)
+	dataPtr, predsPtr := unsafe.Pointer(&t.Data[0]), (*C.ncs_Prediction)(unsafe.Pointer(&preds[0]))
+	count := C.ncs_TopK(dataPtr, C.uint(len(t.Data)), C.ncFifoDataType_t(dataType), C.uint(k), predsPtr)
+	if count < 0 {
+		return nil, fmt.Errorf("Failed to select top predictions: %s", Status(count))
+	}
+
+	return preds[:count], nil
+}
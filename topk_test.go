@@ -0,0 +1,99 @@
+//go:build ncsmock
+// +build ncsmock
+
+package ncs
+
+import (
+	"encoding/binary"
+	"math"
+	"sort"
+	"testing"
+)
+
+// topKReference selects k highest non-NaN values by sorting all of them; equal values keep their order
+func topKReference(vals []float32, k int) []Prediction {
+	var preds []Prediction
+	for i, v := range vals {
+		if v == v {
+			preds = append(preds, Prediction{ClassID: int32(i), Probability: v})
+		}
+	}
+	sort.SliceStable(preds, func(i, j int) bool { return preds[i].Probability > preds[j].Probability })
+
+	if len(preds) > k {
+		preds = preds[:k]
+	}
+
+	return preds
+}
+
+// topKVals returns n distinct values; every nanEvery-th value starting with the first one is NaN
+func topKVals(n, nanEvery int) []float32 {
+	vals := make([]float32, n)
+	for i := range vals {
+		// scatter the values so the highest ones are not at the end; they are exact in FP16
+		vals[i] = float32((i*37)%n) / 64
+		if nanEvery > 0 && i%nanEvery == 0 {
+			vals[i] = float32(math.NaN())
+		}
+	}
+
+	return vals
+}
+
+func TestTopK(t *testing.T) {
+	nan := float32(math.NaN())
+
+	tests := []struct {
+		name string
+		vals []float32
+		k    int
+	}{
+		{"single", []float32{0.5}, 1},
+		{"k over length", []float32{0.25, 0.75, 0.5}, 5},
+		{"nan first", []float32{nan, 0.25, 0.75, 0.5, 0.125, 1, 0.375}, 3},
+		{"nan last", []float32{0.25, 0.75, 0.5, 0.125, 1, 0.375, 0.625, 0.875, nan}, 4},
+		{"nan only", []float32{nan, nan, nan, nan, nan, nan, nan, nan, nan}, 2},
+		{"ties", []float32{0.5, 0.25, 0.5, 0.75, 0.5, 0.25, 0.75}, 4},
+		{"negative", []float32{-0.5, -0.25, -1, -0.75, -0.125, -2, -0.375, -4, -8, -16, -0.625}, 3},
+		{"nans 17", topKVals(17, 5), 5},
+		{"nans 33", topKVals(33, 3), 8},
+		// spans more than a single chunk of loaded values
+		{"nans 1001", topKVals(1001, 7), 10},
+	}
+
+	for _, tc := range tests {
+		expected := topKReference(tc.vals, tc.k)
+
+		fp32 := make([]byte, len(tc.vals)*4)
+		for i, v := range tc.vals {
+			binary.LittleEndian.PutUint32(fp32[i*4:], math.Float32bits(v))
+		}
+		fp16 := make([]byte, len(tc.vals)*2)
+		if err := FP32ToFP16(fp16, fp32); err != nil {
+			t.Fatalf("%s: failed to convert to FP16: %s", tc.name, err)
+		}
+
+		for _, data := range []struct {
+			dataType FifoDataType
+			data     []byte
+		}{
+			{FifoFP32, fp32},
+			{FifoFP16, fp16},
+		} {
+			preds, err := TopK(&Tensor{Data: data.data}, data.dataType, tc.k)
+			if err != nil {
+				t.Fatalf("%s/%s: failed to select top predictions: %s", tc.name, data.dataType, err)
+			}
+
+			if len(preds) != len(expected) {
+				t.Fatalf("%s/%s: expected %d predictions, got %d: %v", tc.name, data.dataType, len(expected), len(preds), preds)
+			}
+			for i := range preds {
+				if preds[i] != expected[i] {
+					t.Errorf("%s/%s: prediction %d: expected %+v, got %+v", tc.name, data.dataType, i, expected[i], preds[i])
+				}
+			}
+		}
+	}
+}